@@ -0,0 +1,371 @@
+// Headless benchmark for the editor's hot paths.
+//
+// Build from src/ together with the IDE sources, leaving out the IDE's main:
+//   g++ -O2 -DIDE_NO_MAIN *.cpp bench/benchmark.cpp -o ide_bench -lSDL2 -lSDL2_ttf -pthread
+// Run from src/ (arial.ttf must be next to it):
+//   ./ide_bench [--sizes 1000,10000,100000] [--samples N] [--no-compile] [--out results.json]
+//
+// The window is created on SDL's dummy video driver and drawn with the
+// software renderer, so no display or GPU is needed. Results are printed as
+// JSON with per-benchmark percentiles in microseconds.
+
+#define SDL_MAIN_HANDLED
+
+#include <SDL2/SDL.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../file_saver.hpp"
+#include "../identifier_index.hpp"
+#include "../jobs.hpp"
+#include "../scheduler.hpp"
+#include "../text_buffer.hpp"
+#include "../undo_history.hpp"
+
+// --------- Editor Entry Points ---------
+// Defined in integrated_ide.cpp
+extern TextBuffer buffer;
+extern UndoHistory history;
+extern int currentLine, cursorPos;
+extern Job buildJob;
+extern SaveQueue saveQueue;
+extern std::string buildStatus;
+extern IdentifierIndex identifiers;
+bool init();
+void close();
+void handleInput(SDL_Event& e);
+void renderFrame();
+void renderTextEditor();
+void ensureCursorVisible();
+void loadFromFile(const std::string& filename);
+void saveToFile(const std::string& filename);
+void undo();
+void redo();
+void compileAndRun();
+void pollBuildJob();
+void pollSaveQueue();
+void pollIdentifierIndex();
+
+// --------- Measurement ---------
+struct Result {
+    std::string name;
+    size_t lines;
+    std::vector<double> micros;
+};
+
+// A deque, so references handed out by result() stay valid as it grows
+static std::deque<Result> results;
+
+using Clock = std::chrono::steady_clock;
+
+static double microsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+}
+
+static Result& result(const std::string& name, size_t lines) {
+    results.push_back({name, lines, {}});
+    return results.back();
+}
+
+// Nearest-rank percentile of sorted samples
+static double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    size_t rank = (size_t)std::ceil(p / 100.0 * sorted.size());
+    return sorted[std::min(sorted.size() - 1, rank == 0 ? 0 : rank - 1)];
+}
+
+static std::string toJson() {
+    std::ostringstream out;
+    out << "{\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        std::vector<double> sorted = results[i].micros;
+        std::sort(sorted.begin(), sorted.end());
+        double sum = 0.0;
+        for (double v : sorted) sum += v;
+        char line[512];
+        std::snprintf(line, sizeof(line),
+                      "    {\"name\": \"%s\", \"lines\": %zu, \"samples\": %zu, \"min_us\": %.1f, \"p50_us\": %.1f, "
+                      "\"p90_us\": %.1f, \"p99_us\": %.1f, \"max_us\": %.1f, \"mean_us\": %.1f}%s\n",
+                      results[i].name.c_str(), results[i].lines, sorted.size(),
+                      sorted.empty() ? 0.0 : sorted.front(), percentile(sorted, 50), percentile(sorted, 90),
+                      percentile(sorted, 99), sorted.empty() ? 0.0 : sorted.back(),
+                      sorted.empty() ? 0.0 : sum / sorted.size(), i + 1 < results.size() ? "," : "");
+        out << line;
+    }
+    out << "  ]\n}\n";
+    return out.str();
+}
+
+// --------- Input Replay ---------
+static void sendKey(SDL_Keycode key) {
+    SDL_Event e;
+    SDL_zero(e);
+    e.type = SDL_KEYDOWN;
+    e.key.keysym.sym = key;
+    handleInput(e);
+}
+
+static void sendText(char c) {
+    SDL_Event e;
+    SDL_zero(e);
+    e.type = SDL_TEXTINPUT;
+    e.text.text[0] = c;
+    handleInput(e);
+}
+
+// A line of typing with a correction and a line break, replayed as keys
+static const char* KEY_SCRIPT = "for (int i = 0; i < count; i++) total += values[i];\b\b\b\b\bi];\n";
+
+static void replayKey(char c) {
+    if (c == '\n') {
+        sendKey(SDLK_RETURN);
+    } else if (c == '\b') {
+        sendKey(SDLK_BACKSPACE);
+    } else {
+        sendText(c);
+    }
+}
+
+static void sendMouse(Uint32 type, int x, int y) {
+    SDL_Event e;
+    SDL_zero(e);
+    e.type = type;
+    e.button.button = SDL_BUTTON_LEFT;
+    e.button.x = x;
+    e.button.y = y;
+    handleInput(e);
+}
+
+// --------- Synthetic Files ---------
+static std::string syntheticSource(size_t lines) {
+    static const char* templates[] = {
+        "#include <vector>",
+        "// Accumulates the running total of the samples seen so far",
+        "static int accumulate(const std::vector<int>& values, int limit) {",
+        "    int total = 0; /* running sum */",
+        "    for (size_t i = 0; i < values.size() && total < limit; i++) total += values[i];",
+        "    const char* label = \"accumulate\"; double scale = 1.5e3;",
+        "    return total;",
+        "}",
+        ""
+    };
+    std::string text;
+    for (size_t i = 0; i < lines; i++) {
+        text += templates[i % (sizeof(templates) / sizeof(templates[0]))];
+        if (i + 1 < lines) text += '\n';
+    }
+    return text;
+}
+
+// --------- Benchmarks ---------
+static void benchLoad(const std::string& path, size_t lines, int samples) {
+    Result& r = result("load_file", lines);
+    for (int i = 0; i < samples; i++) {
+        auto start = Clock::now();
+        loadFromFile(path);
+        r.micros.push_back(microsSince(start));
+    }
+}
+
+static void benchRender(size_t lines, int samples, std::mt19937& rng) {
+    Result& editor = result("render_editor", lines);
+    Result& frame = result("render_frame_full", lines);
+    for (int i = 0; i < samples; i++) {
+        currentLine = (int)(rng() % buffer.lineCount());
+        cursorPos = 0;
+        ensureCursorVisible();
+
+        auto start = Clock::now();
+        renderTextEditor();
+        editor.micros.push_back(microsSince(start));
+
+        markDirty(DIRTY_ALL);
+        start = Clock::now();
+        renderFrame();
+        frame.micros.push_back(microsSince(start));
+    }
+}
+
+// Clicks at random points of the visible text, which hit-tests through the
+// cached line layouts
+static void benchClick(size_t lines, int samples, std::mt19937& rng) {
+    Result& r = result("click_to_place_cursor", lines);
+    renderFrame();
+    for (int i = 0; i < samples; i++) {
+        int x = 100 + (int)(rng() % 700);
+        int y = (int)(rng() % 560);
+        auto start = Clock::now();
+        sendMouse(SDL_MOUSEBUTTONDOWN, x, y);
+        sendMouse(SDL_MOUSEBUTTONUP, x, y);
+        r.micros.push_back(microsSince(start));
+    }
+}
+
+static void benchTyping(size_t lines, int repeats) {
+    Result& keys = result("keystroke", lines);
+    Result& frames = result("keystroke_with_frame", lines);
+    currentLine = (int)(buffer.lineCount() / 2);
+    cursorPos = 0;
+    ensureCursorVisible();
+    renderFrame();
+
+    for (int i = 0; i < repeats; i++) {
+        for (const char* c = KEY_SCRIPT; *c; c++) {
+            auto start = Clock::now();
+            replayKey(*c);
+            keys.micros.push_back(microsSince(start));
+            renderFrame();
+            frames.micros.push_back(microsSince(start));
+        }
+    }
+}
+
+// Indexing the freshly loaded file in the main loop's slices, then typing
+// the start of an identifier until the suggestions open and drawing them
+static void benchCompletion(size_t lines, int samples, std::mt19937& rng) {
+    auto start = Clock::now();
+    while (identifiers.pending()) pollIdentifierIndex();
+    result("index_identifiers", lines).micros.push_back(microsSince(start));
+
+    Result& r = result("completion_with_render", lines);
+    for (int i = 0; i < samples; i++) {
+        currentLine = (int)(rng() % buffer.lineCount());
+        cursorPos = 0;
+        ensureCursorVisible();
+        sendText('a');
+        start = Clock::now();
+        sendText('c');
+        renderTextEditor();
+        r.micros.push_back(microsSince(start));
+        sendKey(SDLK_ESCAPE);
+    }
+}
+
+// Undoes everything the typing and completion benchmarks recorded, then
+// redoes it
+static void benchUndoRedo(size_t lines) {
+    Result& undos = result("undo", lines);
+    Result& redos = result("redo", lines);
+    while (history.canUndo()) {
+        auto start = Clock::now();
+        undo();
+        undos.micros.push_back(microsSince(start));
+    }
+    while (history.canRedo()) {
+        auto start = Clock::now();
+        redo();
+        redos.micros.push_back(microsSince(start));
+    }
+}
+
+static void benchSave(const std::string& path, size_t lines, int samples) {
+    Result& r = result("save_file", lines);
+    for (int i = 0; i < samples; i++) {
+        auto start = Clock::now();
+        saveToFile(path);
+        saveQueue.flush();
+        r.micros.push_back(microsSince(start));
+    }
+    pollSaveQueue();
+}
+
+static double timeBuild() {
+    auto start = Clock::now();
+    compileAndRun();
+    while (buildJob.running()) {
+        pollBuildJob();
+        SDL_Delay(1);
+    }
+    buildJob.wait();
+    pollBuildJob();
+    return microsSince(start);
+}
+
+// Cold build with a source the cache has never seen, then the same again
+static void benchCompile() {
+    char marker[64];
+    std::snprintf(marker, sizeof(marker), "// bench %lld\n",
+                  (long long)Clock::now().time_since_epoch().count());
+    buffer.setText(std::string(marker) +
+                   "#include <iostream>\nint main() { std::cout << \"benchmark\" << std::endl; return 0; }\n");
+
+    result("compile_run_cold", 0).micros.push_back(timeBuild());
+    std::cerr << "cold build: " << buildStatus << std::endl;
+    Result& warm = result("compile_run_cached", 0);
+    for (int i = 0; i < 3; i++) warm.micros.push_back(timeBuild());
+    std::cerr << "cached build: " << buildStatus << std::endl;
+}
+
+// --------- Main ---------
+int main(int argc, char* argv[]) {
+    std::vector<size_t> sizes = {1000, 10000, 100000};
+    int samples = 50;
+    bool compile = true;
+    std::string outPath;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--sizes" && i + 1 < argc) {
+            sizes.clear();
+            std::stringstream list(argv[++i]);
+            std::string item;
+            while (std::getline(list, item, ',')) sizes.push_back(std::stoul(item));
+        } else if (arg == "--samples" && i + 1 < argc) {
+            samples = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--no-compile") {
+            compile = false;
+        } else if (arg == "--out" && i + 1 < argc) {
+            outPath = argv[++i];
+        } else {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--sizes 1000,10000,100000] [--samples N] [--no-compile] [--out results.json]" << std::endl;
+            return 2;
+        }
+    }
+
+    // No display and no GPU: dummy video driver, software renderer
+    SDL_SetHint(SDL_HINT_VIDEODRIVER, "dummy");
+    SDL_SetHint(SDL_HINT_RENDER_DRIVER, "software");
+    if (!init()) {
+        std::cerr << "Initialization failed" << std::endl;
+        return 1;
+    }
+
+    std::mt19937 rng(12345);
+    for (size_t lines : sizes) {
+        std::string path = "bench_" + std::to_string(lines) + ".cpp";
+        std::ofstream(path, std::ios::binary) << syntheticSource(lines);
+
+        benchLoad(path, lines, std::max(1, samples / 10));
+        benchCompletion(lines, samples, rng);
+        benchRender(lines, samples, rng);
+        benchClick(lines, samples, rng);
+        benchTyping(lines, std::max(1, samples / 10));
+        benchUndoRedo(lines);
+        benchSave(path, lines, std::max(1, samples / 10));
+
+        std::remove(path.c_str());
+        std::cerr << "finished " << lines << " lines" << std::endl;
+    }
+    if (compile) benchCompile();
+
+    close();
+
+    std::string json = toJson();
+    if (outPath.empty()) {
+        std::cout << json;
+    } else {
+        std::ofstream(outPath) << json;
+    }
+    return 0;
+}
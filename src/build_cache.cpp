@@ -0,0 +1,229 @@
+#include "build_cache.hpp"
+#include "sha256.hpp"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+const char* BUILD_CACHE_DIR = ".ide_cache";
+const uint64_t BUILD_CACHE_MAX_BYTES = 256ull * 1024 * 1024;
+
+// Bump when the entry layout or the key recipe changes
+const char* CACHE_FORMAT = "ide-build-cache-v2";
+
+// How many local headers one key follows before it gives up on the source
+const size_t MAX_KEY_HEADERS = 1000;
+
+BuildCache::BuildCache(std::string directory, uint64_t maxBytes)
+    : directory(std::move(directory)), maxBytes(maxBytes) {}
+
+// --------- Local Headers ---------
+struct IncludeLine {
+    std::string name;
+    bool quoted;
+};
+
+// The #include lines of a file. Returns false for one that names a macro,
+// whose header the key cannot know. Lines inside comments or #if blocks are
+// counted too, which only ever makes the key stricter.
+static bool scanIncludes(std::string_view text, std::vector<IncludeLine>& includes) {
+    size_t at = 0;
+    while (at < text.size()) {
+        size_t end = text.find('\n', at);
+        if (end == std::string_view::npos) end = text.size();
+        std::string_view line = text.substr(at, end - at);
+        at = end + 1;
+
+        size_t i = line.find_first_not_of(" \t");
+        if (i == std::string_view::npos || line[i] != '#') continue;
+        i = line.find_first_not_of(" \t", i + 1);
+        if (i == std::string_view::npos || line.compare(i, 7, "include") != 0) continue;
+        i = line.find_first_not_of(" \t", i + 7);
+        if (i == std::string_view::npos) continue;
+        char open = line[i];
+        if (open != '"' && open != '<') return false;
+        size_t close = line.find(open == '"' ? '"' : '>', i + 1);
+        if (close == std::string_view::npos) continue;
+        includes.push_back({std::string(line.substr(i + 1, close - i - 1)), open == '"'});
+    }
+    return true;
+}
+
+// Hashes every header text includes that is not a system header: quoted
+// names found next to the including file or in -iquote and -I directories,
+// and <names> found in -I directories, followed into the headers they
+// include in turn
+static bool hashHeaders(Sha256& hash, std::string_view text, const fs::path& from,
+                        const std::vector<fs::path>& quoteDirs, const std::vector<fs::path>& userDirs,
+                        std::vector<fs::path>& seen) {
+    std::vector<IncludeLine> includes;
+    if (!scanIncludes(text, includes)) return false;
+    for (const IncludeLine& include : includes) {
+        std::vector<fs::path> dirs;
+        if (include.quoted) {
+            dirs.push_back(from);
+            dirs.insert(dirs.end(), quoteDirs.begin(), quoteDirs.end());
+        }
+        dirs.insert(dirs.end(), userDirs.begin(), userDirs.end());
+
+        std::error_code ec;
+        fs::path found;
+        for (const fs::path& dir : dirs) {
+            fs::path candidate = dir / include.name;
+            if (fs::is_regular_file(candidate, ec)) {
+                found = fs::weakly_canonical(candidate, ec);
+                break;
+            }
+        }
+        // A quoted header that is not there yet still counts, so creating it
+        // later changes the key
+        hash.update(include.name);
+        hash.update(found.empty() ? std::string_view("\0missing\0", 9) : std::string_view("\0", 1));
+        if (found.empty() || std::find(seen.begin(), seen.end(), found) != seen.end()) continue;
+        if (seen.size() == MAX_KEY_HEADERS) return false;
+        seen.push_back(found);
+
+        std::ifstream file(found, std::ios::binary);
+        std::stringstream contents;
+        contents << file.rdbuf();
+        std::string header = contents.str();
+        hash.update(header);
+        hash.update(std::string_view("\0", 1));
+        if (!hashHeaders(hash, header, found.parent_path(), quoteDirs, userDirs, seen)) return false;
+    }
+    return true;
+}
+
+std::string BuildCache::makeKey(const std::vector<std::string_view>& source, const std::vector<std::string>& command,
+                                const std::string& compilerVersion, const std::string& sourceDirectory) {
+    // Every field is followed by a NUL so neighbouring fields cannot run together
+    Sha256 hash;
+    hash.update(CACHE_FORMAT);
+    hash.update(std::string_view("\0", 1));
+    hash.update(compilerVersion);
+    hash.update(std::string_view("\0", 1));
+    std::vector<fs::path> quoteDirs, userDirs;
+    for (size_t i = 0; i < command.size(); i++) {
+        const std::string& arg = command[i];
+        hash.update(arg);
+        hash.update(std::string_view("\0", 1));
+        for (auto [flag, dirs] : {std::make_pair("-iquote", &quoteDirs), std::make_pair("-I", &userDirs)}) {
+            size_t length = std::strlen(flag);
+            if (arg.compare(0, length, flag) != 0) continue;
+            if (arg.size() > length) {
+                dirs->push_back(arg.substr(length));
+            } else if (i + 1 < command.size()) {
+                dirs->push_back(command[i + 1]);
+            }
+            break;
+        }
+    }
+    for (std::string_view run : source) hash.update(run);
+    hash.update(std::string_view("\0", 1));
+
+    // Headers are scanned in the joined text, since a run can end mid-line
+    std::string joined;
+    std::string_view text = source.size() == 1 ? source.front() : std::string_view();
+    if (source.size() > 1) {
+        for (std::string_view run : source) joined.append(run);
+        text = joined;
+    }
+    std::vector<fs::path> seen;
+    if (!hashHeaders(hash, text, sourceDirectory, quoteDirs, userDirs, seen)) return std::string();
+    return hash.hexDigest();
+}
+
+bool BuildCache::fetch(const std::string& key, const std::string& outputPath, std::vector<std::string>& diagnostics) {
+    if (key.empty()) return false;
+    std::lock_guard<std::mutex> lock(mutex);
+    std::error_code ec;
+    fs::path entry = fs::path(directory) / key;
+    if (!fs::exists(entry / "binary", ec)) return false;
+
+    fs::copy_file(entry / "binary", outputPath, fs::copy_options::overwrite_existing, ec);
+    if (ec) {
+        std::cerr << "Build cache: could not copy " << key << ": " << ec.message() << std::endl;
+        return false;
+    }
+    fs::permissions(outputPath, fs::perms::owner_exec | fs::perms::owner_read | fs::perms::owner_write,
+                    fs::perm_options::add, ec);
+
+    diagnostics.clear();
+    std::ifstream file(entry / "diagnostics.txt");
+    std::string line;
+    while (std::getline(file, line)) diagnostics.push_back(line);
+
+    // The entry's modification time is its LRU timestamp
+    fs::last_write_time(entry, fs::file_time_type::clock::now(), ec);
+    return true;
+}
+
+void BuildCache::store(const std::string& key, const std::string& binaryPath, const std::vector<std::string>& diagnostics) {
+    if (key.empty()) return;
+    std::lock_guard<std::mutex> lock(mutex);
+    std::error_code ec;
+    fs::path entry = fs::path(directory) / key;
+    if (fs::exists(entry, ec)) return;
+
+    // Filled under a private name and renamed into place, so a crash never
+    // leaves a half-written entry behind
+    std::hash<std::thread::id> threadHash;
+    fs::path staging = fs::path(directory) / (key + ".tmp" + std::to_string(threadHash(std::this_thread::get_id())));
+    fs::create_directories(staging, ec);
+    if (ec) {
+        std::cerr << "Build cache: could not create " << staging.string() << ": " << ec.message() << std::endl;
+        return;
+    }
+
+    fs::copy_file(binaryPath, staging / "binary", fs::copy_options::overwrite_existing, ec);
+    std::ofstream file(staging / "diagnostics.txt", std::ios::binary);
+    for (const std::string& line : diagnostics) file << line << '\n';
+    file.close();
+
+    if (!ec && file) fs::rename(staging, entry, ec);
+    if (ec || !file) {
+        fs::remove_all(staging, ec);
+        return;
+    }
+    evict();
+}
+
+// Removes the least recently used entries until the cache fits its limit
+void BuildCache::evict() {
+    struct Entry {
+        fs::path path;
+        fs::file_time_type used;
+        uint64_t bytes;
+    };
+    std::vector<Entry> entries;
+    uint64_t total = 0;
+    std::error_code ec;
+
+    for (const fs::directory_entry& dir : fs::directory_iterator(directory, ec)) {
+        if (!dir.is_directory(ec)) continue;
+        Entry entry{dir.path(), fs::last_write_time(dir.path(), ec), 0};
+        for (const fs::directory_entry& file : fs::directory_iterator(dir.path(), ec)) {
+            if (file.is_regular_file(ec)) entry.bytes += file.file_size(ec);
+        }
+        total += entry.bytes;
+        entries.push_back(std::move(entry));
+    }
+    if (total <= maxBytes) return;
+
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.used < b.used; });
+    for (const Entry& entry : entries) {
+        if (total <= maxBytes) break;
+        fs::remove_all(entry.path, ec);
+        total -= entry.bytes;
+    }
+}
+
+BuildCache& buildCache() {
+    static BuildCache cache(BUILD_CACHE_DIR, BUILD_CACHE_MAX_BYTES);
+    return cache;
+}
@@ -0,0 +1,48 @@
+#ifndef BUILD_CACHE_HPP
+#define BUILD_CACHE_HPP
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// On-disk cache of compiled programs keyed by a SHA-256 of everything that
+// affects the build: the source text, the headers it includes other than
+// system ones, the compiler command line and the compiler's version. Each
+// entry is a directory holding the binary and the compiler's diagnostics.
+// The least recently used entries are evicted once the cache grows past its
+// size limit. Safe to use from several threads.
+class BuildCache {
+public:
+    BuildCache(std::string directory, uint64_t maxBytes);
+
+    // The source may be given in pieces, as a document snapshot holds it.
+    // Quoted includes are looked up from sourceDirectory, then in the
+    // command's -iquote and -I directories. Returns an empty key, which
+    // never hits and is never stored, when the source includes a header
+    // through a macro.
+    static std::string makeKey(const std::vector<std::string_view>& source, const std::vector<std::string>& command,
+                               const std::string& compilerVersion, const std::string& sourceDirectory = ".");
+
+    // Copies the cached binary to outputPath and returns its diagnostics.
+    // Returns false on a miss.
+    bool fetch(const std::string& key, const std::string& outputPath, std::vector<std::string>& diagnostics);
+
+    // Records a successful build
+    void store(const std::string& key, const std::string& binaryPath, const std::vector<std::string>& diagnostics);
+
+    uint64_t sizeLimit() const { return maxBytes; }
+
+private:
+    void evict();
+
+    std::string directory;
+    uint64_t maxBytes;
+    std::mutex mutex;
+};
+
+// The cache shared by the IDE and compile()
+BuildCache& buildCache();
+
+#endif // BUILD_CACHE_HPP
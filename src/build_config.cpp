@@ -0,0 +1,198 @@
+#include "build_config.hpp"
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+// Written the first time the IDE starts, for the user to edit
+static const char* DEFAULT_CONFIGS = R"(# Build configurations for Run, Benchmark Run and Compare.
+# "[Name]" starts one; flags are passed to the single g++ command that
+# compiles and links. Each configuration gets its own binary unless
+# "output =" names one.
+
+[Debug]
+flags = -std=c++17 -g -O0
+
+[Release]
+flags = -std=c++17 -O2 -DNDEBUG
+
+[Native]
+flags = -std=c++17 -O3 -march=native -flto -DNDEBUG
+
+[ASan]
+flags = -std=c++17 -g -O1 -fno-omit-frame-pointer -fsanitize=address,undefined
+)";
+
+static std::string trim(const std::string& text) {
+    size_t start = text.find_first_not_of(" \t\r");
+    if (start == std::string::npos) return std::string();
+    size_t end = text.find_last_not_of(" \t\r");
+    return text.substr(start, end - start + 1);
+}
+
+static std::vector<std::string> splitWords(const std::string& text) {
+    std::vector<std::string> words;
+    std::istringstream stream(text);
+    std::string word;
+    while (stream >> word) words.push_back(word);
+    return words;
+}
+
+// --------- Config File ---------
+bool loadBuildConfigs(const std::string& path, const std::string& outputStem, std::vector<BuildConfig>& configs,
+                      std::string& error) {
+    std::ifstream file(path);
+    if (!file) {
+        std::ofstream(path) << DEFAULT_CONFIGS;
+        file.open(path);
+        if (!file) {
+            error = "Unable to open " + path;
+            return false;
+        }
+    }
+    configs.clear();
+    std::vector<std::string> outputWhere;   // The "path:line: " that set each configuration's output
+
+    std::string line;
+    int number = 0;
+    while (std::getline(file, line)) {
+        number++;
+        std::string text = trim(line);
+        if (text.empty() || text[0] == '#') continue;
+        std::string where = path + ":" + std::to_string(number) + ": ";
+
+        if (text.front() == '[') {
+            std::string name = text.back() == ']' ? trim(text.substr(1, text.size() - 2)) : std::string();
+            if (name.empty()) {
+                error = where + "expected [Name]";
+                return false;
+            }
+            for (const BuildConfig& config : configs) {
+                if (config.name == name) {
+                    error = where + "configuration '" + name + "' is defined twice";
+                    return false;
+                }
+            }
+            configs.push_back(BuildConfig());
+            configs.back().name = name;
+            outputWhere.push_back(where);
+            continue;
+        }
+        size_t equals = text.find('=');
+        if (equals == std::string::npos || configs.empty()) {
+            error = where + (configs.empty() ? "options must follow a [Name] line" : "expected key = value");
+            return false;
+        }
+        std::string key = trim(text.substr(0, equals));
+        std::string value = trim(text.substr(equals + 1));
+        BuildConfig& config = configs.back();
+        if (key == "compiler") {
+            config.compiler = value;
+        } else if (key == "flags") {
+            config.flags = splitWords(value);
+        } else if (key == "output") {
+            config.output = value;
+            outputWhere.back() = where;
+        } else {
+            error = where + "unknown option '" + key + "'";
+            return false;
+        }
+    }
+    if (configs.empty()) {
+        error = path + ": no configurations defined";
+        return false;
+    }
+
+    for (BuildConfig& config : configs) {
+        if (!config.output.empty()) continue;
+        std::string suffix;
+        for (char c : config.name) suffix += std::isalnum((unsigned char)c) ? (char)std::tolower((unsigned char)c) : '_';
+        config.output = outputStem + "-" + suffix + ".exe";
+    }
+
+    // Compare builds both sides before timing them, so two configurations
+    // sharing a binary would measure one of them twice. Names are compared
+    // ignoring case, as Windows and macOS file systems do.
+    auto folded = [](std::string name) {
+        for (char& c : name) c = (char)std::tolower((unsigned char)c);
+        return name;
+    };
+    for (size_t i = 0; i < configs.size(); i++) {
+        for (size_t j = 0; j < i; j++) {
+            if (folded(configs[i].output) != folded(configs[j].output)) continue;
+            error = outputWhere[i] + "configuration '" + configs[i].name + "' builds " + configs[i].output +
+                    ", as '" + configs[j].name + "' does; give one of them its own output";
+            return false;
+        }
+    }
+    return true;
+}
+
+bool needsUnlimitedAddressSpace(const BuildConfig& config) {
+    for (const std::string& flag : config.flags) {
+        if (flag.compare(0, 11, "-fsanitize=") != 0) continue;
+        std::istringstream list(flag.substr(11));
+        std::string sanitizer;
+        while (std::getline(list, sanitizer, ',')) {
+            if (sanitizer == "address" || sanitizer == "hwaddress" || sanitizer == "thread" || sanitizer == "memory") {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// --------- Report ---------
+// "2.50x" of b relative to a, or blank when either side is missing
+static std::string ratio(double a, double b) {
+    if (a <= 0 || b <= 0) return std::string();
+    char text[32];
+    std::snprintf(text, sizeof(text), "%.2fx", b / a);
+    return text;
+}
+
+static std::string row(const char* label, const std::string& a, const std::string& b, const std::string& note) {
+    char line[160];
+    std::snprintf(line, sizeof(line), "  %-12s %14s %14s   %s", label, a.c_str(), b.c_str(), note.c_str());
+    return line;
+}
+
+static std::string quantity(double value, double scale, const char* unit) {
+    char text[32];
+    std::snprintf(text, sizeof(text), "%.2f %s", value * scale, unit);
+    return text;
+}
+
+std::vector<std::string> formatComparison(const ConfigMeasurement& a, const ConfigMeasurement& b) {
+    std::vector<std::string> lines;
+    lines.push_back(row("Compare", a.name, b.name, b.name + " / " + a.name));
+    auto compiled = [](const ConfigMeasurement& side) {
+        return side.built ? quantity(side.compileSeconds, 1.0, "s") : std::string("failed");
+    };
+    lines.push_back(row("compile", compiled(a), compiled(b), ratio(a.compileSeconds, b.compileSeconds)));
+    if (!a.built || !b.built) return lines;
+    lines.push_back(row("binary", quantity((double)a.binaryBytes, 1.0 / 1024, "KB"),
+                        quantity((double)b.binaryBytes, 1.0 / 1024, "KB"),
+                        ratio((double)a.binaryBytes, (double)b.binaryBytes)));
+
+    // Runtimes are medians of the timed runs; a side with none shows "-"
+    auto stat = [](const ConfigMeasurement& side, double value, double scale, const char* unit) {
+        return side.run.runs > 0 ? quantity(value, scale, unit) : std::string("-");
+    };
+    bool bothRan = a.run.runs > 0 && b.run.runs > 0;
+    lines.push_back(row("run median", stat(a, a.run.wall.median, 1000.0, "ms"), stat(b, b.run.wall.median, 1000.0, "ms"),
+                        bothRan ? ratio(a.run.wall.median, b.run.wall.median) : std::string()));
+    lines.push_back(row("run p95", stat(a, a.run.wall.p95, 1000.0, "ms"), stat(b, b.run.wall.p95, 1000.0, "ms"),
+                        bothRan ? ratio(a.run.wall.p95, b.run.wall.p95) : std::string()));
+    lines.push_back(row("cpu median", stat(a, a.run.cpu.median, 1000.0, "ms"), stat(b, b.run.cpu.median, 1000.0, "ms"),
+                        bothRan ? ratio(a.run.cpu.median, b.run.cpu.median) : std::string()));
+    if (a.run.memory.max > 0 && b.run.memory.max > 0) {
+        lines.push_back(row("peak memory", quantity(a.run.memory.median, 1.0 / (1024 * 1024), "MB"),
+                            quantity(b.run.memory.median, 1.0 / (1024 * 1024), "MB"),
+                            ratio(a.run.memory.median, b.run.memory.median)));
+    }
+    for (const ConfigMeasurement* side : {&a, &b}) {
+        if (!side->run.failure.empty()) lines.push_back("Error: " + side->name + ": stopped, " + side->run.failure);
+    }
+    return lines;
+}
@@ -0,0 +1,43 @@
+#ifndef BUILD_CONFIG_HPP
+#define BUILD_CONFIG_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "program_benchmark.hpp"
+
+// A named way of building the editor's program: Debug, Release and so on
+struct BuildConfig {
+    std::string name;
+    std::string compiler = "g++";
+    std::vector<std::string> flags;   // Passed to the one command that compiles and links
+    std::string output;               // Each configuration keeps its own binary
+};
+
+// A config file: "[Name]" starts a configuration, followed by "key = value"
+// options (compiler, flags, output). Blank lines and lines starting with #
+// are skipped. A configuration without an output line builds
+// outputStem-name.exe. Two configurations that end up with the same output
+// are an error. When the file does not exist it is written with Debug,
+// Release, Native and ASan configurations first.
+bool loadBuildConfigs(const std::string& path, const std::string& outputStem, std::vector<BuildConfig>& configs,
+                      std::string& error);
+
+// Sanitizers that reserve terabytes of address space for shadow memory, so
+// their programs cannot run under an address space limit
+bool needsUnlimitedAddressSpace(const BuildConfig& config);
+
+// One configuration's side of a comparison
+struct ConfigMeasurement {
+    std::string name;
+    bool built = false;
+    double compileSeconds = 0.0;
+    uintmax_t binaryBytes = 0;
+    InputBenchmark run;
+};
+
+// Console lines setting the two measurements side by side, with the ratio of
+// each quantity
+std::vector<std::string> formatComparison(const ConfigMeasurement& a, const ConfigMeasurement& b);
+
+#endif // BUILD_CONFIG_HPP
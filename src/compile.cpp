@@ -1,42 +1,161 @@
-#include "compile.hpp"
-
-bool compile(const std::string &filename) {
-    std::string compileCommand = "g++ " + filename + " -o output";
-    int result = std::system(compileCommand.c_str());
-    return (result == 0);
-}
-
-void run(const std::string &filename) {
-    std::string runCommand = ".\\" + filename + ".exe ";
-    std::system(runCommand.c_str());
-}
-
-void run_in_another_window(const std::string &filename) {
-#ifdef _WIN32
-    std::string runCommand = "start cmd /c \"" + filename + " & pause\"";
-#elif __linux__
-    std::string runCommand = "x-terminal-emulator -e \"" + filename + "; read -n 1 -s -r -p 'Press any key to continue...'\"";
-#elif __APPLE__
-    std::string runCommand = "osascript -e 'tell application \"Terminal\" to do script \"" + filename + "\"'";
-#else
-    std::cerr << "Unsupported OS!" << std::endl;
-    return;
-#endif
-    std::system(runCommand.c_str());
-}
-
-void debug(const std::string &filename) {
-    std::cout << "Debugging " << filename << " (simulated):\n";
-    std::ifstream file(filename);
-    if (file.is_open()) {
-        std::string line;
-        int lineNumber = 1;
-        while (std::getline(file, line)) {
-            std::cout << lineNumber << ": " << line << std::endl;
-            lineNumber++;
-        }
-        file.close();
-    } else {
-        std::cerr << "Unable to open file for debugging." << std::endl;
-    }
-}
+#include "compile.hpp"
+#include "build_cache.hpp"
+#include "pch.hpp"
+#include "process.hpp"
+#include <chrono>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <sstream>
+
+#ifdef _WIN32
+const std::string COMPILE_OUTPUT = "output.exe";  // g++ adds the extension on Windows
+#else
+const std::string COMPILE_OUTPUT = "output";
+#endif
+
+// Runs a command to completion, collecting stdout and stderr together
+static int runCollecting(const std::vector<std::string> &args, std::string &output) {
+    ProcessOptions options;
+    options.args = args;
+    options.mergeStderr = true;
+    ChildProcess process;
+    std::string error, unused;
+    if (!process.start(options, error)) {
+        output += error + "\n";
+        return -1;
+    }
+    while (process.read(1000, output, unused)) {}
+    return process.wait();
+}
+
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool compile(const std::string &filename, const BuildConfig &config) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file) {
+        std::cerr << "Unable to open " << filename << std::endl;
+        return false;
+    }
+    std::stringstream source;
+    source << file.rdbuf();
+
+    const std::string &binary = config.output.empty() ? COMPILE_OUTPUT : config.output;
+    std::vector<std::string> command = {config.compiler, filename};
+    command.insert(command.end(), config.flags.begin(), config.flags.end());
+    command.insert(command.end(), {"-o", binary});
+    std::string text = source.str();
+    std::string directory = std::filesystem::path(filename).parent_path().string();
+    if (directory.empty()) directory = ".";
+    std::string key = BuildCache::makeKey({text}, command, compilerVersion(command[0]), directory);
+    std::vector<std::string> diagnostics;
+    if (buildCache().fetch(key, binary, diagnostics)) {
+        for (const std::string &line : diagnostics) std::cerr << line << std::endl;
+        std::cout << "Build cache hit for " << filename << std::endl;
+        return true;
+    }
+
+    PrecompiledHeader pch;
+    bool hasPch = findPrecompiledHeader(text, command[0], config.flags, pch);
+    std::vector<std::string> args = command;
+    if (hasPch && pch.ready) {
+        std::vector<std::string> pchArgs = precompiledHeaderArgs(pch);
+        args.insert(args.end(), pchArgs.begin(), pchArgs.end());
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::string output;
+    int exitCode = runCollecting(args, output);
+    double seconds = secondsSince(start);
+
+    bool pchRejected = false;
+    std::istringstream lines(output);
+    std::string line;
+    while (std::getline(lines, line)) {
+        if (isInvalidPchWarning(line)) {
+            pchRejected = true;
+            continue;
+        }
+        std::cerr << line << std::endl;
+        diagnostics.push_back(line);
+    }
+    if (pchRejected) discardPrecompiledHeader(pch);
+    if (exitCode != 0) return false;
+    buildCache().store(key, binary, diagnostics);
+
+    if (hasPch && pch.ready && !pchRejected) {
+        std::cout << "Compiled " << filename << " in " << seconds << "s with precompiled header";
+        double baseline = pchBaselineSeconds(pch);
+        if (baseline > 0) std::cout << " (" << baseline << "s without)";
+        std::cout << std::endl;
+    } else if (hasPch) {
+        // Precompile the include block now so the next compile can use it
+        setPchBaselineSeconds(pch, seconds);
+        std::string pchOutput;
+        finishPrecompiledHeader(pch, runCollecting(precompiledHeaderCommand(pch, command[0], config.flags), pchOutput));
+    }
+    return true;
+}
+
+std::string compilerVersion(const std::string &compiler) {
+    static std::mutex mutex;
+    static std::map<std::string, std::string> versions;
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto found = versions.find(compiler);
+    if (found != versions.end()) return found->second;
+
+    ProcessOptions options;
+    options.args = {compiler, "--version"};
+    options.mergeStderr = true;
+    ChildProcess process;
+    std::string output, unused, error;
+    if (process.start(options, error)) {
+        while (process.read(1000, output, unused)) {}
+        process.wait();
+    }
+    std::string version = output.substr(0, output.find('\n'));
+    versions[compiler] = version;
+    return version;
+}
+
+bool compilerSupportsJsonDiagnostics(const std::string &compiler) {
+    static std::mutex mutex;
+    static std::map<std::string, bool> support;
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto found = support.find(compiler);
+    if (found != support.end()) return found->second;
+
+    // Clang and GCC 15 and later reject the flag, older GCC accepts it
+#ifdef _WIN32
+    const char *empty = "NUL";
+#else
+    const char *empty = "/dev/null";
+#endif
+    std::string output;
+    bool supported = runCollecting({compiler, "-fdiagnostics-format=json", "-E", "-x", "c++", empty}, output) == 0;
+    support[compiler] = supported;
+    return supported;
+}
+
+void run(const std::string &filename) {
+    std::string runCommand = ".\\" + filename + ".exe ";
+    std::system(runCommand.c_str());
+}
+
+void run_in_another_window(const std::string &filename) {
+#ifdef _WIN32
+    std::string runCommand = "start cmd /c \"" + filename + " & pause\"";
+#elif __linux__
+    std::string runCommand = "x-terminal-emulator -e \"" + filename + "; read -n 1 -s -r -p 'Press any key to continue...'\"";
+#elif __APPLE__
+    std::string runCommand = "osascript -e 'tell application \"Terminal\" to do script \"" + filename + "\"'";
+#else
+    std::cerr << "Unsupported OS!" << std::endl;
+    return;
+#endif
+    std::system(runCommand.c_str());
+}
@@ -1,22 +1,29 @@
-#ifndef COMPILE_HPP
-#define COMPILE_HPP
-
-#include <iostream>
-#include <cstdlib>
-#include <string>
-#include <vector>
-#include <fstream>
-
-// Function to compile a C++ source file
-bool compile(const std::string &filename);
-
-// Function to run an executable
-void run(const std::string &filename);
-
-// Function to run in another window
-void run_in_another_window(const std::string &filename);
-
-// Function to debug a file
-void debug(const std::string &filename);
-
-#endif // COMPILE_HPP
+#ifndef COMPILE_HPP
+#define COMPILE_HPP
+
+#include <iostream>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <fstream>
+#include "build_config.hpp"
+
+// Function to compile a C++ source file with a build configuration's
+// compiler and flags, reusing a cached binary when the source, command and
+// compiler are unchanged. The binary is the configuration's output, or
+// "output" (output.exe on Windows) when it names none.
+bool compile(const std::string &filename, const BuildConfig &config = BuildConfig());
+
+// Function to get the first line of `compiler --version`, remembered per compiler
+std::string compilerVersion(const std::string &compiler);
+
+// Function to check, once per compiler, whether it accepts -fdiagnostics-format=json
+bool compilerSupportsJsonDiagnostics(const std::string &compiler);
+
+// Function to run an executable
+void run(const std::string &filename);
+
+// Function to run in another window
+void run_in_another_window(const std::string &filename);
+
+#endif // COMPILE_HPP
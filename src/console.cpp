@@ -0,0 +1,53 @@
+#include "console.hpp"
+#include <algorithm>
+
+// Longer lines are cut; nobody reads past this in a 1200-pixel panel
+const size_t MAX_LINE_BYTES = 4096;
+
+OutputConsole::OutputConsole(size_t maxLines, size_t maxBytes)
+    : bytes(std::max(maxBytes, MAX_LINE_BYTES + 1)), entries(std::max<size_t>(maxLines, 1)) {}
+
+void OutputConsole::dropOldest() {
+    first = (first + 1) % entries.size();
+    count--;
+    dropped++;
+}
+
+// Lines are laid out one after another in the byte ring, each followed by a
+// separator byte so that every line owns a non-empty range. A line that does
+// not fit before the end of the ring starts over at zero; the lines it
+// overwrites are always the oldest ones.
+void OutputConsole::append(std::string_view line) {
+    line = line.substr(0, MAX_LINE_BYTES);
+    size_t needed = line.size() + 1;
+
+    if (writePos + needed > bytes.size()) {
+        // Lines past writePos are the oldest and sit in the tail being skipped
+        while (count > 0 && entries[first].offset >= writePos) dropOldest();
+        writePos = 0;
+    }
+    while (count > 0 && entries[first].offset >= writePos && entries[first].offset < writePos + needed) {
+        dropOldest();
+    }
+    if (count == entries.size()) dropOldest();
+
+    std::copy(line.begin(), line.end(), bytes.begin() + writePos);
+    bytes[writePos + line.size()] = '\n';
+    entries[(first + count) % entries.size()] = {(uint32_t)writePos, (uint32_t)line.size()};
+    count++;
+    writePos += needed;
+}
+
+void OutputConsole::clear() {
+    first = count = writePos = 0;
+    dropped = 0;
+}
+
+std::string_view OutputConsole::line(size_t i) const {
+    const Entry& entry = entries[(first + i) % entries.size()];
+    return std::string_view(bytes.data() + entry.offset, entry.length);
+}
+
+size_t OutputConsole::memoryUsage() const {
+    return bytes.size() + entries.size() * sizeof(Entry);
+}
@@ -0,0 +1,47 @@
+#ifndef CONSOLE_HPP
+#define CONSOLE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// Fixed-capacity store for compiler and program output. Lines are copied
+// into one preallocated byte ring, so memory stays flat no matter how much a
+// program prints: once either the line cap or the byte cap is reached the
+// oldest lines are dropped and counted.
+class OutputConsole {
+public:
+    OutputConsole(size_t maxLines, size_t maxBytes);
+
+    void append(std::string_view line);
+    void clear();
+
+    // Line i counts from the oldest line still held
+    std::string_view line(size_t i) const;
+    size_t size() const { return count; }
+
+    // Lines lost to the caps since the last clear(), including ones that
+    // were dropped before they ever reached the console
+    uint64_t droppedLines() const { return dropped; }
+    void addDropped(uint64_t lines) { dropped += lines; }
+
+    size_t memoryUsage() const;
+
+private:
+    struct Entry {
+        uint32_t offset;
+        uint32_t length;
+    };
+
+    void dropOldest();
+
+    std::vector<char> bytes;
+    std::vector<Entry> entries;   // Ring of lines, oldest at first
+    size_t first = 0;
+    size_t count = 0;
+    size_t writePos = 0;          // Where the next line goes in bytes
+    uint64_t dropped = 0;
+};
+
+#endif // CONSOLE_HPP
@@ -0,0 +1,470 @@
+#include "diagnostics.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+// --------- Text Format ---------
+struct DiagnosticKind {
+    const char* marker;
+    Severity severity;
+};
+
+// "fatal error" comes first so it is not read as a plain "error"
+static const DiagnosticKind KINDS[] = {
+    {": fatal error: ", Severity::Error},
+    {": error: ", Severity::Error},
+    {": warning: ", Severity::Warning},
+    {": note: ", Severity::Note},
+};
+
+static const char* severityName(Severity severity) {
+    switch (severity) {
+    case Severity::Error:   return "error";
+    case Severity::Warning: return "warning";
+    case Severity::Note:    return "note";
+    default:                return "";
+    }
+}
+
+// The earliest kind marker in line, or nullptr
+static const DiagnosticKind* findKind(std::string_view line, size_t& position) {
+    const DiagnosticKind* found = nullptr;
+    position = std::string_view::npos;
+    for (const DiagnosticKind& kind : KINDS) {
+        size_t at = line.find(kind.marker);
+        if (at < position) {
+            position = at;
+            found = &kind;
+        }
+    }
+    return found;
+}
+
+// GCC's source excerpts: "   12 | int x = y;" and "      |         ^"
+static bool isExcerptLine(std::string_view line) {
+    size_t i = 0;
+    while (i < line.size() && line[i] == ' ') i++;
+    while (i < line.size() && line[i] >= '0' && line[i] <= '9') i++;
+    while (i < line.size() && line[i] == ' ') i++;
+    return i < line.size() && line[i] == '|';
+}
+
+static bool allDigits(std::string_view text) {
+    if (text.empty()) return false;
+    for (char c : text) {
+        if (c < '0' || c > '9') return false;
+    }
+    return true;
+}
+
+std::string formatDiagnostic(const Diagnostic& diagnostic) {
+    std::string text(2 * diagnostic.depth, ' ');
+    if (diagnostic.severity == Severity::None) return text + diagnostic.message;
+
+    if (!diagnostic.file.empty()) {
+        text += diagnostic.file;
+        if (diagnostic.line > 0) {
+            text += ":" + std::to_string(diagnostic.line);
+            if (diagnostic.column > 0) text += ":" + std::to_string(diagnostic.column);
+        }
+        text += ": ";
+    }
+    text += severityName(diagnostic.severity);
+    text += ": ";
+    text += diagnostic.message;
+    return text;
+}
+
+Diagnostic parseDiagnosticLine(std::string_view line) {
+    Diagnostic diagnostic;
+    size_t indent = std::min(line.find_first_not_of(' '), line.size());
+    std::string_view body = line.substr(indent);
+    diagnostic.depth = (int)indent / 2;
+
+    size_t position;
+    const DiagnosticKind* kind = findKind(body, position);
+    if (!kind) {
+        diagnostic.message = std::string(body);
+        return diagnostic;
+    }
+    diagnostic.severity = kind->severity;
+    diagnostic.message = std::string(body.substr(position + std::strlen(kind->marker)));
+
+    // Up to two trailing ":number" fields are the line and column; splitting
+    // from the right keeps Windows drive letters in the file name
+    std::string_view location = body.substr(0, position);
+    int numbers[2] = {0, 0};
+    int found = 0;
+    while (found < 2) {
+        size_t colon = location.rfind(':');
+        if (colon == std::string_view::npos || !allDigits(location.substr(colon + 1))) break;
+        numbers[found++] = std::atoi(std::string(location.substr(colon + 1)).c_str());
+        location = location.substr(0, colon);
+    }
+    if (found == 2) {
+        diagnostic.line = numbers[1];
+        diagnostic.column = numbers[0];
+    } else if (found == 1) {
+        diagnostic.line = numbers[0];
+    }
+    diagnostic.file = std::string(location);
+    return diagnostic;
+}
+
+Severity severityOfLine(std::string_view line) {
+    size_t position;
+    const DiagnosticKind* kind = findKind(line, position);
+    return kind ? kind->severity : Severity::None;
+}
+
+// --------- JSON Reading ---------
+namespace {
+
+// Just enough JSON for one diagnostic object
+struct JsonValue {
+    enum Kind { Null, Bool, Number, String, Array, Object };
+
+    Kind kind = Null;
+    double number = 0.0;
+    std::string text;
+    std::vector<JsonValue> items;
+    std::vector<std::pair<std::string, JsonValue>> members;
+
+    const JsonValue* get(std::string_view key) const {
+        for (const auto& member : members) {
+            if (member.first == key) return &member.second;
+        }
+        return nullptr;
+    }
+    std::string getString(std::string_view key) const {
+        const JsonValue* value = get(key);
+        return value && value->kind == String ? value->text : std::string();
+    }
+    int getInt(std::string_view key) const {
+        const JsonValue* value = get(key);
+        return value && value->kind == Number ? (int)value->number : 0;
+    }
+};
+
+const int MAX_JSON_NESTING = 64;
+
+class JsonReader {
+public:
+    explicit JsonReader(std::string_view text) : text(text) {}
+
+    bool read(JsonValue& out) { return value(out, 0); }
+
+private:
+    void skipSpace() {
+        while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\n' || text[pos] == '\r' || text[pos] == '\t')) pos++;
+    }
+
+    bool literal(const char* word) {
+        size_t length = std::strlen(word);
+        if (text.compare(pos, length, word) != 0) return false;
+        pos += length;
+        return true;
+    }
+
+    static void appendUtf8(std::string& out, unsigned codepoint) {
+        if (codepoint < 0x80) {
+            out += (char)codepoint;
+        } else if (codepoint < 0x800) {
+            out += (char)(0xC0 | (codepoint >> 6));
+            out += (char)(0x80 | (codepoint & 0x3F));
+        } else {
+            out += (char)(0xE0 | (codepoint >> 12));
+            out += (char)(0x80 | ((codepoint >> 6) & 0x3F));
+            out += (char)(0x80 | (codepoint & 0x3F));
+        }
+    }
+
+    bool string(std::string& out) {
+        pos++;  // Opening quote
+        while (pos < text.size()) {
+            char c = text[pos++];
+            if (c == '"') return true;
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (pos >= text.size()) return false;
+            char escape = text[pos++];
+            switch (escape) {
+            case 'n': out += '\n'; break;
+            case 't': out += '\t'; break;
+            case 'r': out += '\r'; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'u': {
+                if (pos + 4 > text.size()) return false;
+                unsigned codepoint = (unsigned)std::strtoul(std::string(text.substr(pos, 4)).c_str(), nullptr, 16);
+                pos += 4;
+                appendUtf8(out, codepoint);
+                break;
+            }
+            default: out += escape; break;  // \" \\ \/
+            }
+        }
+        return false;
+    }
+
+    bool value(JsonValue& out, int nesting) {
+        if (nesting > MAX_JSON_NESTING) return false;
+        skipSpace();
+        if (pos >= text.size()) return false;
+        char c = text[pos];
+
+        if (c == '"') {
+            out.kind = JsonValue::String;
+            return string(out.text);
+        }
+        if (c == '{') {
+            out.kind = JsonValue::Object;
+            pos++;
+            skipSpace();
+            if (pos < text.size() && text[pos] == '}') {
+                pos++;
+                return true;
+            }
+            while (true) {
+                skipSpace();
+                if (pos >= text.size() || text[pos] != '"') return false;
+                std::string key;
+                if (!string(key)) return false;
+                skipSpace();
+                if (pos >= text.size() || text[pos++] != ':') return false;
+                out.members.emplace_back(std::move(key), JsonValue());
+                if (!value(out.members.back().second, nesting + 1)) return false;
+                skipSpace();
+                if (pos >= text.size()) return false;
+                if (text[pos] == ',') {
+                    pos++;
+                } else if (text[pos] == '}') {
+                    pos++;
+                    return true;
+                } else {
+                    return false;
+                }
+            }
+        }
+        if (c == '[') {
+            out.kind = JsonValue::Array;
+            pos++;
+            skipSpace();
+            if (pos < text.size() && text[pos] == ']') {
+                pos++;
+                return true;
+            }
+            while (true) {
+                out.items.emplace_back();
+                if (!value(out.items.back(), nesting + 1)) return false;
+                skipSpace();
+                if (pos >= text.size()) return false;
+                if (text[pos] == ',') {
+                    pos++;
+                } else if (text[pos] == ']') {
+                    pos++;
+                    return true;
+                } else {
+                    return false;
+                }
+            }
+        }
+        if (literal("true") || literal("false")) {
+            out.kind = JsonValue::Bool;
+            return true;
+        }
+        if (literal("null")) return true;
+
+        char* end = nullptr;
+        std::string number(text.substr(pos, std::min<size_t>(32, text.size() - pos)));
+        out.number = std::strtod(number.c_str(), &end);
+        if (end == number.c_str()) return false;
+        out.kind = JsonValue::Number;
+        pos += end - number.c_str();
+        return true;
+    }
+
+    std::string_view text;
+    size_t pos = 0;
+};
+
+Severity severityOfKind(const std::string& kind) {
+    if (kind.find("error") != std::string::npos || kind == "sorry" || kind == "ice") return Severity::Error;
+    if (kind.find("warning") != std::string::npos) return Severity::Warning;
+    return Severity::Note;
+}
+
+// Reports a diagnostic object and then, one level deeper, its children
+void emitDiagnostic(const JsonValue& object, int depth, const DiagnosticParser::Handler& handler) {
+    Diagnostic diagnostic;
+    diagnostic.severity = severityOfKind(object.getString("kind"));
+    diagnostic.message = object.getString("message");
+    diagnostic.option = object.getString("option");
+    diagnostic.depth = depth;
+
+    const JsonValue* locations = object.get("locations");
+    if (locations && locations->kind == JsonValue::Array && !locations->items.empty()) {
+        const JsonValue* caret = locations->items.front().get("caret");
+        if (caret) {
+            diagnostic.file = caret->getString("file");
+            diagnostic.line = caret->getInt("line");
+            // GCC 11 and later also give the column in bytes, which is what
+            // the editor counts; "column" expands tabs
+            diagnostic.column = caret->get("byte-column") ? caret->getInt("byte-column") : caret->getInt("column");
+        }
+    }
+    handler(diagnostic);
+
+    const JsonValue* children = object.get("children");
+    if (children && children->kind == JsonValue::Array) {
+        for (const JsonValue& child : children->items) emitDiagnostic(child, depth + 1, handler);
+    }
+}
+
+} // namespace
+
+// --------- Streaming Parser ---------
+DiagnosticParser::DiagnosticParser(Handler handler) : handler(std::move(handler)) {}
+
+const size_t MAX_JSON_ELEMENT_LINES = 1000;
+
+// GCC's JSON output opens with "[{", or is "[]" when there is nothing to
+// report; a text line that merely starts with '[' is not taken for it
+static bool startsJsonArray(std::string_view line) {
+    size_t next = line.find_first_not_of(" \t", 1);
+    return !line.empty() && line[0] == '[' && next != std::string_view::npos && (line[next] == '{' || line[next] == ']');
+}
+
+void DiagnosticParser::feedLine(std::string_view line) {
+    size_t start = line.find_first_not_of(" \t");
+    if (depth > 0 || (start != std::string_view::npos && startsJsonArray(line.substr(start)))) {
+        jsonLines.emplace_back(line);
+        feedJson(line);
+        feedJson("\n");
+        // GCC writes the whole array on one line, so an element still open
+        // after this many is a stray '[{' in text output
+        if (depth > 1 && jsonLines.size() >= MAX_JSON_ELEMENT_LINES) abandonJson();
+        if (jsonFailed) {
+            // Not JSON after all: the lines since the last whole element are text
+            jsonFailed = false;
+            std::vector<std::string> lines = std::move(jsonLines);
+            jsonLines.clear();
+            for (const std::string& text : lines) feedText(text);
+        } else if (depth <= 1) {
+            jsonLines.clear();   // Everything so far was parsed
+        }
+        return;
+    }
+    feedText(line);
+}
+
+void DiagnosticParser::feedText(std::string_view line) {
+    if (line.find_first_not_of(" \t") == std::string_view::npos || isExcerptLine(line)) return;
+    handler(parseDiagnosticLine(line));
+}
+
+// Tracks nesting and string state byte by byte; a top-level object is only
+// parsed once its closing brace has been seen. An object that does not parse
+// ends JSON mode.
+void DiagnosticParser::feedJson(std::string_view text) {
+    for (char c : text) {
+        if (depth == 0) {
+            if (c == '[') depth = 1;
+            continue;
+        }
+        if (depth == 1) {
+            if (c == '{') {
+                element.assign(1, c);
+                depth = 2;
+            } else if (c == ']') {
+                depth = 0;
+            }
+            continue;
+        }
+
+        element += c;
+        if (inString) {
+            if (escaped) {
+                escaped = false;
+            } else if (c == '\\') {
+                escaped = true;
+            } else if (c == '"') {
+                inString = false;
+            }
+        } else if (c == '"') {
+            inString = true;
+        } else if (c == '{' || c == '[') {
+            depth++;
+        } else if ((c == '}' || c == ']') && --depth == 1) {
+            bool parsed = parseElement();
+            element.clear();
+            if (!parsed) {
+                abandonJson();
+                return;
+            }
+        }
+    }
+}
+
+void DiagnosticParser::abandonJson() {
+    element.clear();
+    depth = 0;
+    inString = escaped = false;
+    jsonFailed = true;
+}
+
+bool DiagnosticParser::parseElement() {
+    JsonValue object;
+    if (!JsonReader(element).read(object) || object.kind != JsonValue::Object) return false;
+    emitDiagnostic(object, 0, handler);
+    return true;
+}
+
+// --------- Index ---------
+void DiagnosticIndex::clear() {
+    items.clear();
+    worst.clear();
+    navigable.clear();
+    errors = warnings = 0;
+}
+
+void DiagnosticIndex::add(const Diagnostic& diagnostic, bool inEditor) {
+    uint32_t index = (uint32_t)items.size();
+    items.push_back(diagnostic);
+    if (diagnostic.depth == 0 && diagnostic.severity == Severity::Error) errors++;
+    if (diagnostic.depth == 0 && diagnostic.severity == Severity::Warning) warnings++;
+    if (!inEditor || diagnostic.line <= 0 || diagnostic.severity == Severity::None) return;
+
+    size_t line = (size_t)diagnostic.line - 1;
+    if (line >= worst.size()) worst.resize(line + 1, -1);
+    if (worst[line] < 0 || items[worst[line]].severity < diagnostic.severity) worst[line] = (int32_t)index;
+
+    // Kept sorted by position; compilers report mostly in order, so this
+    // is usually an append
+    if (diagnostic.depth == 0 && diagnostic.severity >= Severity::Warning) {
+        auto before = [this](uint32_t a, uint32_t b) {
+            const Diagnostic& x = items[a];
+            const Diagnostic& y = items[b];
+            return x.line != y.line ? x.line < y.line : x.column < y.column;
+        };
+        navigable.insert(std::upper_bound(navigable.begin(), navigable.end(), index, before), index);
+    }
+}
+
+const Diagnostic* DiagnosticIndex::next(size_t line, size_t column, bool forward) const {
+    if (navigable.empty()) return nullptr;
+    // Positions compared 1-based, as the compiler reports them
+    auto position = [this](uint32_t i) { return std::make_pair((size_t)items[i].line, (size_t)items[i].column); };
+    std::pair<size_t, size_t> here(line + 1, column + 1);
+
+    if (forward) {
+        auto it = std::upper_bound(navigable.begin(), navigable.end(), here,
+                                   [&](const std::pair<size_t, size_t>& p, uint32_t i) { return p < position(i); });
+        return &items[it == navigable.end() ? navigable.front() : *it];
+    }
+    auto it = std::lower_bound(navigable.begin(), navigable.end(), here,
+                               [&](uint32_t i, const std::pair<size_t, size_t>& p) { return position(i) < p; });
+    return &items[it == navigable.begin() ? navigable.back() : *(it - 1)];
+}
@@ -0,0 +1,103 @@
+#ifndef DIAGNOSTICS_HPP
+#define DIAGNOSTICS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Ordered from least to most severe
+enum class Severity : uint8_t {
+    None,      // Compiler output that is not a diagnostic, such as linker messages
+    Note,
+    Warning,
+    Error
+};
+
+struct Diagnostic {
+    Severity severity = Severity::None;
+    std::string file;
+    int line = 0;            // 1-based; 0 when the diagnostic has no location
+    int column = 0;
+    std::string message;
+    std::string option;      // The flag behind a warning, such as -Wunused-variable
+    int depth = 0;           // 0 for a diagnostic, 1 and up for the notes under it
+};
+
+// One console line per diagnostic: "file:line:col: kind: message", with
+// notes indented under their diagnostic
+std::string formatDiagnostic(const Diagnostic& diagnostic);
+
+// Reads a line in GCC's text format (or formatDiagnostic's) back. Lines that
+// are not diagnostics come back with Severity::None and the line as message.
+Diagnostic parseDiagnosticLine(std::string_view line);
+
+// Severity of a console line, without building a Diagnostic
+Severity severityOfLine(std::string_view line);
+
+// Turns compiler output into diagnostics as it arrives. Output from
+// -fdiagnostics-format=json is parsed incrementally: each diagnostic, and
+// then its notes, is reported as soon as its closing brace has been read,
+// and only that one diagnostic is buffered. Other lines (a compiler without
+// JSON support, linker errors) are parsed as text, and the source excerpts
+// and caret lines of the text format are skipped.
+class DiagnosticParser {
+public:
+    using Handler = std::function<void(const Diagnostic&)>;
+
+    explicit DiagnosticParser(Handler handler);
+
+    // One line of compiler output, without its newline
+    void feedLine(std::string_view line);
+
+    // JSON text in pieces of any size
+    void feedJson(std::string_view text);
+
+private:
+    void feedText(std::string_view line);
+    void abandonJson();   // Leaves JSON mode and sets jsonFailed
+    bool parseElement();
+
+    Handler handler;
+    std::string element;     // The top-level JSON object being read
+    int depth = 0;           // 0 outside the JSON array, 1 inside it
+    bool inString = false;
+    bool escaped = false;
+    bool jsonFailed = false;              // An element did not parse; feedLine falls back to text
+    std::vector<std::string> jsonLines;   // Lines fed since the last element that parsed
+};
+
+// Diagnostics of the last build. Those in the editor's file are also indexed
+// by line, so the gutter looks up each visible line in O(1) however many
+// diagnostics a template error produced.
+class DiagnosticIndex {
+public:
+    void clear();
+    void add(const Diagnostic& diagnostic, bool inEditor);
+
+    size_t size() const { return items.size(); }
+    size_t errorCount() const { return errors; }
+    size_t warningCount() const { return warnings; }
+
+    // Worst severity on a 0-based editor line, and the diagnostic behind it
+    Severity lineSeverity(size_t line) const {
+        return line < worst.size() && worst[line] >= 0 ? items[worst[line]].severity : Severity::None;
+    }
+    const Diagnostic* lineDiagnostic(size_t line) const {
+        return line < worst.size() && worst[line] >= 0 ? &items[worst[line]] : nullptr;
+    }
+
+    // The first error or warning after (line, column), or with forward false
+    // the last one before it, wrapping around; 0-based positions
+    const Diagnostic* next(size_t line, size_t column, bool forward) const;
+
+private:
+    std::vector<Diagnostic> items;
+    std::vector<int32_t> worst;        // By editor line; index into items or -1
+    std::vector<uint32_t> navigable;   // Top-level errors and warnings in the editor, by position
+    size_t errors = 0, warnings = 0;
+};
+
+#endif // DIAGNOSTICS_HPP
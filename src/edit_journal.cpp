@@ -0,0 +1,295 @@
+#include "edit_journal.hpp"
+#include "file_saver.hpp"
+#include "trace.hpp"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+// The snapshot starts with one text line naming its generation and whether
+// the document follows or lives in a source file; the log starts with
+// LOG_MAGIC and the generation of the snapshot it applies to
+static const char* SNAPSHOT_FILE = "snapshot";
+static const char* LOG_FILE = "edits.log";
+static const std::string LOG_MAGIC = "IDEJ";
+
+// --------- Encoding ---------
+static void putVarint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out += (char)(value | 0x80);
+        value >>= 7;
+    }
+    out += (char)value;
+}
+
+static bool getVarint(std::string_view in, size_t& at, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && at < in.size(); shift += 7) {
+        uint8_t byte = (uint8_t)in[at++];
+        value |= (uint64_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+// FNV-1a, enough to tell a torn or garbled batch from a whole one
+static uint32_t checksum(std::string_view data) {
+    uint32_t hash = 2166136261u;
+    for (char c : data) {
+        hash ^= (uint8_t)c;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static long long modificationTime(const std::string& path) {
+    std::error_code ec;
+    auto time = fs::last_write_time(path, ec);
+    return ec ? 0 : (long long)time.time_since_epoch().count();
+}
+
+// --------- Journal ---------
+EditJournal::EditJournal(std::string directory, int flushIntervalMs)
+    : directory(std::move(directory)), flushIntervalMs(flushIntervalMs) {
+    // Distinct from any generation an earlier session left behind
+    generation = (uint64_t)std::chrono::system_clock::now().time_since_epoch().count();
+    worker = std::thread([this] { run(); });
+}
+
+EditJournal::~EditJournal() {
+    stop();
+}
+
+void EditJournal::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    if (worker.joinable()) worker.join();
+    if (log) {
+        std::fclose(log);
+        log = nullptr;
+    }
+}
+
+void EditJournal::checkpoint(TextSnapshot snapshot, const std::string& sourceFile) {
+    // Edits not yet written are part of the snapshot, so they are dropped
+    std::lock_guard<std::mutex> lock(mutex);
+    pending.clear();
+    pendingCheckpoint = {std::move(snapshot), sourceFile, ++generation};
+    checkpointRequested = true;
+    lastEnd = 0;
+    logged = 0;
+    source = sourceFile;
+    wake.notify_one();
+}
+
+void EditJournal::record(size_t offset, size_t erased, std::string_view inserted) {
+    // Offsets are zigzag-encoded distances from the previous edit, which is
+    // one byte while typing in one place
+    int64_t delta = (int64_t)offset - (int64_t)lastEnd;
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t before = pending.size();
+    putVarint(pending, ((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63));
+    putVarint(pending, erased);
+    putVarint(pending, inserted.size());
+    pending.append(inserted);
+    logged += pending.size() - before;
+    lastEnd = offset + inserted.size();
+}
+
+void EditJournal::finish() {
+    stop();
+    std::error_code ec;
+    fs::remove(fs::path(directory) / LOG_FILE, ec);
+    fs::remove(fs::path(directory) / SNAPSHOT_FILE, ec);
+}
+
+void EditJournal::run() {
+    traceThreadName("journal");
+    std::string records;
+    std::string held;            // Edits made since a checkpoint that has not reached the disk
+    Checkpoint checkpoint;
+    bool unwritten = false;
+    bool reported = false;       // Its failure was already logged
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait_for(lock, std::chrono::milliseconds(flushIntervalMs),
+                      [this] { return stopping || checkpointRequested; });
+        if (checkpointRequested) {
+            checkpoint = std::move(pendingCheckpoint);
+            unwritten = true;
+            reported = false;
+            held.clear();
+        }
+        checkpointRequested = false;
+        records.swap(pending);
+        bool last = stopping;
+        lock.unlock();
+
+        // The records belong to the new snapshot, so until it is written they
+        // are held back; a failed checkpoint is tried again next time round
+        if (unwritten) {
+            held += records;
+            records.clear();
+            std::string error;
+            if (writeCheckpoint(checkpoint, error)) {
+                unwritten = false;
+                checkpoint = Checkpoint();   // Lets go of the snapshot's pieces
+                records.swap(held);
+            } else if (!reported) {
+                std::cerr << "Journal: " << error << std::endl;
+                reported = true;
+            }
+        }
+        if (!records.empty()) writeBatch(records);
+        records.clear();
+
+        lock.lock();
+        if (last && pending.empty() && !checkpointRequested) break;
+    }
+}
+
+// Never leaves the log open on failure: edits encoded against the new
+// snapshot must not be appended to a log that names the old one
+bool EditJournal::writeCheckpoint(const Checkpoint& checkpoint, std::string& error) {
+    TRACE_SCOPE("journal checkpoint");
+    if (log) {
+        std::fclose(log);
+        log = nullptr;
+    }
+    std::error_code ec;
+    fs::create_directories(directory, ec);
+    std::string header = "IDE snapshot " + std::to_string(checkpoint.generation);
+    if (checkpoint.sourceFile.empty()) {
+        header += " text\n";
+    } else {
+        header += " file " + std::to_string(checkpoint.snapshot.length()) + " " +
+                  std::to_string(modificationTime(checkpoint.sourceFile)) + " " + checkpoint.sourceFile + "\n";
+    }
+    std::vector<std::string_view> runs = {header};
+    if (checkpoint.sourceFile.empty()) {
+        runs.insert(runs.end(), checkpoint.snapshot.runs().begin(), checkpoint.snapshot.runs().end());
+    }
+    if (!writeFileAtomically((fs::path(directory) / SNAPSHOT_FILE).string(), runs, error)) return false;
+
+    // Only once the snapshot is in place is the old log emptied; a crash in
+    // between leaves a log whose generation no longer matches, which is ignored
+    log = std::fopen((fs::path(directory) / LOG_FILE).string().c_str(), "wb");
+    if (!log) {
+        error = std::string("could not create ") + LOG_FILE;
+        return false;
+    }
+    std::string start = LOG_MAGIC;
+    putVarint(start, checkpoint.generation);
+    std::fwrite(start.data(), 1, start.size(), log);
+    std::fflush(log);
+    return true;
+}
+
+void EditJournal::writeBatch(const std::string& records) {
+    if (!log) return;
+    TRACE_SCOPE("journal flush");
+    std::string frame;
+    putVarint(frame, records.size());
+    uint32_t sum = checksum(records);
+    std::fwrite(frame.data(), 1, frame.size(), log);
+    std::fwrite(records.data(), 1, records.size(), log);
+    char tail[4] = {(char)sum, (char)(sum >> 8), (char)(sum >> 16), (char)(sum >> 24)};
+    std::fwrite(tail, 1, sizeof(tail), log);
+    std::fflush(log);
+}
+
+// --------- Recovery ---------
+static bool readFile(const fs::path& path, std::string& out) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+    std::stringstream contents;
+    contents << file.rdbuf();
+    out = contents.str();
+    return true;
+}
+
+bool EditJournal::recover(const std::string& directory, JournalRecovery& recovery, std::string& error) {
+    TRACE_SCOPE("journal recover");
+    error.clear();
+    recovery = JournalRecovery();
+    std::string snapshot;
+    if (!readFile(fs::path(directory) / SNAPSHOT_FILE, snapshot)) return false;
+
+    size_t newline = snapshot.find('\n');
+    std::istringstream header(snapshot.substr(0, newline == std::string::npos ? 0 : newline));
+    std::string ide, word, kind;
+    uint64_t generation = 0;
+    if (!(header >> ide >> word >> generation >> kind) || ide != "IDE" || word != "snapshot") {
+        error = "the journal snapshot is damaged";
+        return false;
+    }
+    if (kind == "text") {
+        recovery.text = snapshot.substr(newline + 1);
+    } else {
+        size_t size = 0;
+        long long modified = 0;
+        std::string path;
+        header >> size >> modified;
+        std::getline(header >> std::ws, path);
+        if (!readFile(path, recovery.text) || recovery.text.size() != size || modificationTime(path) != modified) {
+            error = path + " changed since the journal was started";
+            return false;
+        }
+    }
+    snapshot = std::string();
+
+    // Whole batches are replayed in order; anything after the first one that
+    // is cut short or fails its checksum was never completely written
+    std::string log;
+    if (!readFile(fs::path(directory) / LOG_FILE, log)) return true;
+    size_t at = LOG_MAGIC.size();
+    uint64_t logGeneration = 0;
+    if (log.compare(0, LOG_MAGIC.size(), LOG_MAGIC) != 0 || !getVarint(log, at, logGeneration) ||
+        logGeneration != generation) {
+        return true;
+    }
+    std::string& text = recovery.text;
+    size_t lastEnd = 0;
+    while (at < log.size()) {
+        uint64_t length = 0;
+        if (!getVarint(log, at, length) || length + 4 > log.size() - at) {
+            recovery.truncated = true;
+            break;
+        }
+        std::string_view batch(log.data() + at, length);
+        const uint8_t* tail = (const uint8_t*)log.data() + at + length;
+        uint32_t stored = tail[0] | tail[1] << 8 | tail[2] << 16 | (uint32_t)tail[3] << 24;
+        if (checksum(batch) != stored) {
+            recovery.truncated = true;
+            break;
+        }
+        at += length + 4;
+
+        size_t in = 0;
+        while (in < batch.size()) {
+            uint64_t zigzag, erased, inserted;
+            if (!getVarint(batch, in, zigzag) || !getVarint(batch, in, erased) || !getVarint(batch, in, inserted) ||
+                inserted > batch.size() - in) {
+                recovery.truncated = true;
+                return true;
+            }
+            int64_t delta = (int64_t)(zigzag >> 1) ^ -(int64_t)(zigzag & 1);
+            int64_t offset = (int64_t)lastEnd + delta;
+            if (offset < 0 || (uint64_t)offset > text.size() || erased > text.size() - offset) {
+                recovery.truncated = true;
+                return true;
+            }
+            text.replace((size_t)offset, erased, batch.data() + in, inserted);
+            in += inserted;
+            lastEnd = (size_t)offset + inserted;
+            recovery.edits++;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,93 @@
+#ifndef EDIT_JOURNAL_HPP
+#define EDIT_JOURNAL_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include "text_buffer.hpp"
+
+// What a journal left behind by an earlier session held
+struct JournalRecovery {
+    std::string text;          // The document as of the last edit that reached the disk
+    size_t edits = 0;          // Edits replayed on top of the snapshot
+    bool truncated = false;    // The log ended in a damaged or partly written batch, which was dropped
+};
+
+// Write-ahead log of document edits, for getting the text back after a
+// crash without rewriting the file on every change.
+//
+// The directory holds a snapshot of the document and a log of the edits made
+// since. record() only encodes an edit into memory, a few bytes for a
+// keystroke: the distance from the end of the previous edit, the bytes
+// removed and the bytes inserted, as varints. A worker thread appends what
+// has gathered every flushIntervalMs as one checksummed batch, so a crash
+// loses at most that much typing. checkpoint() starts over from a new
+// snapshot, which the worker writes before it empties the log; edits made
+// meanwhile wait in memory until the snapshot is on the disk.
+class EditJournal {
+public:
+    EditJournal(std::string directory, int flushIntervalMs);
+    EditJournal(const EditJournal&) = delete;
+    EditJournal& operator=(const EditJournal&) = delete;
+
+    // Flushes pending edits and keeps the files, so an exit without
+    // finish() is recovered like a crash
+    ~EditJournal();
+
+    // Replays the journal in directory, if a session left one. Returns false
+    // when there is nothing to recover; error then says why, and is empty if
+    // there simply was no journal.
+    static bool recover(const std::string& directory, JournalRecovery& recovery, std::string& error);
+
+    // The document is now exactly snapshot. With sourceFile set the snapshot
+    // only refers to that file (its size and modification time), which must
+    // hold the same text; that keeps a checkpoint of a large mapped file cheap.
+    void checkpoint(TextSnapshot snapshot, const std::string& sourceFile = std::string());
+
+    // Bytes [offset, offset + erased) were replaced by inserted
+    void record(size_t offset, size_t erased, std::string_view inserted);
+
+    // Log bytes recorded since the last checkpoint, flushed or not
+    size_t loggedBytes() const { return logged; }
+    const std::string& sourceFile() const { return source; }
+
+    // The session ended cleanly: stops the worker and deletes the files
+    void finish();
+
+private:
+    struct Checkpoint {
+        TextSnapshot snapshot;
+        std::string sourceFile;
+        uint64_t generation = 0;
+    };
+
+    void run();
+    bool writeCheckpoint(const Checkpoint& checkpoint, std::string& error);
+    void writeBatch(const std::string& records);
+    void stop();
+
+    std::string directory;
+    int flushIntervalMs;
+
+    // Main thread only
+    uint64_t generation;     // Ties the log to the snapshot it applies to
+    size_t lastEnd = 0;      // Where the previous edit ended; offsets are stored relative to it
+    size_t logged = 0;
+    std::string source;
+
+    std::mutex mutex;        // Guards everything below
+    std::condition_variable wake;
+    std::string pending;     // Encoded records not yet handed to the worker
+    Checkpoint pendingCheckpoint;
+    bool checkpointRequested = false;
+    bool stopping = false;
+    FILE* log = nullptr;     // Worker thread only
+    std::thread worker;
+};
+
+#endif // EDIT_JOURNAL_HPP
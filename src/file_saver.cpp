@@ -0,0 +1,215 @@
+#include "file_saver.hpp"
+#include "trace.hpp"
+#include <chrono>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Small runs are gathered into one buffer so the file is written in a few
+// large calls rather than one per piece
+const size_t WRITE_BUFFER_BYTES = 1024 * 1024;
+
+#ifdef _WIN32
+
+// --------- Windows Implementation ---------
+static bool writeAll(HANDLE file, const char* data, size_t size) {
+    while (size > 0) {
+        DWORD chunk = size > (1u << 30) ? (1u << 30) : (DWORD)size;
+        DWORD written = 0;
+        if (!WriteFile(file, data, chunk, &written, nullptr)) return false;
+        data += written;
+        size -= written;
+    }
+    return true;
+}
+
+bool writeFileAtomically(const std::string& path, const std::vector<std::string_view>& runs, std::string& error) {
+    TRACE_SCOPE("writeFileAtomically");
+    std::string temp = path + ".saving";
+    HANDLE file = CreateFileA(temp.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        error = "Could not create " + temp;
+        return false;
+    }
+
+    std::string pendingBytes;
+    pendingBytes.reserve(WRITE_BUFFER_BYTES);
+    bool ok = true;
+    for (std::string_view run : runs) {
+        if (!ok) break;
+        if (pendingBytes.size() + run.size() > WRITE_BUFFER_BYTES) {
+            ok = writeAll(file, pendingBytes.data(), pendingBytes.size());
+            pendingBytes.clear();
+        }
+        if (run.size() >= WRITE_BUFFER_BYTES) {
+            ok = ok && writeAll(file, run.data(), run.size());
+        } else {
+            pendingBytes.append(run);
+        }
+    }
+    ok = ok && writeAll(file, pendingBytes.data(), pendingBytes.size());
+    ok = ok && FlushFileBuffers(file);
+    CloseHandle(file);
+
+    if (!ok || !MoveFileExA(temp.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+        DeleteFileA(temp.c_str());
+        error = ok ? "Could not replace " + path : "Could not write " + temp;
+        return false;
+    }
+    return true;
+}
+
+#else
+
+// --------- POSIX Implementation ---------
+static bool writeAll(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t written = ::write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += written;
+        size -= (size_t)written;
+    }
+    return true;
+}
+
+// Makes the rename itself durable
+static void syncDirectoryOf(const std::string& path) {
+    size_t slash = path.find_last_of('/');
+    std::string directory = slash == std::string::npos ? "." : (slash == 0 ? "/" : path.substr(0, slash));
+    int fd = ::open(directory.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd >= 0) {
+        fsync(fd);
+        ::close(fd);
+    }
+}
+
+bool writeFileAtomically(const std::string& path, const std::vector<std::string_view>& runs, std::string& error) {
+    TRACE_SCOPE("writeFileAtomically");
+    std::string temp = path + ".saving";
+
+    // Keep the permissions of the file being replaced
+    struct stat existing;
+    bool hadFile = stat(path.c_str(), &existing) == 0;
+    int fd = ::open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+    if (fd < 0) {
+        error = "Could not create " + temp + ": " + std::strerror(errno);
+        return false;
+    }
+    if (hadFile) fchmod(fd, existing.st_mode & 07777);
+
+    std::string pendingBytes;
+    pendingBytes.reserve(WRITE_BUFFER_BYTES);
+    bool ok = true;
+    for (std::string_view run : runs) {
+        if (!ok) break;
+        if (pendingBytes.size() + run.size() > WRITE_BUFFER_BYTES) {
+            ok = writeAll(fd, pendingBytes.data(), pendingBytes.size());
+            pendingBytes.clear();
+        }
+        if (run.size() >= WRITE_BUFFER_BYTES) {
+            ok = ok && writeAll(fd, run.data(), run.size());
+        } else {
+            pendingBytes.append(run);
+        }
+    }
+    ok = ok && writeAll(fd, pendingBytes.data(), pendingBytes.size());
+    ok = ok && fsync(fd) == 0;
+    int savedErrno = errno;
+    ok = (::close(fd) == 0) && ok;
+
+    if (!ok) {
+        error = "Could not write " + temp + ": " + std::strerror(savedErrno);
+        unlink(temp.c_str());
+        return false;
+    }
+    if (rename(temp.c_str(), path.c_str()) != 0) {
+        error = "Could not replace " + path + ": " + std::strerror(errno);
+        unlink(temp.c_str());
+        return false;
+    }
+    syncDirectoryOf(path);
+    return true;
+}
+
+#endif
+
+// --------- Save Queue ---------
+SaveQueue::SaveQueue(std::function<void()> notify) : notify(std::move(notify)) {
+    worker = std::thread([this]() { run(); });
+}
+
+SaveQueue::~SaveQueue() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    worker.join();  // Pending saves are still written first
+}
+
+void SaveQueue::save(const std::string& path, TextSnapshot snapshot) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        bool replaced = false;
+        for (Request& request : pending) {
+            if (request.path == path) {
+                request.snapshot = std::move(snapshot);
+                replaced = true;
+                break;
+            }
+        }
+        if (!replaced) pending.push_back({path, std::move(snapshot)});
+    }
+    wake.notify_one();
+}
+
+void SaveQueue::flush() {
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this]() { return pending.empty() && !writing; });
+}
+
+void SaveQueue::poll(std::vector<SaveResult>& results) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (SaveResult& result : finished) results.push_back(std::move(result));
+    finished.clear();
+}
+
+void SaveQueue::run() {
+    traceThreadName("save");
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [this]() { return stopping || !pending.empty(); });
+        if (pending.empty()) break;  // Stopping with nothing left to write
+
+        Request request = std::move(pending.front());
+        pending.pop_front();
+        writing = true;
+        lock.unlock();
+
+        SaveResult result;
+        result.path = request.path;
+        result.bytes = request.snapshot.length();
+        auto start = std::chrono::steady_clock::now();
+        result.ok = writeFileAtomically(request.path, request.snapshot.runs(), result.error);
+        result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        lock.lock();
+        writing = false;
+        finished.push_back(std::move(result));
+        if (pending.empty()) idle.notify_all();
+        lock.unlock();
+        if (notify) notify();
+        lock.lock();
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef FILE_SAVER_HPP
+#define FILE_SAVER_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "text_buffer.hpp"
+
+// Writes the runs to a temporary file next to path, flushes it to disk and
+// renames it over path. A crash at any point leaves either the old or the
+// new contents in place, never a truncated file.
+bool writeFileAtomically(const std::string& path, const std::vector<std::string_view>& runs, std::string& error);
+
+struct SaveResult {
+    std::string path;
+    bool ok = false;
+    std::string error;
+    size_t bytes = 0;
+    double seconds = 0.0;
+};
+
+// Saves document snapshots on a worker thread, in the order requested. A
+// save that has not started yet is replaced by a newer one for the same
+// path. Finished saves are reported through poll(); notify is called from
+// the worker whenever one is ready.
+class SaveQueue {
+public:
+    explicit SaveQueue(std::function<void()> notify);
+    SaveQueue(const SaveQueue&) = delete;
+    SaveQueue& operator=(const SaveQueue&) = delete;
+    ~SaveQueue();
+
+    void save(const std::string& path, TextSnapshot snapshot);
+
+    // Blocks until every requested save has been written
+    void flush();
+
+    // Main thread: moves finished saves into results
+    void poll(std::vector<SaveResult>& results);
+
+private:
+    struct Request {
+        std::string path;
+        TextSnapshot snapshot;
+    };
+
+    void run();
+
+    std::function<void()> notify;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable idle;
+    std::deque<Request> pending;
+    std::vector<SaveResult> finished;
+    bool writing = false;
+    bool stopping = false;
+    std::thread worker;
+};
+
+#endif // FILE_SAVER_HPP
@@ -0,0 +1,226 @@
+#include "glyph_atlas.hpp"
+#include <iostream>
+
+// Reads one UTF-8 sequence starting at text[i] and advances i past it.
+// Malformed bytes decode to '?' so a bad file still renders.
+Uint32 decodeUtf8(std::string_view text, size_t& i) {
+    unsigned char c = text[i++];
+    if (c < 0x80) return c;
+
+    int extra = (c >= 0xF0) ? 3 : (c >= 0xE0) ? 2 : (c >= 0xC0) ? 1 : -1;
+    if (extra < 0 || i + extra > text.size()) return '?';
+
+    Uint32 codepoint = c & (0x3F >> extra);
+    for (int k = 0; k < extra; k++) {
+        unsigned char next = text[i];
+        if ((next & 0xC0) != 0x80) return '?';
+        codepoint = (codepoint << 6) | (next & 0x3F);
+        i++;
+    }
+    return codepoint;
+}
+
+static int encodeUtf8(Uint32 codepoint, char* out) {
+    if (codepoint < 0x80) {
+        out[0] = (char)codepoint;
+        return 1;
+    } else if (codepoint < 0x800) {
+        out[0] = (char)(0xC0 | (codepoint >> 6));
+        out[1] = (char)(0x80 | (codepoint & 0x3F));
+        return 2;
+    }
+    out[0] = (char)(0xE0 | (codepoint >> 12));
+    out[1] = (char)(0x80 | ((codepoint >> 6) & 0x3F));
+    out[2] = (char)(0x80 | (codepoint & 0x3F));
+    return 3;
+}
+
+bool GlyphAtlas::init(SDL_Renderer* targetRenderer, TTF_Font* targetFont) {
+    renderer = targetRenderer;
+    font = targetFont;
+    lineSkip = TTF_FontLineSkip(font);
+    return addPage();
+}
+
+void GlyphAtlas::destroy() {
+    for (SDL_Texture* page : pages) {
+        SDL_DestroyTexture(page);
+    }
+    pages.clear();
+    glyphs.clear();
+    for (bool& loaded : asciiLoaded) loaded = false;
+    shelfX = shelfY = shelfHeight = 0;
+    batchPage = -1;
+}
+
+bool GlyphAtlas::addPage() {
+    SDL_Texture* page = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888,
+                                          SDL_TEXTUREACCESS_STATIC, PAGE_SIZE, PAGE_SIZE);
+    if (!page) {
+        std::cerr << "Failed to create glyph atlas page! SDL_Error: " << SDL_GetError() << std::endl;
+        return false;
+    }
+    std::vector<Uint32> clear(PAGE_SIZE * PAGE_SIZE, 0);
+    SDL_UpdateTexture(page, nullptr, clear.data(), PAGE_SIZE * 4);
+    uploads++;
+    SDL_SetTextureBlendMode(page, SDL_BLENDMODE_BLEND);
+
+    pages.push_back(page);
+    shelfX = shelfY = shelfHeight = 0;
+    return true;
+}
+
+// Shelf packing: glyphs fill a row left to right, a new row starts below the
+// tallest glyph of the previous one, and a full page opens a new page.
+bool GlyphAtlas::reserve(int w, int h, SDL_Rect& slot) {
+    if (w > PAGE_SIZE || h > PAGE_SIZE) return false;
+
+    if (shelfX + w > PAGE_SIZE) {
+        shelfY += shelfHeight + 1;
+        shelfX = 0;
+        shelfHeight = 0;
+    }
+    if (shelfY + h > PAGE_SIZE) {
+        if (!addPage()) return false;
+    }
+
+    slot = {shelfX, shelfY, w, h};
+    shelfX += w + 1;
+    if (h > shelfHeight) shelfHeight = h;
+    return true;
+}
+
+GlyphAtlas::Glyph GlyphAtlas::rasterize(Uint32 codepoint, int style) {
+    Glyph g;
+    if (codepoint > 0xFFFF) codepoint = '?';
+
+    int previousStyle = TTF_GetFontStyle(font);
+    if (previousStyle != style) TTF_SetFontStyle(font, style);
+
+    TTF_GlyphMetrics(font, (Uint16)codepoint, nullptr, nullptr, nullptr, nullptr, &g.advance);
+
+    char utf8[4] = {0};
+    encodeUtf8(codepoint, utf8);
+    SDL_Surface* surface = TTF_RenderUTF8_Blended(font, utf8, SDL_Color{255, 255, 255, 255});
+
+    if (previousStyle != style) TTF_SetFontStyle(font, previousStyle);
+    if (!surface) return g;
+
+    SDL_Surface* converted = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_ARGB8888, 0);
+    SDL_FreeSurface(surface);
+    if (!converted) return g;
+
+    SDL_Rect slot;
+    if (converted->w > 0 && reserve(converted->w, converted->h, slot)) {
+        g.page = (int)pages.size() - 1;
+        g.src = slot;
+        SDL_UpdateTexture(pages[g.page], &slot, converted->pixels, converted->pitch);
+        uploads++;
+    }
+    SDL_FreeSurface(converted);
+    return g;
+}
+
+const GlyphAtlas::Glyph& GlyphAtlas::glyph(Uint32 codepoint, int style) {
+    if (codepoint < 128 && style == TTF_STYLE_NORMAL) {
+        if (!asciiLoaded[codepoint]) {
+            ascii[codepoint] = rasterize(codepoint, style);
+            asciiLoaded[codepoint] = true;
+        }
+        return ascii[codepoint];
+    }
+
+    Uint64 key = ((Uint64)codepoint << 8) | (Uint64)(style & 0xFF);
+    auto it = glyphs.find(key);
+    if (it == glyphs.end()) {
+        it = glyphs.emplace(key, rasterize(codepoint, style)).first;
+    }
+    return it->second;
+}
+
+int GlyphAtlas::advance(Uint32 codepoint, int style) {
+    if (codepoint == '\t') return TAB_WIDTH * glyph(' ', style).advance;
+    return glyph(codepoint, style).advance;
+}
+
+int GlyphAtlas::textWidth(std::string_view text, int style) {
+    int width = 0;
+    for (size_t i = 0; i < text.size();) {
+        width += advance(decodeUtf8(text, i), style);
+    }
+    return width;
+}
+
+int GlyphAtlas::queueText(std::string_view text, int x, int y, SDL_Color color, int style) {
+    for (size_t i = 0; i < text.size();) {
+        Uint32 codepoint = decodeUtf8(text, i);
+        if (codepoint == '\t') {
+            x += advance(codepoint, style);
+            continue;
+        }
+        if (codepoint == '\n' || codepoint == '\r') continue;
+
+        const Glyph& g = glyph(codepoint, style);
+        if (g.page >= 0) {
+            if (batchPage != g.page) {
+                flush();
+                batchPage = g.page;
+            }
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+            const float inv = 1.0f / PAGE_SIZE;
+            float x0 = (float)x, y0 = (float)y;
+            float x1 = x0 + g.src.w, y1 = y0 + g.src.h;
+            float u0 = g.src.x * inv, v0 = g.src.y * inv;
+            float u1 = (g.src.x + g.src.w) * inv, v1 = (g.src.y + g.src.h) * inv;
+
+            int base = (int)vertices.size();
+            vertices.push_back({{x0, y0}, color, {u0, v0}});
+            vertices.push_back({{x1, y0}, color, {u1, v0}});
+            vertices.push_back({{x1, y1}, color, {u1, v1}});
+            vertices.push_back({{x0, y1}, color, {u0, v1}});
+            indices.insert(indices.end(), {base, base + 1, base + 2, base, base + 2, base + 3});
+#else
+            quads.push_back({g.src, {x, y, g.src.w, g.src.h}, color});
+#endif
+        }
+        x += g.advance;
+    }
+    return x;
+}
+
+int GlyphAtlas::drawText(std::string_view text, int x, int y, SDL_Color color, int style) {
+    int end = queueText(text, x, y, color, style);
+    flush();
+    return end;
+}
+
+void GlyphAtlas::flush() {
+    if (batchPage < 0) return;
+    SDL_Texture* page = pages[batchPage];
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+    if (!indices.empty()) {
+        SDL_RenderGeometry(renderer, page, vertices.data(), (int)vertices.size(),
+                           indices.data(), (int)indices.size());
+    }
+    vertices.clear();
+    indices.clear();
+#else
+    // Older SDL has no geometry API: fall back to one copy per glyph,
+    // changing the color modulation only when the color does.
+    SDL_Color current = {0, 0, 0, 0};
+    bool first = true;
+    for (const Quad& quad : quads) {
+        if (first || quad.color.r != current.r || quad.color.g != current.g ||
+            quad.color.b != current.b || quad.color.a != current.a) {
+            SDL_SetTextureColorMod(page, quad.color.r, quad.color.g, quad.color.b);
+            SDL_SetTextureAlphaMod(page, quad.color.a);
+            current = quad.color;
+            first = false;
+        }
+        SDL_RenderCopy(renderer, page, &quad.src, &quad.dst);
+    }
+    quads.clear();
+#endif
+    batchPage = -1;
+}
@@ -0,0 +1,74 @@
+#ifndef GLYPH_ATLAS_HPP
+#define GLYPH_ATLAS_HPP
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Decodes the UTF-8 sequence at text[i] and moves i past it
+Uint32 decodeUtf8(std::string_view text, size_t& i);
+
+// Glyph cache for all text drawing. Every (codepoint, style) pair is
+// rasterized once in white into a packed texture page; strings are then
+// drawn as batches of textured quads, tinted with the requested color.
+class GlyphAtlas {
+public:
+    bool init(SDL_Renderer* renderer, TTF_Font* font);
+    void destroy();
+
+    // Draws UTF-8 text with its top-left corner at (x, y) and returns the pen
+    // position after the last glyph.
+    int drawText(std::string_view text, int x, int y, SDL_Color color, int style = TTF_STYLE_NORMAL);
+
+    // Queues text without submitting it; call flush() once the batch is done.
+    int queueText(std::string_view text, int x, int y, SDL_Color color, int style = TTF_STYLE_NORMAL);
+    void flush();
+
+    int textWidth(std::string_view text, int style = TTF_STYLE_NORMAL);
+    int advance(Uint32 codepoint, int style = TTF_STYLE_NORMAL);
+    int lineHeight() const { return lineSkip; }
+
+    // Texture uploads since init: new pages and newly rasterized glyphs
+    uint64_t uploadCount() const { return uploads; }
+
+private:
+    static constexpr int PAGE_SIZE = 1024;
+    static constexpr int TAB_WIDTH = 4;
+
+    struct Glyph {
+        int page = -1;
+        SDL_Rect src = {0, 0, 0, 0};
+        int advance = 0;
+    };
+
+    const Glyph& glyph(Uint32 codepoint, int style);
+    Glyph rasterize(Uint32 codepoint, int style);
+    bool reserve(int w, int h, SDL_Rect& slot);
+    bool addPage();
+
+    SDL_Renderer* renderer = nullptr;
+    TTF_Font* font = nullptr;
+    int lineSkip = 0;
+    uint64_t uploads = 0;
+
+    std::vector<SDL_Texture*> pages;
+    int shelfX = 0, shelfY = 0, shelfHeight = 0;
+
+    Glyph ascii[128];
+    bool asciiLoaded[128] = {};
+    std::unordered_map<Uint64, Glyph> glyphs;
+
+    int batchPage = -1;
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+    std::vector<SDL_Vertex> vertices;
+    std::vector<int> indices;
+#else
+    struct Quad { SDL_Rect src, dst; SDL_Color color; };
+    std::vector<Quad> quads;
+#endif
+};
+
+#endif // GLYPH_ATLAS_HPP
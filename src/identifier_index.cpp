@@ -0,0 +1,256 @@
+#include "identifier_index.hpp"
+#include <algorithm>
+#include <chrono>
+
+// Suggested before they appear in the document
+static const char* const BUILTIN_NAMES[] = {
+    // Keywords
+    "alignas", "alignof", "asm", "auto", "bool", "break", "case", "catch", "char", "char16_t", "char32_t",
+    "char8_t", "class", "concept", "const", "consteval", "constexpr", "constinit", "const_cast", "continue",
+    "co_await", "co_return", "co_yield", "decltype", "default", "delete", "do", "double", "dynamic_cast", "else",
+    "enum", "explicit", "export", "extern", "false", "float", "for", "friend", "goto", "if", "inline", "int",
+    "long", "mutable", "namespace", "new", "noexcept", "nullptr", "operator", "override", "private", "protected",
+    "public", "register", "reinterpret_cast", "requires", "return", "short", "signed", "sizeof", "static",
+    "static_assert", "static_cast", "struct", "switch", "template", "this", "thread_local", "throw", "true", "try",
+    "typedef", "typeid", "typename", "union", "unsigned", "using", "virtual", "void", "volatile", "wchar_t",
+    "while", "final", "include", "define", "ifdef", "ifndef", "endif", "pragma",
+    // Standard library
+    "std", "size_t", "int8_t", "int16_t", "int32_t", "int64_t", "uint8_t", "uint16_t", "uint32_t", "uint64_t",
+    "string", "string_view", "wstring", "vector", "array", "deque", "list", "forward_list", "map", "multimap",
+    "set", "multiset", "unordered_map", "unordered_set", "stack", "queue", "priority_queue", "pair", "tuple",
+    "optional", "variant", "any", "bitset", "span", "function", "unique_ptr", "shared_ptr", "weak_ptr",
+    "make_unique", "make_shared", "make_pair", "make_tuple", "move", "forward", "swap", "exchange", "tie", "get",
+    "cout", "cin", "cerr", "clog", "endl", "getline", "ios", "iostream", "istream", "ostream", "fstream",
+    "ifstream", "ofstream", "stringstream", "istringstream", "ostringstream", "sort", "stable_sort",
+    "partial_sort", "nth_element", "lower_bound", "upper_bound", "equal_range", "binary_search", "find",
+    "find_if", "count", "count_if", "accumulate", "iota", "fill", "copy", "transform", "reverse", "unique",
+    "remove", "remove_if", "min", "max", "minmax", "min_element", "max_element", "clamp", "abs", "sqrt", "pow",
+    "floor", "ceil", "round", "begin", "end", "rbegin", "rend", "size", "empty", "push_back", "emplace_back",
+    "pop_back", "push", "pop", "top", "front", "back", "insert", "emplace", "erase", "clear", "reserve",
+    "resize", "substr", "to_string", "stoi", "stol", "stoll", "stod", "numeric_limits", "thread", "mutex",
+    "lock_guard", "unique_lock", "condition_variable", "atomic", "chrono", "steady_clock", "milliseconds",
+    "runtime_error", "exception", "invalid_argument", "out_of_range", "nullptr_t", "initializer_list",
+    "iterator", "const_iterator", "value_type", "size_type", "first", "second",
+};
+
+static inline bool isIdentifierStart(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+static inline bool isIdentifierChar(char c) {
+    return isIdentifierStart(c) || (c >= '0' && c <= '9');
+}
+
+IdentifierIndex::IdentifierIndex() {
+    reset(0, 0);
+}
+
+// --------- Trie ---------
+uint32_t IdentifierIndex::insertWord(std::string_view word) {
+    uint32_t node = 0;
+    for (char c : word) {
+        // Keep the sibling list in character order, which makes a depth-first
+        // walk visit words alphabetically
+        uint32_t previous = 0, next = nodes[node].child;
+        while (next && nodes[next].c < c) {
+            previous = next;
+            next = nodes[next].sibling;
+        }
+        if (next && nodes[next].c == c) {
+            node = next;
+            continue;
+        }
+        uint32_t created = (uint32_t)nodes.size();
+        Node child;
+        child.parent = node;
+        child.sibling = next;
+        child.c = c;
+        nodes.push_back(child);
+        if (previous) {
+            nodes[previous].sibling = created;
+        } else {
+            nodes[node].child = created;
+        }
+        node = created;
+    }
+    return node;
+}
+
+uint32_t IdentifierIndex::findNode(std::string_view word) const {
+    uint32_t node = 0;
+    for (char c : word) {
+        uint32_t next = nodes[node].child;
+        while (next && nodes[next].c < c) next = nodes[next].sibling;
+        if (!next || nodes[next].c != c) return 0;
+        node = next;
+    }
+    return node;
+}
+
+std::string IdentifierIndex::spell(uint32_t node, size_t length) const {
+    std::string word(length, '\0');
+    for (size_t i = length; i > 0; i--, node = nodes[node].parent) word[i - 1] = nodes[node].c;
+    return word;
+}
+
+// --------- Lines ---------
+// Identifiers outside // comments and string and character literals. Block
+// comments are not tracked across lines, so words inside them count too.
+void IdentifierIndex::addLine(LineEntry& entry, std::string_view line) {
+    size_t i = 0, n = line.size();
+    while (i < n) {
+        char c = line[i];
+        if (isIdentifierStart(c)) {
+            size_t start = i;
+            while (i < n && isIdentifierChar(line[i])) i++;
+            uint32_t node = insertWord(line.substr(start, i - start));
+            if (nodes[node].count++ == 0) words++;
+            entry.words.push_back(node);
+        } else if (c >= '0' && c <= '9') {
+            // Numbers, including suffixes, hex digits and ' separators
+            while (i < n && (isIdentifierChar(line[i]) || line[i] == '.' || line[i] == '\'')) i++;
+        } else if (c == '"' || c == '\'') {
+            for (i++; i < n && line[i] != c; i++) {
+                if (line[i] == '\\') i++;
+            }
+            i++;
+        } else if (c == '/' && i + 1 < n && line[i + 1] == '/') {
+            break;
+        } else {
+            i++;
+        }
+    }
+}
+
+void IdentifierIndex::removeLine(LineEntry& entry) {
+    for (uint32_t node : entry.words) {
+        if (--nodes[node].count == 0) words--;
+    }
+    entry.words.clear();
+}
+
+void IdentifierIndex::reset(size_t lineCount, size_t maxLines) {
+    // A fresh trie, so the words of earlier documents do not pile up
+    nodes.assign(1, Node());
+    for (const char* name : BUILTIN_NAMES) nodes[insertWord(name)].seeded = true;
+    words = 0;
+    entries.clear();
+    enabled = lineCount <= maxLines;
+    if (!enabled) {
+        dirtyCount = 0;
+        return;
+    }
+    entries.resize(lineCount);
+    firstDirty = 0;
+    dirtyCount = lineCount;
+}
+
+void IdentifierIndex::onEdit(size_t firstLine, size_t removedLines, size_t insertedLines) {
+    if (!enabled) return;
+    if (firstLine >= entries.size()) {
+        dirtyCount += firstLine + 1 - entries.size();
+        entries.resize(firstLine + 1);
+    }
+    size_t removeEnd = std::min(firstLine + removedLines, entries.size());
+    removedLines = removeEnd - firstLine;
+
+    // Removed lines take their words with them; surviving lines are retokenized
+    for (size_t k = firstLine; k < removeEnd; k++) {
+        removeLine(entries[k]);
+        if (entries[k].dirty) dirtyCount--;
+        entries[k].dirty = true;
+    }
+    size_t common = std::min(removedLines, insertedLines);
+    dirtyCount += common;
+    if (insertedLines > removedLines) {
+        entries.insert(entries.begin() + removeEnd, insertedLines - removedLines, LineEntry());
+        dirtyCount += insertedLines - removedLines;
+    } else if (removedLines > insertedLines) {
+        entries.erase(entries.begin() + firstLine + common, entries.begin() + removeEnd);
+    }
+    firstDirty = std::min(firstDirty, firstLine);
+}
+
+bool IdentifierIndex::refresh(const TextBuffer& buffer, double budgetMs) {
+    if (!enabled || dirtyCount == 0) return true;
+    if (entries.size() != buffer.lineCount()) {
+        // Out of step with the buffer; start over rather than guess
+        for (LineEntry& entry : entries) removeLine(entry);
+        entries.assign(buffer.lineCount(), LineEntry());
+        firstDirty = 0;
+        dirtyCount = entries.size();
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::duration<double, std::milli>(budgetMs);
+    size_t i = firstDirty;
+    for (size_t done = 0; i < entries.size() && dirtyCount > 0; i++) {
+        LineEntry& entry = entries[i];
+        if (!entry.dirty) continue;
+        addLine(entry, buffer.lineView(i, scratch));
+        entry.dirty = false;
+        dirtyCount--;
+        // The clock is read every few hundred lines
+        if (++done % 256 == 0 && std::chrono::steady_clock::now() >= deadline) {
+            i++;
+            break;
+        }
+    }
+    firstDirty = dirtyCount > 0 ? i : entries.size();
+    return dirtyCount == 0;
+}
+
+// --------- Lookup ---------
+void IdentifierIndex::complete(std::string_view prefix, size_t limit, std::vector<Completion>& out) const {
+    out.clear();
+    if (prefix.empty() || limit == 0) return;
+    uint32_t start = findNode(prefix);
+    if (!start) return;
+
+    // Walks the prefix's subtree in alphabetical order, keeping the best
+    // limit words in a heap whose top is the worst of them
+    struct Candidate {
+        uint32_t node, count, length, order;
+    };
+    auto better = [](const Candidate& a, const Candidate& b) {
+        if (a.count != b.count) return a.count > b.count;
+        if (a.length != b.length) return a.length < b.length;
+        return a.order < b.order;
+    };
+    std::vector<Candidate> best;
+    best.reserve(limit + 1);
+
+    struct Visit {
+        uint32_t node, length;
+    };
+    std::vector<Visit> stack;
+    uint32_t order = 0;
+    for (uint32_t child = nodes[start].child; child; child = nodes[child].sibling) {
+        stack.push_back({child, (uint32_t)prefix.size() + 1});
+    }
+    std::reverse(stack.begin(), stack.end());
+    while (!stack.empty()) {
+        Visit visit = stack.back();
+        stack.pop_back();
+        const Node& node = nodes[visit.node];
+        if (node.count > 0 || node.seeded) {
+            Candidate candidate = {visit.node, node.count, visit.length, order++};
+            if (best.size() < limit) {
+                best.push_back(candidate);
+                std::push_heap(best.begin(), best.end(), better);
+            } else if (better(candidate, best.front())) {
+                std::pop_heap(best.begin(), best.end(), better);
+                best.back() = candidate;
+                std::push_heap(best.begin(), best.end(), better);
+            }
+        }
+        // Children go on in reverse so the first one comes off next
+        size_t mark = stack.size();
+        for (uint32_t child = node.child; child; child = nodes[child].sibling) {
+            stack.push_back({child, visit.length + 1});
+        }
+        std::reverse(stack.begin() + mark, stack.end());
+    }
+
+    std::sort_heap(best.begin(), best.end(), better);
+    for (const Candidate& candidate : best) out.push_back({spell(candidate.node, candidate.length), candidate.count});
+}
@@ -0,0 +1,78 @@
+#ifndef IDENTIFIER_INDEX_HPP
+#define IDENTIFIER_INDEX_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "text_buffer.hpp"
+
+// One suggestion for a prefix
+struct Completion {
+    std::string word;
+    uint32_t count;    // Occurrences in the document; 0 for a keyword or library name not used yet
+};
+
+// Identifier frequencies of a document in a trie, for prefix completion.
+// The identifiers of every line are remembered, so an edit only takes back
+// the counts of the lines it touched and refresh() tokenizes just those,
+// the same way the search index tracks its matches. The trie starts out
+// with the C++ keywords and common standard library names.
+class IdentifierIndex {
+public:
+    IdentifierIndex();
+
+    // The whole document was replaced. Documents of more than maxLines
+    // lines are not indexed and only the built-in names are suggested.
+    void reset(size_t lineCount, size_t maxLines);
+
+    // Call after lines [firstLine, firstLine + removedLines) were replaced
+    // by insertedLines new lines
+    void onEdit(size_t firstLine, size_t removedLines, size_t insertedLines);
+
+    // Tokenizes the lines marked by reset or onEdit, stopping once budgetMs
+    // have passed so that indexing a large file is spread over several
+    // frames. Returns true when nothing is left to do.
+    bool refresh(const TextBuffer& buffer, double budgetMs);
+    bool pending() const { return dirtyCount > 0; }
+
+    // Up to limit words that start with prefix and are longer than it, most
+    // frequent first, then shortest, then in alphabetical order
+    void complete(std::string_view prefix, size_t limit, std::vector<Completion>& out) const;
+
+    size_t wordCount() const { return words; }   // Distinct identifiers in the document
+
+private:
+    // Children are a sibling list in character order; the root is node 0,
+    // so 0 doubles as "none"
+    struct Node {
+        uint32_t parent = 0;
+        uint32_t child = 0;
+        uint32_t sibling = 0;
+        uint32_t count = 0;    // Occurrences of the word ending here
+        char c = 0;
+        bool seeded = false;   // A built-in name, suggested even at count 0
+    };
+
+    struct LineEntry {
+        std::vector<uint32_t> words;   // Node of each identifier on the line
+        bool dirty = true;
+    };
+
+    uint32_t insertWord(std::string_view word);
+    uint32_t findNode(std::string_view word) const;
+    void addLine(LineEntry& entry, std::string_view line);
+    void removeLine(LineEntry& entry);
+    std::string spell(uint32_t node, size_t length) const;
+
+    std::vector<Node> nodes;
+    std::vector<LineEntry> entries;
+    bool enabled = true;
+    size_t firstDirty = 0;   // No line below this needs tokenizing
+    size_t dirtyCount = 0;
+    size_t words = 0;
+    std::string scratch;
+};
+
+#endif // IDENTIFIER_INDEX_HPP
@@ -1,614 +1,2493 @@
-#define SDL_MAIN_HANDLED
-
-#ifdef _WIN32
-#include <windows.h>
-#endif
-
-#include <SDL2/SDL.h>
-#include <SDL2/SDL_ttf.h>
-#include <iostream>
-#include <fstream>
-#include <vector>
-#include <string>
-#include <cstdlib>
-#include <regex>
-#include <stack>
-#include "compile.hpp"
-
-const int SCREEN_WIDTH = 1200;
-const int SCREEN_HEIGHT = 700;
-const int STATUS_BAR_HEIGHT = 24;
-const int ERROR_PANEL_HEIGHT = 100;
-const std::string FONT_PATH = "arial.ttf";
-const std::string OUTPUT_FILE = "temp_output.exe";
-const std::string ERROR_FILE = "compile_errors.txt";
-std::string userInput;
-
-SDL_Window* window = nullptr;
-SDL_Renderer* renderer = nullptr;
-TTF_Font* font = nullptr;
-std::vector<std::string> lines = {""};
-std::vector<std::string> errorMessages;
-int currentLine = 0, cursorPos = 0, scrollOffset = 0;
-bool quit = false, selecting = false;
-int selectionStartLine = -1, selectionStartPos = -1;
-std::stack<std::vector<std::string>> undoStack, redoStack;
-
-bool init();
-void close();
-void renderTextEditor();
-void renderStatusBar();
-void renderErrorPanel();
-void renderSidebar();
-void renderRightSidebar();
-void handleInput(SDL_Event& e);
-void handleMouseInput(SDL_Event& e);
-void compileAndRun();
-void highlightSyntax(std::string& line, SDL_Color& color);
-void showCompileErrors();
-void newProject();
-void saveProject();
-void toggleTheme();
-void debugAndCompile();
-void runProject();
-void saveToFile(const std::string& filename);
-void loadFromFile(const std::string& filename);
-void pushUndoState();
-void undo();
-void redo();
-void copySelection();
-void pasteClipboard();
-
-// --------- Button Structure ---------
-struct Button {
-    SDL_Rect rect;
-    std::string label;
-    void (*action)();
-};
-
-std::vector<Button> buttons = {
-    {{SCREEN_WIDTH - 210, 50, 200, 40}, "New Project", newProject},
-    {{SCREEN_WIDTH - 210, 100, 200, 40}, "Save Project", saveProject},
-    {{SCREEN_WIDTH - 210, 150, 200, 40}, "Undo", undo},
-    {{SCREEN_WIDTH - 210, 200, 200, 40}, "Redo", redo},
-    {{SCREEN_WIDTH - 210, 250, 200, 40}, "Toggle Theme", toggleTheme},
-    {{SCREEN_WIDTH - 210, 300, 200, 40}, "Debug & Compile", debugAndCompile},
-    {{SCREEN_WIDTH - 210, 350, 200, 40}, "Run", runProject}
-};
-
-bool init() {
-    std::cout << "Initializing SDL..." << std::endl;
-
-    if (SDL_Init(SDL_INIT_VIDEO) < 0) {
-        std::cerr << "SDL could not initialize! SDL_Error: " << SDL_GetError() << std::endl;
-        return false;
-    }
-    if (TTF_Init() == -1) {
-        std::cerr << "TTF could not initialize! SDL_ttf Error: " << TTF_GetError() << std::endl;
-        return false;
-    }
-
-    window = SDL_CreateWindow("SDL IDE", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
-                              SCREEN_WIDTH, SCREEN_HEIGHT, SDL_WINDOW_SHOWN);
-    if (!window) {
-        std::cerr << "Window could not be created! SDL_Error: " << SDL_GetError() << std::endl;
-        return false;
-    }
-
-    renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
-    if (!renderer) {
-        std::cerr << "Renderer could not be created! SDL_Error: " << SDL_GetError() << std::endl;
-        return false;
-    }
-
-    std::cout << "Loading font from: " << FONT_PATH << std::endl;
-    font = TTF_OpenFont(FONT_PATH.c_str(), 24);
-    if (!font) {
-        std::cerr << "Failed to load font! TTF_Error: " << TTF_GetError() << std::endl;
-        return false;
-    }
-
-    std::cout << "Font loaded successfully!" << std::endl;
-    SDL_StartTextInput();
-    return true;
-}
-
-
-
-void close() {
-    SDL_StopTextInput();
-    TTF_CloseFont(font);
-    SDL_DestroyRenderer(renderer);
-    SDL_DestroyWindow(window);
-    TTF_Quit();
-    SDL_Quit();
-}
-
-// --------- New Project Function ---------
-void newProject() {
-    lines.clear();
-    lines.push_back("");
-    currentLine = cursorPos = 0;
-    std::cout << "New project created!\n";
-}
-
-
-// --------- Save Project Function ---------
-void saveProject() {
-    saveToFile("saved_project.cpp");
-    std::cout << "Project saved!\n";
-}
-
-bool darkMode = true;
-
-// --------- Toggle Theme Function ---------
-void toggleTheme() {
-    darkMode = !darkMode;
-    std::cout << "Theme toggled!\n";
-
-    renderTextEditor();
-}
-
-
-// --------- Debug and Compile Function ---------
-void debugAndCompile() {
-    std::cout << "Debugging and compiling...\n";
-    compileAndRun();
-}
-
-
-// --------- Run Project Function ---------
-void runProject() {
-    std::cout << "Running project...\n";
-    compileAndRun();
-}
-
-
-// --------- Clipboard Function ---------
-void copySelection() {
-    if (selectionStartLine != -1 && selecting) {
-        int startLine = std::min(selectionStartLine, currentLine);
-        int endLine = std::max(selectionStartLine, currentLine);
-
-        std::string copiedText = "";
-        for (int i = startLine; i <= endLine; i++) {
-            copiedText += lines[i] + "\n";
-        }
-        SDL_SetClipboardText(copiedText.c_str());
-    }
-}
-
-void pasteClipboard() {
-    if (SDL_HasClipboardText()) {
-        char* text = SDL_GetClipboardText();
-        lines[currentLine].insert(cursorPos, text);
-        cursorPos += strlen(text);
-        SDL_free(text);
-    }
-}
-
-// --------- Mouse Handling ---------
-void handleMouseInput(SDL_Event& e) {
-    if (e.type == SDL_MOUSEBUTTONDOWN) {
-        int mouseX = e.button.x;
-        int mouseY = e.button.y;
-        int clickedLine = (mouseY + scrollOffset) / 24;
-        if (clickedLine < lines.size()) {
-            currentLine = clickedLine;
-            selecting = true;
-            selectionStartLine = currentLine;
-            selectionStartPos = cursorPos;
-        }
-
-        for (auto& button : buttons) {
-            if (mouseX >= button.rect.x && mouseX <= button.rect.x + button.rect.w &&
-                mouseY >= button.rect.y && mouseY <= button.rect.y + button.rect.h) {
-                button.action();
-                return;
-            }
-        }
-    } else if (e.type == SDL_MOUSEBUTTONUP) {
-        selecting = false;
-    }
-}
-
-// --------- Status Bar Rendering ---------
-void renderStatusBar() {
-    SDL_SetRenderDrawColor(renderer, 100, 100, 100, 255);
-    SDL_Rect statusBar = {0, SCREEN_HEIGHT, SCREEN_WIDTH, STATUS_BAR_HEIGHT};
-    SDL_RenderFillRect(renderer, &statusBar);
-
-    std::string status = "Line: " + std::to_string(currentLine + 1) + ", Pos: " + std::to_string(cursorPos);
-    if (selecting) {
-        status += " [SELECTING]";
-    }
-    SDL_Color statusColor = {255, 255, 255, 255};
-    SDL_Surface* textSurface = TTF_RenderText_Blended(font, status.c_str(), statusColor);
-    SDL_Texture* textTexture = SDL_CreateTextureFromSurface(renderer, textSurface);
-    SDL_Rect renderQuad = {10, SCREEN_HEIGHT + 2, textSurface->w, textSurface->h};
-    SDL_RenderCopy(renderer, textTexture, nullptr, &renderQuad);
-    SDL_FreeSurface(textSurface);
-    SDL_DestroyTexture(textTexture);
-}
-
-// --------- Sidebar Rendering ---------
-void renderSidebar() {
-    SDL_SetRenderDrawColor(renderer, 50, 50, 50, 255); // Dark gray
-    SDL_Rect sidebar = {0, 0, 60, SCREEN_HEIGHT};
-    SDL_RenderFillRect(renderer, &sidebar);
-
-    SDL_Color textColor = {255, 255, 255, 255};  // White text
-    int y = -scrollOffset;
-    for (size_t i = 0; i < lines.size(); i++, y += 28) {
-        std::string lineNumber = std::to_string(i + 1);
-        SDL_Surface* textSurface = TTF_RenderText_Solid(font, lineNumber.c_str(), textColor);
-        SDL_Texture* textTexture = SDL_CreateTextureFromSurface(renderer, textSurface);
-
-        int textWidth = textSurface->w;
-        SDL_Rect renderQuad = {30 - textWidth / 2, y + 5, textWidth, textSurface->h};
-        SDL_RenderCopy(renderer, textTexture, nullptr, &renderQuad);
-
-        SDL_FreeSurface(textSurface);
-        SDL_DestroyTexture(textTexture);
-    }
-}
-
-void renderRightSidebar() {
-    SDL_SetRenderDrawColor(renderer, 50, 50, 50, 255);  // Dark Gray
-    SDL_Rect sidebar = {SCREEN_WIDTH - 220, 0, 220, SCREEN_HEIGHT};
-    SDL_RenderFillRect(renderer, &sidebar);
-
-    SDL_Color textColor = {255, 255, 255, 255};  // White text
-
-    for (const auto& button : buttons) {
-        SDL_SetRenderDrawColor(renderer, 70, 70, 70, 255);
-        SDL_RenderFillRect(renderer, &button.rect);
-
-        SDL_Surface* textSurface = TTF_RenderText_Solid(font, button.label.c_str(), textColor);
-        SDL_Texture* textTexture = SDL_CreateTextureFromSurface(renderer, textSurface);
-
-        int textWidth = textSurface->w;
-        SDL_Rect textRect = {button.rect.x + (button.rect.w - textWidth) / 2, button.rect.y + 10, textWidth, textSurface->h};
-        SDL_RenderCopy(renderer, textTexture, nullptr, &textRect);
-
-        SDL_FreeSurface(textSurface);
-        SDL_DestroyTexture(textTexture);
-    }
-}
-
-// --------- Text Rendering ---------
-void renderTextEditor() {
-    if (darkMode) {
-        SDL_SetRenderDrawColor(renderer, 30, 30, 30, 255);  // Dark mode
-    } else {
-        SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);  // Light mode
-    }
-    SDL_RenderClear(renderer);
-
-    renderSidebar();
-    renderRightSidebar();
-    renderStatusBar();
-
-    std::vector<std::string> keywords = {"int", "if", "return", "else", "for", "while"};
-    int y = -scrollOffset;
-
-    for (size_t i = 0; i < lines.size(); i++, y += 28) {
-        SDL_Color textColor = darkMode ? SDL_Color{255, 255, 255, 255} : SDL_Color{0, 0, 0, 255};  // White text in dark mode, black in light mode
-
-        for (const std::string& keyword : keywords) {
-            if (lines[i].find(keyword) != std::string::npos) {
-                textColor = {255, 0, 0, 255};  // Red keywords
-            }
-        }
-
-        SDL_Surface* textSurface = TTF_RenderText_Solid(font, lines[i].c_str(), textColor);
-        if (!textSurface) continue;
-        SDL_Texture* textTexture = SDL_CreateTextureFromSurface(renderer, textSurface);
-
-        SDL_Rect renderQuad = {100, y, textSurface->w, 28};
-        SDL_RenderCopy(renderer, textTexture, nullptr, &renderQuad);
-        SDL_FreeSurface(textSurface);
-        SDL_DestroyTexture(textTexture);
-
-        // Cursor rendering
-        if (i == currentLine) {
-            int cursorX = 75;
-            if (cursorPos > 0) {
-                TTF_SizeText(font, lines[i].substr(0, cursorPos).c_str(), &cursorX, nullptr);
-                cursorX += 100;
-            }
-            SDL_SetRenderDrawColor(renderer, darkMode ? 255 : 0, darkMode ? 255 : 0, darkMode ? 255 : 0, 255);  // White cursor in dark mode, black in light mode
-            SDL_RenderDrawLine(renderer, cursorX, y + 5, cursorX, y + 25);
-        }
-    }
-
-    renderErrorPanel();
-    SDL_RenderPresent(renderer);
-}
-
-
-
-// --------- Save File Function ---------
-void saveToFile(const std::string& filename) {
-    std::ofstream file(filename);
-    if (!file) {
-        std::cerr << "Error opening file: " << filename << std::endl;
-        return;
-    }
-    for (const auto& line : lines) {
-        file << line << "\n";
-    }
-    file.close();
-}
-
-// --------- Load From File Function ---------
-void loadFromFile(const std::string& filename) {
-    std::ifstream file(filename);
-    if (!file) {
-        std::cerr << "Error opening file: " << filename << std::endl;
-        return;
-    }
-    lines.clear();
-    std::string line;
-    while (std::getline(file, line)) {
-        lines.push_back(line);
-    }
-    file.close();
-    currentLine = 0;
-    cursorPos = 0;
-}
-
-// --------- Push Undo State Function ---------
-void pushUndoState() {
-    undoStack.push(lines);
-    while (!redoStack.empty()) redoStack.pop();
-}
-
-// --------- Undo Function ---------
-void undo() {
-    if (!undoStack.empty()) {
-        redoStack.push(lines);
-        lines = undoStack.top();
-        undoStack.pop();
-    }
-}
-
-// --------- Redo Function ---------
-void redo() {
-    if (!redoStack.empty()) {
-        undoStack.push(lines);
-        lines = redoStack.top();
-        redoStack.pop();
-    }
-}
-
-// --------- Error Panel Rendering Function ---------
-void renderErrorPanel() {
-    SDL_SetRenderDrawColor(renderer, 30, 30, 30, 255); // Dark background
-    SDL_Rect errorPanel = {0, SCREEN_HEIGHT - ERROR_PANEL_HEIGHT, SCREEN_WIDTH, ERROR_PANEL_HEIGHT};
-    SDL_RenderFillRect(renderer, &errorPanel);
-
-    SDL_Color errorColor = {255, 255, 255, 255};  // White text
-    int y = SCREEN_HEIGHT - ERROR_PANEL_HEIGHT + 10;
-
-    for (const auto& message : errorMessages) {
-        SDL_Surface* textSurface = TTF_RenderText_Blended(font, message.c_str(), errorColor);
-        SDL_Texture* textTexture = SDL_CreateTextureFromSurface(renderer, textSurface);
-        SDL_Rect renderQuad = {15, y, textSurface->w, textSurface->h};
-        SDL_RenderCopy(renderer, textTexture, nullptr, &renderQuad);
-        SDL_FreeSurface(textSurface);
-        SDL_DestroyTexture(textTexture);
-        y += 28;
-    }
-}
-
-
-// --------- Compilation & Execution ---------
-void compileAndRun() {
-
-    saveToFile("temp_code.cpp");
-    std::string compileCmd = "g++ temp_code.cpp -o " + OUTPUT_FILE + " 2> " + ERROR_FILE;
-
-    errorMessages.clear();
-    std::system(compileCmd.c_str());  // Compile
-
-    std::ifstream errorFile(ERROR_FILE);
-    std::string errorLine;
-    while (std::getline(errorFile, errorLine)) {
-        errorMessages.push_back("Error: " + errorLine);
-    }
-    errorFile.close();
-
-    if (errorMessages.empty()) {
-        std::string runCmd = OUTPUT_FILE + " < input.txt > program_output.txt 2>&1"; 
-        std::ofstream inputFile("input.txt");
-        inputFile << userInput;
-        inputFile.close();
-
-        std::system(runCmd.c_str());
-
-        std::ifstream outputFile("program_output.txt");
-        std::string outputLine;
-        while (std::getline(outputFile, outputLine)) {
-            errorMessages.push_back(" " + outputLine);
-        }
-        outputFile.close();
-    }
-}
-
-// --------- Error Panel Rendering ---------
-void showCompileErrors() {
-    errorMessages.clear();
-    std::ifstream errorFile(ERROR_FILE);
-    std::string errorLine;
-    while (std::getline(errorFile, errorLine)) {
-        errorMessages.push_back(errorLine);
-    }
-    errorFile.close();
-}
-
-// --------- Input Handling ---------
-void handleInput(SDL_Event& e) {
-    if (e.type == SDL_QUIT) {
-        quit = true;
-    } else if (e.type == SDL_KEYDOWN) {
-        if (e.key.keysym.sym == SDLK_UP) {
-            if (currentLine > 0) {
-                currentLine--;
-                cursorPos = std::min(cursorPos, (int)lines[currentLine].size());
-            }
-        } else if (e.key.keysym.sym == SDLK_DOWN) {
-            if (currentLine < lines.size() - 1) {
-                currentLine++;
-                cursorPos = std::min(cursorPos, (int)lines[currentLine].size());
-            }
-        } else if (e.key.keysym.sym == SDLK_s && SDL_GetModState() & KMOD_CTRL) {
-            saveToFile("saved_code.cpp");  // Ctrl+S saves the file
-            std::cout << "File saved as saved_code.cpp" << std::endl;
-        } else if (e.key.keysym.sym == SDLK_o && SDL_GetModState() & KMOD_CTRL) {
-            loadFromFile("saved_code.cpp");  // Ctrl+O opens the file
-            std::cout << "File loaded from saved_code.cpp" << std::endl;
-        } else if (e.key.keysym.sym == SDLK_b && SDL_GetModState() & KMOD_CTRL) {
-            std::cout << "Compiling and running the code..." << std::endl;
-            compileAndRun();
-        } else if (e.key.keysym.sym == SDLK_LEFT) {
-            if (cursorPos > 0) {
-                cursorPos--;
-            } else if (currentLine > 0) {
-                currentLine--;
-                cursorPos = lines[currentLine].size();
-            }
-        } else if (e.key.keysym.sym == SDLK_RIGHT) {
-            if (cursorPos < lines[currentLine].size()) {
-                cursorPos++;
-            } else if (currentLine < lines.size() - 1) {
-                currentLine++;
-                cursorPos = 0;
-            }
-        } else if (e.key.keysym.sym == SDLK_a && SDL_GetModState() & KMOD_CTRL) { 
-            // ---- Select All (Ctrl + A) ----
-            selectionStartLine = 0;
-            selectionStartPos = 0;
-            currentLine = lines.size() - 1;
-            cursorPos = lines[currentLine].size();
-            selecting = true;
-        } else if (e.key.keysym.sym == SDLK_x && SDL_GetModState() & KMOD_CTRL) { 
-            // ---- Cut (Ctrl + X) ----
-            if (selecting && selectionStartLine != -1) {
-                copySelection();
-                pushUndoState();
-
-                int startLine = std::min(selectionStartLine, currentLine);
-                int endLine = std::max(selectionStartLine, currentLine);
-
-                lines.erase(lines.begin() + startLine, lines.begin() + endLine + 1);
-                
-                currentLine = std::max(0, startLine);
-                cursorPos = 0;
-                selecting = false;
-            }
-        } else if (e.key.keysym.sym == SDLK_BACKSPACE) {
-            if (cursorPos > 0) {
-                pushUndoState();
-                lines[currentLine].erase(cursorPos - 1, 1);
-                cursorPos--;
-            }
-        }
-        // ---- Auto-Complete Feature ----
-        else if (e.key.keysym.sym == SDLK_LEFTPAREN) { // "("
-            lines[currentLine].insert(cursorPos, "()");
-            cursorPos++;
-        } else if (e.key.keysym.sym == SDLK_RIGHTPAREN) { // ")"
-            if (cursorPos < lines[currentLine].size() && lines[currentLine][cursorPos] == ')') {
-                cursorPos++;
-            } else {
-                lines[currentLine].insert(cursorPos, ")");
-                cursorPos++;
-            }
-        } else if (e.key.keysym.sym == SDLK_LEFTBRACKET) { // "["
-            lines[currentLine].insert(cursorPos, "[]");
-            cursorPos++;
-        } else if (e.key.keysym.sym == SDLK_RIGHTBRACKET) { // "]"
-            if (cursorPos < lines[currentLine].size() && lines[currentLine][cursorPos] == ']') {
-                cursorPos++;
-            } else {
-                lines[currentLine].insert(cursorPos, "]");
-                cursorPos++;
-            }
-        } else if (e.key.keysym.sym == SDLK_RETURN) {
-            pushUndoState();
-            lines.insert(lines.begin() + currentLine + 1, lines[currentLine].substr(cursorPos));
-            lines[currentLine] = lines[currentLine].substr(0, cursorPos);
-            currentLine++;
-            cursorPos = 0;
-        } else if (e.key.keysym.sym == SDLK_z && SDL_GetModState() & KMOD_CTRL) {
-            undo();
-        } else if (e.key.keysym.sym == SDLK_y && SDL_GetModState() & KMOD_CTRL) {
-            redo();
-        } else if (e.key.keysym.sym == SDLK_c && SDL_GetModState() & KMOD_CTRL) {
-            SDL_SetClipboardText(lines[currentLine].c_str()); // Copy
-        } else if (e.key.keysym.sym == SDLK_v && SDL_GetModState() & KMOD_CTRL) {
-            if (SDL_HasClipboardText()) {
-                char* text = SDL_GetClipboardText();
-                lines[currentLine].insert(cursorPos, text);
-                cursorPos += strlen(text);
-                SDL_free(text);  // Paste
-            }
-        }
-        
-    } else if (e.type == SDL_TEXTINPUT) {
-        char ch = e.text.text[0];
-
-        if (ch == '{') {
-            lines[currentLine].insert(cursorPos, "{}");
-            cursorPos++;
-        } else if (ch == '}') {
-            if (cursorPos < lines[currentLine].size() && lines[currentLine][cursorPos] == '}') {
-                cursorPos++;
-            } else {
-                lines[currentLine].insert(cursorPos, "}");
-                cursorPos++;
-            }
-        } else {
-            lines[currentLine].insert(cursorPos, e.text.text);
-            cursorPos += strlen(e.text.text);
-        }
-    }
-
-    handleMouseInput(e);
-}
-
-
-// --------- Main Loop ---------
-int main(int argc, char* argv[])
-{
-    std::cout << "Initializing SDL..." << std::endl;
-    if (!init()) {
-        std::cerr << "Initialization failed! Exiting..." << std::endl;
-        return -1;
-    }
-    std::cout << "SDL Initialized Successfully!" << std::endl;
-
-    SDL_Event e;
-    while (!quit) {
-        std::cout << "Waiting for events..." << std::endl;
-        while (SDL_PollEvent(&e)) {
-            std::cout << "Event detected: " << e.type << std::endl;
-
-            if (e.type == SDL_QUIT) {
-                std::cout << "SDL_QUIT event detected! Exiting program..." << std::endl;
-                quit = true;
-            }
-
-            handleInput(e);
-        }
-
-        renderTextEditor();
-
-        SDL_Delay(100);
-    }
-
-    std::cout << "Exiting program..." << std::endl;
-    close();
-    return 0;
-}
+#define SDL_MAIN_HANDLED
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <cstdlib>
+#include <regex>
+#include "compile.hpp"
+#include "glyph_atlas.hpp"
+#include "scheduler.hpp"
+#include "text_buffer.hpp"
+#include "undo_history.hpp"
+#include "syntax_highlighter.hpp"
+#include "jobs.hpp"
+#include "build_cache.hpp"
+#include "pch.hpp"
+#include "console.hpp"
+#include "mapped_file.hpp"
+#include "file_saver.hpp"
+#include "trace.hpp"
+#include "search.hpp"
+#include "diagnostics.hpp"
+#include "project_build.hpp"
+#include "program_benchmark.hpp"
+#include "identifier_index.hpp"
+#include "line_layout.hpp"
+#include "profiler.hpp"
+#include "build_config.hpp"
+#include "edit_journal.hpp"
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <cstdio>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+
+const int SCREEN_WIDTH = 1200;
+const int SCREEN_HEIGHT = 700;
+const int STATUS_BAR_HEIGHT = 24;
+const int ERROR_PANEL_HEIGHT = 100;
+const int EDITOR_HEIGHT = SCREEN_HEIGHT - ERROR_PANEL_HEIGHT;
+const int LINE_HEIGHT = 28;
+const int GUTTER_WIDTH = 60;
+const int RIGHT_SIDEBAR_WIDTH = 220;
+const int WHEEL_SCROLL_LINES = 3;
+const int EDITOR_TEXT_X = 100;
+const size_t UNDO_MEMORY_BUDGET = 64 * 1024 * 1024;
+const int COMPILE_TIMEOUT_MS = 60000;
+const int RUN_TIMEOUT_MS = 10000;      // Runaway programs are killed after this
+const Uint32 PROGRESS_REFRESH_MS = 100;
+const size_t CONSOLE_MAX_LINES = 100000;          // Older output is dropped past either cap
+const size_t CONSOLE_MAX_BYTES = 8 * 1024 * 1024;
+const int CONSOLE_ROW_HEIGHT = 24;
+const size_t PCH_SCAN_BYTES = 64 * 1024;           // How far into a program its include block is looked for
+const size_t LARGE_FILE_BYTES = 16 * 1024 * 1024;  // Files this big are memory-mapped instead of read
+const std::string TRACE_FILE = "ide_trace.json";
+const int FIND_ROW_HEIGHT = 30;
+const SDL_Rect OVERLAY_RECT = {SCREEN_WIDTH - RIGHT_SIDEBAR_WIDTH - 330, 10, 320, 4 * 24 + 10};
+
+// Screen regions, each repainted on its own when marked dirty
+const SDL_Rect GUTTER_RECT = {0, 0, GUTTER_WIDTH, EDITOR_HEIGHT};
+const SDL_Rect EDITOR_RECT = {GUTTER_WIDTH, 0, SCREEN_WIDTH - GUTTER_WIDTH - RIGHT_SIDEBAR_WIDTH, EDITOR_HEIGHT};
+const SDL_Rect RIGHT_SIDEBAR_RECT = {SCREEN_WIDTH - RIGHT_SIDEBAR_WIDTH, 0, RIGHT_SIDEBAR_WIDTH, EDITOR_HEIGHT};
+const SDL_Rect ERROR_PANEL_RECT = {0, EDITOR_HEIGHT, SCREEN_WIDTH, ERROR_PANEL_HEIGHT};
+const SDL_Rect STATUS_BAR_RECT = {0, SCREEN_HEIGHT, SCREEN_WIDTH, STATUS_BAR_HEIGHT};
+const std::string FONT_PATH = "arial.ttf";
+const std::string OUTPUT_STEM = "temp_output";  // Each build configuration writes temp_output-<name>.exe
+const std::string SOURCE_FILE = "temp_code.cpp";  // The editor text as the compiler sees it
+const std::string PROJECT_FILE = "ide_project.txt";  // Sources and options for Build Project
+const std::string CONFIG_FILE = "ide_configs.txt";   // Named build configurations for Run, Benchmark Run and Compare
+const std::string CHECK_FILE = "temp_check.cpp";    // The snapshot the background syntax check reads
+const Uint32 SYNTAX_CHECK_DELAY_MS = 500;            // Typing pause before a check; IDE_CHECK_DELAY_MS overrides, 0 disables
+const size_t SYNTAX_CHECK_MAX_BYTES = 4 * 1024 * 1024;  // Larger documents are not checked as you type
+const std::string BENCH_INPUT_DIR = "bench_inputs";  // Benchmark Run uses every file here instead of input.txt
+const int BENCH_WARMUP_RUNS = 2;
+const int BENCH_RUNS = 10;
+const size_t BENCH_MEMORY_LIMIT = 1024ull * 1024 * 1024;  // Address space per benchmark run
+const size_t COMPLETION_MIN_PREFIX = 2;        // Characters typed before suggestions appear
+const size_t COMPLETION_ROWS = 8;
+const int COMPLETION_ROW_HEIGHT = 24;
+const double IDENTIFIER_INDEX_BUDGET_MS = 4.0;   // Indexing time per loop iteration while a file is being indexed
+const size_t IDENTIFIER_INDEX_MAX_LINES = 500000;  // Larger documents only get keyword suggestions
+const size_t LAYOUT_CACHE_LINES = 1024;          // Measured lines kept for drawing and hit-testing
+const size_t PROFILE_TOP_LINES = 10;             // Costliest lines listed in the console after Profile Run
+const std::string JOURNAL_DIR = ".ide_journal";   // Snapshot and edit log for crash recovery
+const int JOURNAL_FLUSH_MS = 200;                  // Edits reach the log at most this long after they are made
+const size_t JOURNAL_COMPACT_MIN_BYTES = 1024 * 1024;  // The log is folded into a snapshot past this or half the document
+const std::string ERROR_FILE = "compile_errors.txt";
+std::string userInput;
+
+SDL_Window* window = nullptr;
+SDL_Renderer* renderer = nullptr;
+TTF_Font* font = nullptr;
+SDL_Texture* frameTexture = nullptr;  // Persistent back buffer for partial redraws
+GlyphAtlas textAtlas;
+TextBuffer buffer;
+std::string lineScratch;  // Reused when a line spans several pieces
+std::string mappedPath;   // File the document is mapped from, if any
+OutputConsole console(CONSOLE_MAX_LINES, CONSOLE_MAX_BYTES);
+size_t consoleScroll = 0;    // First console line on screen
+bool consoleFollow = true;   // Keep the newest output in view
+int currentLine = 0, cursorPos = 0, scrollOffset = 0;
+bool quit = false, selecting = false;
+int selectionStartLine = -1, selectionStartPos = -1;
+bool dragging = false;       // The left button went down in the text and is still held
+UndoHistory history(UNDO_MEMORY_BUDGET);
+SyntaxHighlighter highlighter;
+std::vector<TokenSpan> lineSpans;
+Job buildJob(wakeEventLoop);
+std::string buildStatus;  // Shown on the right of the status bar
+SaveQueue saveQueue(wakeEventLoop);
+std::string saveStatus;   // Outcome of the last save, shown in the status bar
+std::map<std::string, uint64_t> savedVersions;  // Edit version of the latest save requested for each path
+bool showOverlay = false;             // F3: performance overlay
+double lastFrameMs = 0.0;             // Time spent drawing the last frame
+uint64_t lastFrameUploads = 0;        // Glyph texture uploads during the last frame
+std::atomic<double> lastCompileSeconds{-1.0};  // Set by the build thread; negative until a compile has run
+SearchIndex search;
+bool findOpen = false;        // Ctrl+F / Ctrl+H bar at the bottom of the editor
+bool findReplaceMode = false;
+bool findReplaceFocus = false;   // Typing goes to the replace field
+std::string findText, replaceText;
+SearchOptions findOptions;
+std::string findStatus;       // Match count or regex error
+size_t findLine = 0;          // The current match, if findHasCurrent
+SearchMatch findCurrent = {0, 0};
+bool findHasCurrent = false;
+DiagnosticIndex diagnosticIndex;  // Last build's diagnostics; gutter markers refer to the compiled text
+Job checkJob(wakeEventLoop);      // At most one background syntax check at a time
+Uint32 checkDelayMs = SYNTAX_CHECK_DELAY_MS;
+bool checkScheduled = false;      // An edit is waiting for its check
+Uint32 checkDueTicks = 0;
+bool checkInFlight = false;       // Started and its Finished event not yet seen
+uint64_t editVersion = 0;         // Bumped by every edit
+uint64_t checkedVersion = 0;      // The edit version the running check is looking at
+std::vector<std::string> pendingCheck;   // Diagnostics of the running check
+DiagnosticIndex liveDiagnostics;  // Last completed check of the current text
+std::vector<std::string> checkLines;     // Shown in the error panel below the console
+bool liveIsNewer = false;         // The check is more recent than the last build
+IdentifierIndex identifiers;
+bool completionOpen = false;      // Suggestions for the identifier left of the cursor
+std::vector<Completion> completions;
+size_t completionSelected = 0;
+size_t completionPrefixLength = 0;
+bool completionChosen = false;    // Up or Down moved the selection, so Enter accepts it
+LineLayoutCache layouts(LAYOUT_CACHE_LINES);
+std::vector<uint64_t> profileCost;   // Last profile's cost of each line; the heatmap refers to the profiled text
+uint64_t profileTotal = 0, profileMax = 0;
+bool showProfile = true;             // F6 hides and shows the heatmap
+std::mutex profileMutex;             // Guards the handoff from the profile job
+ProfileResult finishedProfile;
+bool profileFinished = false;
+std::vector<BuildConfig> buildConfigs;   // From ide_configs.txt
+size_t activeConfig = 0;                 // Used by Run, Benchmark Run and the syntax check
+size_t compareConfig = 1;                // What Compare Configs measures the active one against
+EditJournal journal(JOURNAL_DIR, JOURNAL_FLUSH_MS);
+
+bool init();
+void close();
+void renderFrame();
+void renderTextEditor();
+void renderStatusBar();
+void renderErrorPanel();
+int consoleVisibleRows();
+void scrollConsole(long lines);
+void clearConsole();
+void renderSidebar();
+void renderRightSidebar();
+void renderOverlay();
+void renderFindBar();
+void openFind(bool replace);
+void closeFind();
+void updateSearch();
+void findNext(bool forward);
+void replaceCurrent();
+void replaceAll();
+bool handleFindInput(SDL_Event& e);
+void replaceRange(size_t offset, size_t count, std::string_view text);
+void toggleTracing();
+void jumpToDiagnostic(const Diagnostic& diagnostic);
+const DiagnosticIndex& editorDiagnostics();
+size_t panelLineCount();
+std::string_view panelLine(size_t i);
+void scheduleSyntaxCheck();
+void runSyntaxCheck(Job& job, const TextSnapshot& source, const BuildConfig& config);
+void pollSyntaxCheck();
+void nextDiagnostic(bool forward);
+void updateCompletion();
+void closeCompletion();
+void acceptCompletion();
+bool handleCompletionInput(SDL_Event& e);
+void renderCompletionPopup();
+void pollIdentifierIndex();
+void clickErrorPanel(int mouseY);
+void handleInput(SDL_Event& e);
+void handleMouseInput(SDL_Event& e);
+void compileAndRun();
+void benchmarkRun();
+void profileRun();
+void runProfile(Job& job, const TextSnapshot& source, const BuildConfig& config);
+void clearProfile();
+void startBuild(bool benchmark);
+std::vector<std::string> buildCommand(const BuildConfig& config);
+void runBuild(Job& job, const TextSnapshot& source, const BuildConfig& config, bool benchmark);
+std::string runBenchmarks(Job& job, const std::string& buildKey, const BuildConfig& config);
+void loadConfigs();
+void updateConfigButtons();
+void nextConfig();
+void nextCompareConfig();
+void compareConfigs();
+void runCompare(Job& job, const TextSnapshot& source, const BuildConfig& first, const BuildConfig& second);
+void buildProjectAndRun();
+void runProjectBuild(Job& job, const ProjectManifest& manifest);
+void pollSaveQueue();
+void recoverSession();
+void pollJournal();
+void cancelBuild();
+void pollBuildJob();
+SDL_Color tokenColor(TokenType type);
+void showCompileErrors();
+void newProject();
+void saveProject();
+void toggleTheme();
+void runProject();
+void saveToFile(const std::string& filename);
+void loadFromFile(const std::string& filename);
+void undo();
+void redo();
+bool hasSelection();
+void selectionRange(size_t& start, size_t& end);
+void clearSelection();
+void deleteSelection();
+void copySelection();
+void pasteClipboard();
+int lineCount();
+int lineLength(int line);
+size_t cursorOffset();
+void moveCursorTo(size_t offset);
+const LineLayout& lineLayout(size_t line, std::string_view text);
+size_t columnAtPoint(size_t line, int mouseX);
+void clampCursor();
+void applyEdit(size_t offset, size_t count, std::string_view text);
+void insertText(size_t offset, std::string_view text, EditKind kind = EditKind::Other);
+void eraseText(size_t offset, size_t count, EditKind kind = EditKind::Other);
+int visibleLineCount();
+void clampScroll();
+void ensureCursorVisible();
+
+// --------- Button Structure ---------
+struct Button {
+    SDL_Rect rect;
+    std::string label;
+    void (*action)();
+};
+
+// The configuration buttons' labels are filled in by updateConfigButtons
+std::vector<Button> buttons = {
+    {{SCREEN_WIDTH - 210, 16, 200, 40}, "New Project", newProject},
+    {{SCREEN_WIDTH - 210, 64, 200, 40}, "Save Project", saveProject},
+    {{SCREEN_WIDTH - 210, 112, 200, 40}, "Undo", undo},
+    {{SCREEN_WIDTH - 210, 160, 200, 40}, "Redo", redo},
+    {{SCREEN_WIDTH - 210, 208, 200, 40}, "Toggle Theme", toggleTheme},
+    {{SCREEN_WIDTH - 210, 256, 200, 40}, "Config", nextConfig},
+    {{SCREEN_WIDTH - 210, 304, 200, 40}, "Run", runProject},
+    {{SCREEN_WIDTH - 210, 352, 200, 40}, "Benchmark Run", benchmarkRun},
+    {{SCREEN_WIDTH - 210, 400, 200, 40}, "Profile Run", profileRun},
+    {{SCREEN_WIDTH - 210, 448, 200, 40}, "Compare With", nextCompareConfig},
+    {{SCREEN_WIDTH - 210, 496, 200, 40}, "Compare Configs", compareConfigs},
+    {{SCREEN_WIDTH - 210, 544, 200, 40}, "Build Project", buildProjectAndRun}
+};
+
+bool init() {
+    std::cout << "Initializing SDL..." << std::endl;
+    traceThreadName("main");
+    if (std::getenv("IDE_TRACE")) setTracing(true);  // Trace from startup; F4 writes the dump
+    if (const char* delay = std::getenv("IDE_CHECK_DELAY_MS")) checkDelayMs = (Uint32)std::atoi(delay);
+    loadConfigs();
+
+    if (SDL_Init(SDL_INIT_VIDEO) < 0) {
+        std::cerr << "SDL could not initialize! SDL_Error: " << SDL_GetError() << std::endl;
+        return false;
+    }
+    if (TTF_Init() == -1) {
+        std::cerr << "TTF could not initialize! SDL_ttf Error: " << TTF_GetError() << std::endl;
+        return false;
+    }
+
+    window = SDL_CreateWindow("SDL IDE", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
+                              SCREEN_WIDTH, SCREEN_HEIGHT + STATUS_BAR_HEIGHT, SDL_WINDOW_SHOWN);
+    if (!window) {
+        std::cerr << "Window could not be created! SDL_Error: " << SDL_GetError() << std::endl;
+        return false;
+    }
+
+    renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+    if (!renderer) {
+        std::cerr << "Renderer could not be created! SDL_Error: " << SDL_GetError() << std::endl;
+        return false;
+    }
+
+    // Without render targets every frame is drawn in full
+    if (SDL_RenderTargetSupported(renderer)) {
+        frameTexture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET,
+                                         SCREEN_WIDTH, SCREEN_HEIGHT + STATUS_BAR_HEIGHT);
+    }
+    initScheduler();
+
+    std::cout << "Loading font from: " << FONT_PATH << std::endl;
+    font = TTF_OpenFont(FONT_PATH.c_str(), 24);
+    if (!font) {
+        std::cerr << "Failed to load font! TTF_Error: " << TTF_GetError() << std::endl;
+        return false;
+    }
+
+    std::cout << "Font loaded successfully!" << std::endl;
+    if (!textAtlas.init(renderer, font)) {
+        return false;
+    }
+    SDL_StartTextInput();
+    recoverSession();
+    return true;
+}
+
+
+
+void close() {
+    buildJob.cancel();
+    buildJob.wait();
+    checkJob.cancel();
+    checkJob.wait();
+    saveQueue.flush();
+    journal.finish();  // A clean exit leaves nothing to recover
+    SDL_StopTextInput();
+    textAtlas.destroy();
+    if (frameTexture) SDL_DestroyTexture(frameTexture);
+    TTF_CloseFont(font);
+    SDL_DestroyRenderer(renderer);
+    SDL_DestroyWindow(window);
+    TTF_Quit();
+    SDL_Quit();
+}
+
+// --------- New Project Function ---------
+void newProject() {
+    buffer.setText(std::string());
+    mappedPath.clear();
+    journal.checkpoint(buffer.snapshot());
+    highlighter.reset(buffer.lineCount());
+    search.reset(buffer.lineCount());
+    identifiers.reset(buffer.lineCount(), IDENTIFIER_INDEX_MAX_LINES);
+    layouts.clear();
+    clearProfile();
+    closeCompletion();
+    history.clear();
+    scheduleSyntaxCheck();
+    currentLine = cursorPos = scrollOffset = 0;
+    markDirty(DIRTY_ALL);
+    std::cout << "New project created!\n";
+}
+
+
+// --------- Save Project Function ---------
+void saveProject() {
+    saveToFile("saved_project.cpp");
+    std::cout << "Saving project...\n";
+}
+
+bool darkMode = true;
+
+// --------- Toggle Theme Function ---------
+void toggleTheme() {
+    darkMode = !darkMode;
+    std::cout << "Theme toggled!\n";
+
+    markDirty(DIRTY_ALL);
+}
+
+
+// --------- Run Project Function ---------
+void runProject() {
+    std::cout << "Running project...\n";
+    compileAndRun();
+}
+
+
+// --------- Buffer Access ---------
+int lineCount() {
+    return (int)buffer.lineCount();
+}
+
+int lineLength(int line) {
+    return (int)buffer.lineLength(line);
+}
+
+size_t cursorOffset() {
+    return buffer.offsetOf(currentLine, cursorPos);
+}
+
+void moveCursorTo(size_t offset) {
+    currentLine = (int)buffer.lineOf(offset);
+    cursorPos = (int)(offset - buffer.lineStart(currentLine));
+}
+
+void clampCursor() {
+    currentLine = std::max(0, std::min(currentLine, lineCount() - 1));
+    cursorPos = std::max(0, std::min(cursorPos, lineLength(currentLine)));
+}
+
+// Glyph positions of a line whose text the caller has already fetched
+const LineLayout& lineLayout(size_t line, std::string_view text) {
+    return layouts.layout(line, text, textAtlas);
+}
+
+// The column of line nearest to the window x coordinate mouseX
+size_t columnAtPoint(size_t line, int mouseX) {
+    std::string_view text = buffer.lineView(line, lineScratch);
+    return lineLayout(line, text).columnAt(mouseX - EDITOR_TEXT_X);
+}
+
+// --------- Buffer Editing ---------
+// Every change to the document ends up in applyEdit. insertText and
+// eraseText also record the change in the undo history; undo and redo call
+// applyEdit directly.
+void applyEdit(size_t offset, size_t count, std::string_view text) {
+    size_t firstLine = buffer.lineOf(offset);
+    size_t removedLines = buffer.lineOf(offset + count) - firstLine + 1;
+    size_t insertedLines = std::count(text.begin(), text.end(), '\n') + 1;
+
+    if (count > 0) buffer.erase(offset, count);
+    if (!text.empty()) buffer.insert(offset, text);
+    journal.record(offset, count, text);
+
+    highlighter.onEdit(firstLine, removedLines, insertedLines);
+    search.onEdit(firstLine, removedLines, insertedLines);
+    identifiers.onEdit(firstLine, removedLines, insertedLines);
+    layouts.onEdit(firstLine, removedLines, insertedLines);
+    scheduleSyntaxCheck();
+}
+
+void insertText(size_t offset, std::string_view text, EditKind kind) {
+    history.record(offset, std::string_view(), text, cursorOffset(), kind);
+    applyEdit(offset, 0, text);
+}
+
+void eraseText(size_t offset, size_t count, EditKind kind) {
+    std::string removed = buffer.substr(offset, count);
+    history.record(offset, removed, std::string_view(), cursorOffset(), kind);
+    applyEdit(offset, count, std::string_view());
+}
+
+// Erase and insert as a single edit and a single undo step
+void replaceRange(size_t offset, size_t count, std::string_view text) {
+    std::string removed = buffer.substr(offset, count);
+    history.record(offset, removed, text, cursorOffset(), EditKind::Other);
+    applyEdit(offset, count, text);
+}
+
+// --------- Selection ---------
+// The selection runs from the anchor (selectionStartLine, selectionStartPos)
+// to the cursor, in either direction
+bool hasSelection() {
+    return selecting && selectionStartLine != -1 &&
+           (selectionStartLine != currentLine || selectionStartPos != cursorPos);
+}
+
+// Offsets of the earlier and the later end of the selection
+void selectionRange(size_t& start, size_t& end) {
+    int anchorLine = std::max(0, std::min(selectionStartLine, lineCount() - 1));
+    size_t anchor = buffer.offsetOf(anchorLine, std::max(0, selectionStartPos));
+    size_t cursor = cursorOffset();
+    start = std::min(anchor, cursor);
+    end = std::max(anchor, cursor);
+}
+
+void clearSelection() {
+    if (selecting) markDirty(DIRTY_EDITOR | DIRTY_STATUS);
+    selecting = false;
+    selectionStartLine = selectionStartPos = -1;
+}
+
+// Removes exactly the selected text, as one edit, and leaves the cursor
+// where it began
+void deleteSelection() {
+    size_t start, end;
+    selectionRange(start, end);
+    clearSelection();
+    eraseText(start, end - start);
+    moveCursorTo(start);
+}
+
+// --------- Clipboard Function ---------
+// Copies the selected characters, or the cursor line when nothing is
+// selected. The text is gathered in one pass into a string sized up front.
+void copySelection() {
+    std::string copied;
+    if (hasSelection()) {
+        size_t start, end;
+        selectionRange(start, end);
+        copied = buffer.substr(start, end - start);
+    } else {
+        copied = buffer.lineText(currentLine);
+    }
+    SDL_SetClipboardText(copied.c_str());
+}
+
+// Clipboard text with Windows and old Mac line endings turned into \n
+static std::string clipboardLines(const char* text) {
+    size_t length = strlen(text);
+    if (!std::memchr(text, '\r', length)) return std::string(text, length);
+    std::string lines;
+    lines.reserve(length);
+    for (size_t i = 0; i < length; i++) {
+        if (text[i] != '\r') {
+            lines += text[i];
+        } else if (i + 1 >= length || text[i + 1] != '\n') {
+            lines += '\n';
+        }
+    }
+    return lines;
+}
+
+// The whole clipboard goes into the buffer as a single edit, replacing the
+// selection, so however many lines it holds it is one undo step and the
+// line index and per-line caches are updated once
+void pasteClipboard() {
+    TRACE_SCOPE("pasteClipboard");
+    if (!SDL_HasClipboardText()) return;
+    char* clipboard = SDL_GetClipboardText();
+    std::string text = clipboardLines(clipboard);
+    SDL_free(clipboard);
+
+    size_t start = cursorOffset(), end = start;
+    if (hasSelection()) selectionRange(start, end);
+    clearSelection();
+    replaceRange(start, end - start, text);
+    moveCursorTo(start + text.size());
+}
+
+// --------- Scrolling ---------
+int visibleLineCount() {
+    return EDITOR_HEIGHT / LINE_HEIGHT;
+}
+
+void clampScroll() {
+    int maxScroll = std::max(0, lineCount() * LINE_HEIGHT - EDITOR_HEIGHT);
+    scrollOffset = std::max(0, std::min(scrollOffset, maxScroll));
+}
+
+// Scrolls just far enough that the cursor line is fully on screen
+void ensureCursorVisible() {
+    int cursorTop = currentLine * LINE_HEIGHT;
+    if (cursorTop < scrollOffset) {
+        scrollOffset = cursorTop;
+    } else if (cursorTop + LINE_HEIGHT > scrollOffset + EDITOR_HEIGHT) {
+        scrollOffset = cursorTop + LINE_HEIGHT - EDITOR_HEIGHT;
+    }
+    clampScroll();
+}
+
+// --------- Mouse Handling ---------
+void handleMouseInput(SDL_Event& e) {
+    if (e.type == SDL_MOUSEWHEEL) {
+        int mouseX, mouseY;
+        SDL_GetMouseState(&mouseX, &mouseY);
+        if (mouseY >= ERROR_PANEL_RECT.y && mouseY < ERROR_PANEL_RECT.y + ERROR_PANEL_HEIGHT) {
+            scrollConsole(-e.wheel.y * WHEEL_SCROLL_LINES);
+            return;
+        }
+        scrollOffset -= e.wheel.y * WHEEL_SCROLL_LINES * LINE_HEIGHT;
+        clampScroll();
+        markDirty(DIRTY_EDITOR | DIRTY_GUTTER);
+    } else if (e.type == SDL_MOUSEBUTTONDOWN) {
+        int mouseX = e.button.x;
+        int mouseY = e.button.y;
+        bool inEditor = mouseX >= GUTTER_WIDTH && mouseX < SCREEN_WIDTH - RIGHT_SIDEBAR_WIDTH && mouseY < EDITOR_HEIGHT;
+        int clickedLine = (mouseY + scrollOffset) / LINE_HEIGHT;
+        if (mouseY >= ERROR_PANEL_RECT.y && mouseY < ERROR_PANEL_RECT.y + ERROR_PANEL_HEIGHT) {
+            clickErrorPanel(mouseY);
+            return;
+        }
+        if (mouseX < GUTTER_WIDTH && mouseY < EDITOR_HEIGHT) {
+            if (const Diagnostic* diagnostic = editorDiagnostics().lineDiagnostic(clickedLine)) {
+                jumpToDiagnostic(*diagnostic);
+                return;
+            }
+        }
+        if (inEditor && clickedLine < lineCount()) {
+            // The click lands on the nearest character boundary and anchors
+            // a selection that dragging extends
+            currentLine = clickedLine;
+            cursorPos = (int)columnAtPoint(currentLine, mouseX);
+            selecting = true;
+            dragging = true;
+            selectionStartLine = currentLine;
+            selectionStartPos = cursorPos;
+            markDirty(DIRTY_EDITOR | DIRTY_STATUS);
+        }
+
+        for (auto& button : buttons) {
+            if (mouseX >= button.rect.x && mouseX <= button.rect.x + button.rect.w &&
+                mouseY >= button.rect.y && mouseY <= button.rect.y + button.rect.h) {
+                button.action();
+                markDirty(DIRTY_ALL);
+                return;
+            }
+        }
+    } else if (e.type == SDL_MOUSEMOTION && dragging) {
+        int line = std::max(0, std::min((e.motion.y + scrollOffset) / LINE_HEIGHT, lineCount() - 1));
+        int column = (int)columnAtPoint(line, e.motion.x);
+        if (line != currentLine || column != cursorPos) {
+            currentLine = line;
+            cursorPos = column;
+            markDirty(DIRTY_EDITOR | DIRTY_STATUS);
+        }
+    } else if (e.type == SDL_MOUSEBUTTONUP) {
+        // A drag leaves its selection behind; a plain click does not
+        dragging = false;
+        selecting = selectionStartLine != -1 && (selectionStartLine != currentLine || selectionStartPos != cursorPos);
+        markDirty(DIRTY_EDITOR | DIRTY_STATUS);
+    }
+}
+
+// --------- Status Bar Rendering ---------
+void renderStatusBar() {
+    TRACE_SCOPE("renderStatusBar");
+    SDL_SetRenderDrawColor(renderer, 100, 100, 100, 255);
+    SDL_RenderFillRect(renderer, &STATUS_BAR_RECT);
+
+    std::string status = "Line: " + std::to_string(currentLine + 1) + ", Pos: " + std::to_string(cursorPos);
+    if (hasSelection()) {
+        status += " [SELECTING]";
+    }
+    if (!saveStatus.empty()) {
+        status += "   " + saveStatus;
+    }
+    // What the compiler said about the cursor line
+    if (const Diagnostic* diagnostic = editorDiagnostics().lineDiagnostic(currentLine)) {
+        std::string message = diagnostic->message;
+        if (message.size() > 80) message = message.substr(0, 77) + "...";
+        status += "   " + message;
+    }
+    SDL_Color statusColor = {255, 255, 255, 255};
+    textAtlas.drawText(status, 10, SCREEN_HEIGHT + 2, statusColor);
+
+    // Build progress on the right, with a live timer while a job runs
+    std::string progress = buildStatus;
+    if (checkInFlight) progress = "Checking...   " + progress;
+    if (buildJob.running()) {
+        char elapsed[32];
+        std::snprintf(elapsed, sizeof(elapsed), " %.1fs", buildJob.elapsedSeconds());
+        progress += elapsed;
+    }
+    if (!progress.empty()) {
+        int progressWidth = textAtlas.textWidth(progress);
+        textAtlas.drawText(progress, SCREEN_WIDTH - progressWidth - 10, SCREEN_HEIGHT + 2, statusColor);
+    }
+}
+
+// --------- Sidebar Rendering ---------
+static SDL_Color severityColor(Severity severity) {
+    switch (severity) {
+    case Severity::Error:   return {230, 70, 70, 255};
+    case Severity::Warning: return {230, 190, 60, 255};
+    case Severity::Note:    return {90, 150, 230, 255};
+    default:                return {255, 255, 255, 255};
+    }
+}
+
+void renderSidebar() {
+    TRACE_SCOPE("renderSidebar");
+    SDL_SetRenderDrawColor(renderer, 50, 50, 50, 255); // Dark gray
+    SDL_RenderFillRect(renderer, &GUTTER_RECT);
+
+    SDL_Color textColor = {255, 255, 255, 255};  // White text
+    size_t firstLine = scrollOffset / LINE_HEIGHT;
+    size_t lastLine = std::min(buffer.lineCount(), (size_t)((scrollOffset + EDITOR_HEIGHT) / LINE_HEIGHT + 1));
+    int y = (int)firstLine * LINE_HEIGHT - scrollOffset;
+    bool heatmap = showProfile && profileMax > 0;
+    for (size_t i = firstLine; i < lastLine; i++, y += LINE_HEIGHT) {
+        std::string lineNumber = std::to_string(i + 1);
+
+        // Profiled lines are tinted toward red by their cost and show their
+        // share of it instead of a number
+        uint64_t cost = heatmap && i < profileCost.size() ? profileCost[i] : 0;
+        if (cost > 0) {
+            double heat = (double)cost / profileMax;
+            SDL_Rect row = {0, y, GUTTER_WIDTH, LINE_HEIGHT};
+            SDL_SetRenderDrawColor(renderer, (Uint8)(50 + 150 * heat), (Uint8)(50 + 10 * heat), (Uint8)(50 - 20 * heat), 255);
+            SDL_RenderFillRect(renderer, &row);
+            double share = 100.0 * cost / profileTotal;
+            char text[16];
+            std::snprintf(text, sizeof(text), share < 1.0 ? "%.1f%%" : "%.0f%%", share);
+            lineNumber = text;
+        }
+        int textWidth = textAtlas.textWidth(lineNumber);
+        textAtlas.queueText(lineNumber, 30 - textWidth / 2, y + 5, textColor);
+
+        // Severity marker for lines the last build reported on
+        Severity severity = editorDiagnostics().lineSeverity(i);
+        if (severity != Severity::None) {
+            SDL_Color color = severityColor(severity);
+            SDL_Rect marker = {4, y + 10, 8, 8};
+            SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, 255);
+            SDL_RenderFillRect(renderer, &marker);
+        }
+    }
+    textAtlas.flush();
+}
+
+void renderRightSidebar() {
+    TRACE_SCOPE("renderRightSidebar");
+    SDL_SetRenderDrawColor(renderer, 50, 50, 50, 255);  // Dark Gray
+    SDL_RenderFillRect(renderer, &RIGHT_SIDEBAR_RECT);
+
+    SDL_Color textColor = {255, 255, 255, 255};  // White text
+
+    for (const auto& button : buttons) {
+        SDL_SetRenderDrawColor(renderer, 70, 70, 70, 255);
+        SDL_RenderFillRect(renderer, &button.rect);
+
+        int textWidth = textAtlas.textWidth(button.label);
+        textAtlas.drawText(button.label, button.rect.x + (button.rect.w - textWidth) / 2, button.rect.y + 10, textColor);
+    }
+}
+
+// --------- Frame Rendering ---------
+// Repaints only the regions marked dirty into the back buffer, each clipped
+// to its own rectangle, then presents. Idle frames cost nothing.
+void renderFrame() {
+    unsigned dirty = takeDirty();
+    if (dirty == DIRTY_NONE) return;
+    TRACE_SCOPE("renderFrame");
+    Uint64 frameStart = SDL_GetPerformanceCounter();
+    uint64_t uploadsBefore = textAtlas.uploadCount();
+
+    if (frameTexture) {
+        SDL_SetRenderTarget(renderer, frameTexture);
+    } else {
+        dirty = DIRTY_ALL;
+    }
+
+    if (dirty & DIRTY_EDITOR) {
+        SDL_RenderSetClipRect(renderer, &EDITOR_RECT);
+        renderTextEditor();
+    }
+    if (dirty & DIRTY_GUTTER) {
+        SDL_RenderSetClipRect(renderer, &GUTTER_RECT);
+        renderSidebar();
+    }
+    if (dirty & DIRTY_SIDEBAR) {
+        SDL_RenderSetClipRect(renderer, &RIGHT_SIDEBAR_RECT);
+        renderRightSidebar();
+    }
+    if (dirty & DIRTY_ERRORS) {
+        SDL_RenderSetClipRect(renderer, &ERROR_PANEL_RECT);
+        renderErrorPanel();
+    }
+    if (dirty & DIRTY_STATUS) {
+        SDL_RenderSetClipRect(renderer, &STATUS_BAR_RECT);
+        renderStatusBar();
+    }
+    SDL_RenderSetClipRect(renderer, nullptr);
+
+    if (frameTexture) {
+        SDL_SetRenderTarget(renderer, nullptr);
+        SDL_RenderCopy(renderer, frameTexture, nullptr, nullptr);
+    }
+
+    // Drawn over the presented frame only, so it never lands in the back buffer
+    if (showOverlay) renderOverlay();
+    lastFrameMs = (SDL_GetPerformanceCounter() - frameStart) * 1000.0 / SDL_GetPerformanceFrequency();
+    lastFrameUploads = textAtlas.uploadCount() - uploadsBefore;
+
+    TRACE_SCOPE("present");
+    SDL_RenderPresent(renderer);
+}
+
+// --------- Performance Overlay ---------
+// Shows the previous frame's numbers; they describe a finished frame
+void renderOverlay() {
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 190);
+    SDL_RenderFillRect(renderer, &OVERLAY_RECT);
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+
+    char lines[4][96];
+    std::snprintf(lines[0], sizeof(lines[0]), "Frame %.2f ms, %llu uploads", lastFrameMs,
+                  (unsigned long long)lastFrameUploads);
+    std::snprintf(lines[1], sizeof(lines[1]), "Buffer %.1f MB, undo %.1f MB", buffer.memoryUsage() / 1048576.0,
+                  history.memoryUsage() / 1048576.0);
+    double compileSeconds = lastCompileSeconds.load();
+    if (compileSeconds < 0) {
+        std::snprintf(lines[2], sizeof(lines[2]), "Last compile: none");
+    } else {
+        std::snprintf(lines[2], sizeof(lines[2]), "Last compile %.2fs", compileSeconds);
+    }
+    std::snprintf(lines[3], sizeof(lines[3]), "Tracing %s (F4)", traceEnabled.load() ? "on" : "off");
+
+    SDL_Color overlayColor = {120, 255, 120, 255};
+    int y = OVERLAY_RECT.y + 5;
+    for (const char* line : lines) {
+        textAtlas.queueText(line, OVERLAY_RECT.x + 10, y, overlayColor);
+        y += 24;
+    }
+    textAtlas.flush();
+}
+
+// Starts a trace, or stops it and writes everything recorded to TRACE_FILE
+void toggleTracing() {
+    if (!traceEnabled.load()) {
+        setTracing(true);
+        saveStatus = "Tracing...";
+    } else {
+        setTracing(false);
+        std::string error;
+        long events = writeChromeTrace(TRACE_FILE, error);
+        if (events < 0) {
+            saveStatus = "Trace failed: " + error;
+            std::cerr << error << std::endl;
+        } else {
+            saveStatus = "Trace written to " + TRACE_FILE + " (" + std::to_string(events) + " events)";
+            std::cout << saveStatus << std::endl;
+        }
+    }
+    markDirty(DIRTY_STATUS);
+}
+
+// --------- Syntax Colors ---------
+SDL_Color tokenColor(TokenType type) {
+    switch (type) {
+    case TokenType::Keyword:      return SDL_Color{255, 0, 0, 255};  // Red keywords
+    case TokenType::Number:       return darkMode ? SDL_Color{181, 206, 168, 255} : SDL_Color{9, 134, 88, 255};
+    case TokenType::String:
+    case TokenType::Char:         return darkMode ? SDL_Color{206, 145, 120, 255} : SDL_Color{163, 21, 21, 255};
+    case TokenType::Comment:      return darkMode ? SDL_Color{106, 153, 85, 255} : SDL_Color{0, 128, 0, 255};
+    case TokenType::Preprocessor: return darkMode ? SDL_Color{197, 134, 192, 255} : SDL_Color{175, 0, 219, 255};
+    case TokenType::Identifier:
+    case TokenType::Text:
+    default:
+        // White text in dark mode, black in light mode
+        return darkMode ? SDL_Color{255, 255, 255, 255} : SDL_Color{0, 0, 0, 255};
+    }
+}
+
+// --------- Text Rendering ---------
+void renderTextEditor() {
+    TRACE_SCOPE("renderTextEditor");
+    if (darkMode) {
+        SDL_SetRenderDrawColor(renderer, 30, 30, 30, 255);  // Dark mode
+    } else {
+        SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);  // Light mode
+    }
+    SDL_RenderFillRect(renderer, &EDITOR_RECT);
+
+    // Only the lines inside the viewport are drawn
+    size_t firstLine = scrollOffset / LINE_HEIGHT;
+    size_t lastLine = std::min(buffer.lineCount(), (size_t)((scrollOffset + EDITOR_HEIGHT) / LINE_HEIGHT + 1));
+    int y = (int)firstLine * LINE_HEIGHT - scrollOffset;
+
+    if (findOpen) search.refresh(buffer);
+
+    // The selection from its earlier end to its later one
+    bool selectionShown = hasSelection();
+    std::pair<int, int> selectionFrom = {selectionStartLine, selectionStartPos}, selectionTo = {currentLine, cursorPos};
+    if (selectionTo < selectionFrom) std::swap(selectionFrom, selectionTo);
+    const int textRight = EDITOR_RECT.x + EDITOR_RECT.w - EDITOR_TEXT_X;  // Right edge of the view, in text coordinates
+
+    for (size_t i = firstLine; i < lastLine; i++, y += LINE_HEIGHT) {
+        std::string_view line = buffer.lineView(i, lineScratch);
+        highlighter.highlight(buffer, i, line, lineSpans);
+        const LineLayout& layout = lineLayout(i, line);
+
+        if (selectionShown && (int)i >= selectionFrom.first && (int)i <= selectionTo.first) {
+            // Lines the selection runs past get a little extra for the line break
+            int from = (int)i == selectionFrom.first ? layout.columnX(selectionFrom.second) : 0;
+            int to = (int)i == selectionTo.first ? layout.columnX(selectionTo.second) : layout.width() + 8;
+            SDL_Rect mark = {EDITOR_TEXT_X + from, y, std::min(to, textRight) - from, LINE_HEIGHT};
+            SDL_SetRenderDrawColor(renderer, darkMode ? 38 : 173, darkMode ? 79 : 214, darkMode ? 120 : 255, 255);
+            if (mark.w > 0) SDL_RenderFillRect(renderer, &mark);
+        }
+
+        // Search matches are marked behind the text
+        for (const SearchMatch& match : search.lineMatches(i)) {
+            bool current = findHasCurrent && i == findLine && match.column == findCurrent.column;
+            int matchX = layout.columnX(match.column);
+            SDL_Rect mark = {EDITOR_TEXT_X + matchX, y + 2, std::max(2, layout.columnX(match.column + match.length) - matchX),
+                             LINE_HEIGHT - 4};
+            if (current) {
+                SDL_SetRenderDrawColor(renderer, 215, 140, 30, 255);
+            } else if (darkMode) {
+                SDL_SetRenderDrawColor(renderer, 90, 80, 40, 255);
+            } else {
+                SDL_SetRenderDrawColor(renderer, 250, 230, 140, 255);
+            }
+            SDL_RenderFillRect(renderer, &mark);
+        }
+
+        // Plain text between the highlighted spans keeps the default color.
+        // Characters past the right edge of the view are not drawn.
+        std::string_view visible = line.substr(0, layout.visibleEnd(textRight));
+        SDL_Color textColor = tokenColor(TokenType::Text);
+        int x = EDITOR_TEXT_X;
+        size_t pos = 0;
+        for (const TokenSpan& span : lineSpans) {
+            if (span.start >= visible.size()) break;
+            if (span.start > pos) {
+                x = textAtlas.queueText(visible.substr(pos, span.start - pos), x, y, textColor);
+            }
+            x = textAtlas.queueText(visible.substr(span.start, span.length), x, y, tokenColor(span.type));
+            pos = std::min<size_t>(span.start + span.length, visible.size());
+        }
+        if (pos < visible.size()) {
+            textAtlas.queueText(visible.substr(pos), x, y, textColor);
+        }
+        textAtlas.flush();
+
+        // Cursor rendering
+        if (i == (size_t)currentLine) {
+            int cursorX = EDITOR_TEXT_X + layout.columnX(cursorPos);
+            SDL_SetRenderDrawColor(renderer, darkMode ? 255 : 0, darkMode ? 255 : 0, darkMode ? 255 : 0, 255);  // White cursor in dark mode, black in light mode
+            SDL_RenderDrawLine(renderer, cursorX, y + 5, cursorX, y + 25);
+        }
+    }
+
+    if (completionOpen) renderCompletionPopup();
+    if (findOpen) renderFindBar();
+}
+
+
+
+// --------- Save File Function ---------
+// Hands a snapshot of the document to the save queue, which writes it to a
+// temporary file on its own thread and renames it into place. The editor
+// carries on immediately; pollSaveQueue reports the outcome.
+void saveToFile(const std::string& filename) {
+    TRACE_SCOPE("saveToFile");
+#ifdef _WIN32
+    // Windows cannot replace a file that is still mapped, so the text is
+    // copied into memory first
+    if (!mappedPath.empty() && filename == mappedPath) {
+        buffer.setText(buffer.text());
+        mappedPath.clear();
+    }
+#endif
+    saveQueue.save(filename, buffer.snapshot());
+    savedVersions[filename] = editVersion;
+    saveStatus = "Saving " + filename + "...";
+    markDirty(DIRTY_STATUS);
+}
+
+void pollSaveQueue() {
+    static std::vector<SaveResult> results;
+    results.clear();
+    saveQueue.poll(results);
+
+    for (const SaveResult& result : results) {
+        if (result.ok) {
+            saveStatus = "Saved " + result.path + " (" + std::to_string((result.bytes + 1023) / 1024) + " KB)";
+            std::cout << "Saved " << result.path << " in " << result.seconds << "s" << std::endl;
+
+            // Unedited since, the saved file holds the document and the journal
+            // can refer to it. Otherwise, if the journal referred to this file,
+            // it has to start over from the text it can no longer find there.
+            auto saved = savedVersions.find(result.path);
+            if (saved != savedVersions.end() && saved->second == editVersion) {
+                journal.checkpoint(buffer.snapshot(), result.path);
+            } else if (result.path == journal.sourceFile()) {
+                journal.checkpoint(buffer.snapshot());
+            }
+        } else {
+            saveStatus = "Save failed: " + result.error;
+            std::cerr << "Error saving file: " << result.error << std::endl;
+        }
+        markDirty(DIRTY_STATUS);
+    }
+}
+
+// --------- Crash Recovery ---------
+// Restores the document of a session that ended without close(), then starts
+// this session's journal from whatever the editor holds
+void recoverSession() {
+    JournalRecovery recovery;
+    std::string error;
+    if (EditJournal::recover(JOURNAL_DIR, recovery, error)) {
+        buffer.setText(std::move(recovery.text));
+        mappedPath.clear();
+        highlighter.reset(buffer.lineCount());
+        search.reset(buffer.lineCount());
+        identifiers.reset(buffer.lineCount(), IDENTIFIER_INDEX_MAX_LINES);
+        layouts.clear();
+        history.clear();
+        scheduleSyntaxCheck();
+        console.append("Recovered the unsaved document of the last session (" + std::to_string(recovery.edits) +
+                       " edits replayed" + (recovery.truncated ? ", a partly written batch dropped" : "") + ")");
+        std::cout << "Recovered " << buffer.length() << " bytes from " << JOURNAL_DIR << std::endl;
+        markDirty(DIRTY_ALL);
+    } else if (!error.empty()) {
+        console.append("Error: could not recover the last session: " + error);
+        markDirty(DIRTY_ERRORS);
+    }
+    journal.checkpoint(buffer.snapshot());
+}
+
+// Folds the edit log into a new snapshot once it outgrows half the document,
+// which keeps both the log and the replay after a crash bounded
+void pollJournal() {
+    if (journal.loggedBytes() > std::max(JOURNAL_COMPACT_MIN_BYTES, buffer.length() / 2)) {
+        journal.checkpoint(buffer.snapshot());
+    }
+}
+
+// --------- Load From File Function ---------
+// Large files are mapped rather than read: the buffer points straight into
+// the mapping, so only the newline index is built up front and lines are
+// paged in when they are drawn. Edits go to the buffer's own chunks and
+// never touch the mapping.
+void loadFromFile(const std::string& filename) {
+    TRACE_SCOPE("loadFromFile");
+    saveQueue.flush();  // A save still in flight may be for this very file
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if (!file) {
+        std::cerr << "Error opening file: " << filename << std::endl;
+        return;
+    }
+    size_t size = (size_t)file.tellg();
+
+    if (size >= LARGE_FILE_BYTES) {
+        file.close();
+        auto mapped = std::make_shared<MappedFile>();
+        std::string error;
+        if (!mapped->open(filename, error)) {
+            std::cerr << error << std::endl;
+            return;
+        }
+        mapped->adviseSequential(true);  // The newline scan reads it front to back
+        buffer.setExternal(mapped, mapped->data(), mapped->size());
+        mapped->adviseSequential(false);
+        mappedPath = filename;
+        std::cout << "Mapped " << filename << " (" << size / (1024 * 1024) << " MB, "
+                  << buffer.lineCount() << " lines)" << std::endl;
+    } else {
+        std::string content(size, '\0');
+        file.seekg(0);
+        file.read(&content[0], content.size());
+        file.close();
+        buffer.setText(std::move(content));
+        mappedPath.clear();
+    }
+    // A mapped file is only referred to by the journal, not copied into it
+    journal.checkpoint(buffer.snapshot(), mappedPath);
+
+    highlighter.reset(buffer.lineCount());
+    search.reset(buffer.lineCount());
+    identifiers.reset(buffer.lineCount(), IDENTIFIER_INDEX_MAX_LINES);
+    layouts.clear();
+    clearProfile();
+    closeCompletion();
+    history.clear();
+    scheduleSyntaxCheck();
+    currentLine = 0;
+    cursorPos = 0;
+    scrollOffset = 0;
+}
+
+// --------- Undo Function ---------
+void undo() {
+    TRACE_SCOPE("undo");
+    size_t cursor;
+    clearSelection();
+    if (history.undo(applyEdit, cursor)) {
+        moveCursorTo(cursor);
+    }
+}
+
+// --------- Redo Function ---------
+void redo() {
+    TRACE_SCOPE("redo");
+    size_t cursor;
+    clearSelection();
+    if (history.redo(applyEdit, cursor)) {
+        moveCursorTo(cursor);
+    }
+}
+
+// --------- Find & Replace ---------
+void openFind(bool replace) {
+    findOpen = true;
+    findReplaceMode = replace;
+    findReplaceFocus = false;
+    updateSearch();
+}
+
+void closeFind() {
+    findOpen = false;
+    findHasCurrent = false;
+    findStatus.clear();
+    search.clear();
+    markDirty(DIRTY_EDITOR);
+}
+
+// Whether the current match is still in the index after later edits
+static bool currentMatchValid() {
+    if (!findHasCurrent) return false;
+    for (const SearchMatch& match : search.lineMatches(findLine)) {
+        if (match.column == findCurrent.column && match.length == findCurrent.length) return true;
+    }
+    return false;
+}
+
+static void showCurrentMatch() {
+    currentLine = (int)findLine;
+    cursorPos = (int)findCurrent.column;
+    ensureCursorVisible();
+    markDirty(DIRTY_EDITOR | DIRTY_GUTTER | DIRTY_STATUS);
+}
+
+// Rebuilds the index for the new query or options and moves to the first
+// match at or after the cursor
+void updateSearch() {
+    TRACE_SCOPE("updateSearch");
+    std::string error;
+    findHasCurrent = false;
+    findStatus.clear();
+    if (!search.setQuery(findText, findOptions, error)) {
+        findStatus = error;
+    } else {
+        search.reset(buffer.lineCount());
+        search.refresh(buffer);
+        findHasCurrent = search.find(currentLine, cursorPos, true, findLine, findCurrent);
+        if (findHasCurrent) showCurrentMatch();
+    }
+    markDirty(DIRTY_EDITOR);
+}
+
+void findNext(bool forward) {
+    search.refresh(buffer);
+    findStatus.clear();
+    // Step off the match under the cursor so repeated presses move on
+    bool onMatch = currentMatchValid() && (size_t)currentLine == findLine && (uint32_t)cursorPos == findCurrent.column;
+    size_t column = cursorPos + (forward && onMatch ? 1 : 0);
+    findHasCurrent = search.find(currentLine, column, forward, findLine, findCurrent);
+    if (findHasCurrent) showCurrentMatch();
+    markDirty(DIRTY_EDITOR);
+}
+
+void replaceCurrent() {
+    search.refresh(buffer);
+    if (!currentMatchValid()) {
+        findNext(true);
+        return;
+    }
+    std::string_view line = buffer.lineView(findLine, lineScratch);
+    std::string replacement = search.replacementFor(line, findCurrent, replaceText);
+    size_t offset = buffer.lineStart(findLine) + findCurrent.column;
+    replaceRange(offset, findCurrent.length, replacement);
+
+    // Continue after the inserted text, which may itself match
+    moveCursorTo(offset + replacement.size());
+    search.refresh(buffer);
+    findHasCurrent = search.find(currentLine, cursorPos, true, findLine, findCurrent);
+    if (findHasCurrent) {
+        showCurrentMatch();
+    } else {
+        ensureCursorVisible();
+        markDirty(DIRTY_EDITOR | DIRTY_GUTTER | DIRTY_STATUS);
+    }
+}
+
+// Rewrites everything from the first matching line to the last one as a
+// single buffer edit, so the whole replacement is also one undo step
+void replaceAll() {
+    TRACE_SCOPE("replaceAll");
+    search.refresh(buffer);
+    size_t count = search.matchCount();
+    if (count == 0) return;
+    Uint64 start = SDL_GetPerformanceCounter();
+
+    size_t firstLine = search.lineCount(), lastLine = 0;
+    for (size_t i = 0; i < search.lineCount(); i++) {
+        if (search.lineMatches(i).empty()) continue;
+        firstLine = std::min(firstLine, i);
+        lastLine = i;
+    }
+
+    std::string replaced;
+    for (size_t i = firstLine; i <= lastLine; i++) {
+        std::string_view line = buffer.lineView(i, lineScratch);
+        const std::vector<SearchMatch>& matches = search.lineMatches(i);
+        if (matches.empty()) {
+            replaced.append(line);
+        } else {
+            search.replaceLine(line, matches, replaceText, replaced);
+        }
+        if (i < lastLine) replaced += '\n';
+    }
+    size_t from = buffer.lineStart(firstLine);
+    size_t to = buffer.lineStart(lastLine) + buffer.lineLength(lastLine);
+    replaceRange(from, to - from, replaced);
+    clampCursor();
+    findHasCurrent = false;
+
+    double ms = (SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency();
+    char status[96];
+    std::snprintf(status, sizeof(status), "Replaced %zu in %.0f ms", count, ms);
+    findStatus = status;
+    std::cout << findStatus << std::endl;
+    ensureCursorVisible();
+    markDirty(DIRTY_EDITOR | DIRTY_GUTTER | DIRTY_STATUS);
+}
+
+// Keys the find bar takes while it is open; anything else reaches the editor
+bool handleFindInput(SDL_Event& e) {
+    std::string& field = findReplaceFocus ? replaceText : findText;
+    if (e.type == SDL_TEXTINPUT) {
+        if (SDL_GetModState() & KMOD_ALT) return true;  // Text of an Alt+C/W/R toggle
+        field += e.text.text;
+        if (findReplaceFocus) {
+            markDirty(DIRTY_EDITOR);
+        } else {
+            updateSearch();
+        }
+        return true;
+    }
+    if (e.type != SDL_KEYDOWN) return false;
+
+    SDL_Keycode key = e.key.keysym.sym;
+    SDL_Keymod mods = SDL_GetModState();
+    if (key == SDLK_ESCAPE) {
+        closeFind();
+    } else if (key == SDLK_BACKSPACE) {
+        // Drop a whole UTF-8 sequence
+        while (!field.empty() && ((unsigned char)field.back() & 0xC0) == 0x80) field.pop_back();
+        if (!field.empty()) field.pop_back();
+        if (findReplaceFocus) {
+            markDirty(DIRTY_EDITOR);
+        } else {
+            updateSearch();
+        }
+    } else if (key == SDLK_TAB && findReplaceMode) {
+        findReplaceFocus = !findReplaceFocus;
+        markDirty(DIRTY_EDITOR);
+    } else if (key == SDLK_RETURN || key == SDLK_KP_ENTER) {
+        if (findReplaceMode && (mods & KMOD_CTRL)) {
+            replaceAll();  // Ctrl+Enter
+        } else if (findReplaceFocus) {
+            replaceCurrent();
+        } else {
+            findNext(!(mods & KMOD_SHIFT));  // Shift+Enter goes backwards
+        }
+    } else if ((mods & KMOD_ALT) && (key == SDLK_c || key == SDLK_w || key == SDLK_r)) {
+        if (key == SDLK_c) findOptions.caseSensitive = !findOptions.caseSensitive;
+        if (key == SDLK_w) findOptions.wholeWord = !findOptions.wholeWord;
+        if (key == SDLK_r) findOptions.regex = !findOptions.regex;
+        updateSearch();
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// --------- Find Bar Rendering ---------
+// Drawn along the bottom of the editor, inside the editor region
+void renderFindBar() {
+    int rows = findReplaceMode ? 2 : 1;
+    SDL_Rect bar = {EDITOR_RECT.x, EDITOR_HEIGHT - rows * FIND_ROW_HEIGHT, EDITOR_RECT.w, rows * FIND_ROW_HEIGHT};
+    SDL_SetRenderDrawColor(renderer, 60, 60, 60, 255);
+    SDL_RenderFillRect(renderer, &bar);
+
+    SDL_Color labelColor = {180, 180, 180, 255};
+    SDL_Color textColor = {255, 255, 255, 255};
+    SDL_Color onColor = {120, 200, 255, 255};
+    SDL_Color offColor = {110, 110, 110, 255};
+    const int fieldX = bar.x + 110;
+
+    for (int row = 0; row < rows; row++) {
+        int y = bar.y + row * FIND_ROW_HEIGHT + 2;
+        bool replaceRow = row == 1;
+        textAtlas.drawText(replaceRow ? "Replace:" : "Find:", bar.x + 10, y, labelColor);
+        int end = textAtlas.drawText(replaceRow ? replaceText : findText, fieldX, y, textColor);
+        if (replaceRow == findReplaceFocus) {
+            SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+            SDL_RenderDrawLine(renderer, end + 1, y + 3, end + 1, y + 23);
+        }
+    }
+
+    // Options and match count on the right of the find row
+    int y = bar.y + 2;
+    int x = bar.x + bar.w - 10;
+    const std::pair<const char*, bool> toggles[] = {
+        {".*", findOptions.regex}, {"W", findOptions.wholeWord}, {"Aa", findOptions.caseSensitive}};
+    for (const auto& toggle : toggles) {
+        x -= textAtlas.textWidth(toggle.first);
+        textAtlas.drawText(toggle.first, x, y, toggle.second ? onColor : offColor);
+        x -= 12;
+    }
+
+    std::string status = findStatus;
+    if (status.empty() && search.active()) {
+        if (search.matchCount() == 0) {
+            status = "No results";
+        } else if (currentMatchValid()) {
+            status = std::to_string(search.matchIndex(findLine, findCurrent.column) + 1) + " of " +
+                     std::to_string(search.matchCount());
+        } else {
+            status = std::to_string(search.matchCount()) + " matches";
+        }
+    }
+    if (!status.empty()) {
+        x -= textAtlas.textWidth(status) + 10;
+        textAtlas.drawText(status, x, y, labelColor);
+    }
+}
+
+// --------- Completion ---------
+// Suggestions for the identifier that ends at the cursor, from the words of
+// the document and the built-in names
+void updateCompletion() {
+    TRACE_SCOPE("updateCompletion");
+    std::string_view line = buffer.lineView(currentLine, lineScratch);
+    size_t end = std::min((size_t)cursorPos, line.size());
+    size_t start = end;
+    while (start > 0 && (std::isalnum((unsigned char)line[start - 1]) || line[start - 1] == '_')) start--;
+    std::string prefix(line.substr(start, end - start));
+    // Inside an identifier the index already holds the whole word, which
+    // would be offered back with the text right of the cursor repeated
+    bool insideWord = end < line.size() && (std::isalnum((unsigned char)line[end]) || line[end] == '_');
+    if (prefix.size() < COMPLETION_MIN_PREFIX || std::isdigit((unsigned char)prefix[0]) || insideWord) {
+        closeCompletion();
+        return;
+    }
+
+    identifiers.refresh(buffer, IDENTIFIER_INDEX_BUDGET_MS);  // Picks up the line being typed on
+    identifiers.complete(prefix, COMPLETION_ROWS, completions);
+    completionPrefixLength = prefix.size();
+    completionSelected = 0;
+    completionChosen = false;
+    completionOpen = !completions.empty();
+    markDirty(DIRTY_EDITOR);
+}
+
+void closeCompletion() {
+    if (!completionOpen) return;
+    completionOpen = false;
+    completions.clear();
+    markDirty(DIRTY_EDITOR);
+}
+
+// Types the rest of the selected word
+void acceptCompletion() {
+    std::string rest = completions[completionSelected].word.substr(completionPrefixLength);
+    closeCompletion();
+    insertText(cursorOffset(), rest);
+    cursorPos += (int)rest.size();
+    ensureCursorVisible();
+    markDirty(DIRTY_EDITOR | DIRTY_STATUS);
+}
+
+// Up and Down pick a suggestion, Tab inserts it and Escape closes the list.
+// Enter inserts a suggestion only once Up or Down picked it; otherwise it
+// closes the list and starts a new line, since the list opens for any word
+// that happens to be a prefix of a known name. Other keys and clicks close
+// the list and then do what they normally do.
+bool handleCompletionInput(SDL_Event& e) {
+    if (e.type == SDL_MOUSEBUTTONDOWN) closeCompletion();
+    if (e.type != SDL_KEYDOWN) return false;
+
+    switch (e.key.keysym.sym) {
+    case SDLK_UP:
+        completionSelected = (completionSelected + completions.size() - 1) % completions.size();
+        completionChosen = true;
+        break;
+    case SDLK_DOWN:
+        completionSelected = (completionSelected + 1) % completions.size();
+        completionChosen = true;
+        break;
+    case SDLK_RETURN:
+    case SDLK_KP_ENTER:
+        if (!completionChosen) {
+            closeCompletion();
+            return false;
+        }
+        acceptCompletion();
+        return true;
+    case SDLK_TAB:
+        acceptCompletion();
+        return true;
+    case SDLK_ESCAPE:
+        closeCompletion();
+        return true;
+    case SDLK_BACKSPACE:       // The list follows the shorter prefix
+    case SDLK_LSHIFT:
+    case SDLK_RSHIFT:
+    case SDLK_CAPSLOCK:
+        return false;
+    default:
+        // A printable key is followed by its text, which decides whether
+        // the list stays open
+        SDL_Keycode key = e.key.keysym.sym;
+        if (key < 128 && std::isprint((int)key) && !(SDL_GetModState() & (KMOD_CTRL | KMOD_ALT))) return false;
+        closeCompletion();
+        return false;
+    }
+    markDirty(DIRTY_EDITOR);
+    return true;
+}
+
+// Indexes a newly opened document a slice at a time between frames, and
+// the lines touched by edits as they come
+void pollIdentifierIndex() {
+    if (!identifiers.pending()) return;
+    TRACE_SCOPE("pollIdentifierIndex");
+    if (!identifiers.refresh(buffer, IDENTIFIER_INDEX_BUDGET_MS)) scheduleWake(0);
+}
+
+// --------- Completion Popup Rendering ---------
+// Lined up with the start of the word, below the cursor line or above it
+// when there is no room underneath
+void renderCompletionPopup() {
+    std::string_view line = buffer.lineView(currentLine, lineScratch);
+    size_t wordStart = std::min((size_t)cursorPos, line.size()) - std::min((size_t)cursorPos, completionPrefixLength);
+    int width = 180;
+    for (const Completion& completion : completions) {
+        width = std::max(width, textAtlas.textWidth(completion.word) + 70);
+    }
+    int height = (int)completions.size() * COMPLETION_ROW_HEIGHT + 4;
+    int lineTop = currentLine * LINE_HEIGHT - scrollOffset;
+
+    SDL_Rect popup = {EDITOR_TEXT_X + lineLayout(currentLine, line).columnX(wordStart), lineTop + LINE_HEIGHT, width,
+                      height};
+    if (popup.y + popup.h > EDITOR_HEIGHT) popup.y = std::max(0, lineTop - height);
+    popup.x = std::max(EDITOR_RECT.x, std::min(popup.x, EDITOR_RECT.x + EDITOR_RECT.w - width - 2));
+
+    SDL_SetRenderDrawColor(renderer, darkMode ? 45 : 245, darkMode ? 45 : 245, darkMode ? 48 : 245, 255);
+    SDL_RenderFillRect(renderer, &popup);
+    SDL_SetRenderDrawColor(renderer, 110, 110, 110, 255);
+    SDL_RenderDrawRect(renderer, &popup);
+
+    SDL_Color textColor = darkMode ? SDL_Color{230, 230, 230, 255} : SDL_Color{20, 20, 20, 255};
+    SDL_Color prefixColor = darkMode ? SDL_Color{120, 200, 255, 255} : SDL_Color{0, 90, 170, 255};
+    SDL_Color countColor = {130, 130, 130, 255};
+    int y = popup.y + 2;
+    for (size_t i = 0; i < completions.size(); i++, y += COMPLETION_ROW_HEIGHT) {
+        if (i == completionSelected) {
+            SDL_Rect row = {popup.x + 1, y, popup.w - 2, COMPLETION_ROW_HEIGHT};
+            SDL_SetRenderDrawColor(renderer, darkMode ? 38 : 200, darkMode ? 79 : 220, darkMode ? 120 : 245, 255);
+            SDL_RenderFillRect(renderer, &row);
+        }
+        std::string_view word = completions[i].word;
+        int x = textAtlas.queueText(word.substr(0, completionPrefixLength), popup.x + 8, y, prefixColor);
+        textAtlas.queueText(word.substr(completionPrefixLength), x, y, textColor);
+        // How often the word appears; built-in names not used yet show none
+        if (completions[i].count > 0) {
+            std::string count = std::to_string(completions[i].count);
+            textAtlas.queueText(count, popup.x + popup.w - 8 - textAtlas.textWidth(count), y, countColor);
+        }
+        textAtlas.flush();
+    }
+}
+
+// --------- Error Panel Rendering Function ---------
+// Only the rows that fit in the panel are drawn, however much output the
+// console holds
+void renderErrorPanel() {
+    TRACE_SCOPE("renderErrorPanel");
+    SDL_SetRenderDrawColor(renderer, 30, 30, 30, 255); // Dark background
+    SDL_RenderFillRect(renderer, &ERROR_PANEL_RECT);
+
+    SDL_Color errorColor = {255, 255, 255, 255};  // White text
+    SDL_Color noteColor = {150, 150, 150, 255};
+    int rows = consoleVisibleRows();
+    int y = ERROR_PANEL_RECT.y + 5;
+
+    size_t lines = panelLineCount();
+    if (consoleFollow) {
+        consoleScroll = lines > (size_t)rows ? lines - rows : 0;
+    }
+    for (size_t i = consoleScroll; i < lines && i < consoleScroll + rows; i++) {
+        std::string_view line = panelLine(i);
+        Severity severity = severityOfLine(line);
+        textAtlas.queueText(line, 15, y, severity == Severity::None ? errorColor : severityColor(severity));
+        y += CONSOLE_ROW_HEIGHT;
+    }
+    textAtlas.flush();
+
+    // Where the view is, and how much output fell off the top
+    if (lines > (size_t)rows || console.droppedLines() > 0) {
+        std::string position = std::to_string(consoleScroll + 1) + "-" +
+                               std::to_string(std::min(lines, consoleScroll + rows)) +
+                               " of " + std::to_string(lines);
+        if (console.droppedLines() > 0) {
+            position += " (" + std::to_string(console.droppedLines()) + " dropped)";
+        }
+        int width = textAtlas.textWidth(position);
+        textAtlas.drawText(position, SCREEN_WIDTH - width - 10, ERROR_PANEL_RECT.y + 5, noteColor);
+    }
+}
+
+int consoleVisibleRows() {
+    return (ERROR_PANEL_HEIGHT - 10) / CONSOLE_ROW_HEIGHT;
+}
+
+// Scrolling back stops following the output; scrolling to the end resumes
+void scrollConsole(long lines) {
+    size_t rows = consoleVisibleRows();
+    size_t maxScroll = panelLineCount() > rows ? panelLineCount() - rows : 0;
+    long target = (long)(consoleFollow ? maxScroll : consoleScroll) + lines;
+    consoleScroll = (size_t)std::max(0L, std::min(target, (long)maxScroll));
+    consoleFollow = consoleScroll == maxScroll;
+    markDirty(DIRTY_ERRORS);
+}
+
+void clearConsole() {
+    console.clear();
+    consoleScroll = 0;
+    consoleFollow = true;
+    markDirty(DIRTY_ERRORS);
+}
+
+
+// --------- Compilation & Execution ---------
+// Formats a duration the way the status bar shows it
+static std::string formatSeconds(double seconds) {
+    char text[32];
+    std::snprintf(text, sizeof(text), "%.2fs", seconds);
+    return text;
+}
+
+// Runs a freshly built program with input.txt as stdin, streaming its output
+static ProcessResult runProgram(Job& job, const std::string& program) {
+    ProcessOptions runOptions;
+#ifdef _WIN32
+    runOptions.args = {program};
+#else
+    runOptions.args = {"./" + program};
+#endif
+    runOptions.stdinFile = "input.txt";
+    runOptions.mergeStderr = true;
+    TRACE_SCOPE("run program");
+    return job.runProcess(runOptions, RUN_TIMEOUT_MS, [&](const std::string& line, bool) { job.output(" " + line); });
+}
+
+// The build itself, run on the build job's worker thread. Unchanged code is
+// served from the build cache without invoking g++ at all; otherwise the
+// leading include block is compiled from a precompiled header when one has
+// been built, and one is built after the run when it has not. With benchmark
+// set the program is measured over repeated runs instead of run once.
+void runBuild(Job& job, const TextSnapshot& source, const BuildConfig& config, bool benchmark) {
+    std::vector<std::string> command = buildCommand(config);
+    std::string key = BuildCache::makeKey(source.runs(), command, compilerVersion(command[0]));
+    std::vector<std::string> diagnostics;
+    std::string buildNote;
+    PrecompiledHeader pch;
+    bool buildPch = false;
+
+    bool cached;
+    {
+        TRACE_SCOPE("build cache lookup");
+        cached = buildCache().fetch(key, config.output, diagnostics);
+    }
+    if (cached) {
+        buildNote = "cache hit";
+        for (const std::string& line : diagnostics) job.diagnostic(line);
+    } else {
+        job.status("Compiling...");
+        std::string error;
+        if (!writeFileAtomically(SOURCE_FILE, source.runs(), error)) {
+            job.output("Error: " + error);
+            job.status("Compile failed");
+            return;
+        }
+
+        // The include block sits at the top; the rest of the file is not needed
+        std::string head;
+        for (std::string_view run : source.runs()) {
+            if (head.size() >= PCH_SCAN_BYTES) break;
+            head.append(run.substr(0, PCH_SCAN_BYTES - head.size()));
+        }
+        bool hasPch = findPrecompiledHeader(head, command[0], config.flags, pch);
+        bool usePch = hasPch && pch.ready;
+        bool pchRejected = false;
+        ProcessOptions compileOptions;
+        compileOptions.args = command;
+        if (usePch) {
+            std::vector<std::string> pchArgs = precompiledHeaderArgs(pch);
+            compileOptions.args.insert(compileOptions.args.end(), pchArgs.begin(), pchArgs.end());
+        }
+
+        // Each diagnostic reaches the console as one formatted line, which is
+        // also what the cache keeps
+        DiagnosticParser parser([&](const Diagnostic& diagnostic) {
+            // A stale header is ignored by g++; drop it quietly and rebuild
+            if (usePch && diagnostic.option == "-Winvalid-pch") {
+                pchRejected = true;
+                return;
+            }
+            std::string line = formatDiagnostic(diagnostic);
+            diagnostics.push_back(line);
+            job.diagnostic(line);
+        });
+        ProcessResult compiled;
+        {
+            TRACE_SCOPE("compile");
+            compiled = job.runProcess(compileOptions, COMPILE_TIMEOUT_MS,
+                [&](const std::string& line, bool) {
+                    if (usePch && isInvalidPchWarning(line)) {
+                        pchRejected = true;
+                        return;
+                    }
+                    parser.feedLine(line);
+                }, SIZE_MAX);  // JSON diagnostics arrive as one line
+        }
+        if (pchRejected) discardPrecompiledHeader(pch);
+
+        if (compiled.cancelled) {
+            job.status("Cancelled");
+            return;
+        }
+        if (compiled.timedOut) {
+            job.status("Compile timed out");
+            return;
+        }
+        if (compiled.started) lastCompileSeconds = compiled.seconds;
+        if (!compiled.started || compiled.exitCode != 0) {
+            job.status("Compile failed");
+            return;
+        }
+        buildCache().store(key, config.output, diagnostics);
+
+        buildNote = "cache miss, compile " + formatSeconds(compiled.seconds);
+        if (usePch && !pchRejected) {
+            buildNote += " with PCH";
+            double baseline = pchBaselineSeconds(pch);
+            if (baseline > 0) buildNote += " (" + formatSeconds(baseline) + " without)";
+        } else if (hasPch) {
+            setPchBaselineSeconds(pch, compiled.seconds);
+            buildPch = true;
+        }
+    }
+
+    std::string summary;
+    if (benchmark) {
+        summary = runBenchmarks(job, key, config);
+        if (job.cancelled()) {
+            job.status("Cancelled");
+            return;
+        }
+        summary += ", " + buildNote;
+    } else {
+        job.status("Running... (" + buildNote + ")");
+        ProcessResult ran = runProgram(job, config.output);
+        if (ran.cancelled) {
+            job.status("Killed");
+            return;
+        } else if (ran.timedOut) {
+            summary = "Timed out after " + std::to_string(RUN_TIMEOUT_MS / 1000) + "s";
+        } else {
+            summary = "Finished (exit " + std::to_string(ran.exitCode) + ") in " + formatSeconds(ran.seconds) + ", " + buildNote;
+        }
+    }
+
+    // Precompile the include block for next time, once the output is in
+    if (buildPch) {
+        job.status(summary + " | building PCH...");
+        ProcessOptions pchOptions;
+        pchOptions.args = precompiledHeaderCommand(pch, command[0], config.flags);
+        TRACE_SCOPE("build PCH");
+        ProcessResult built = job.runProcess(pchOptions, COMPILE_TIMEOUT_MS, [](const std::string&, bool) {});
+        bool ready = finishPrecompiledHeader(pch, built.cancelled || built.timedOut ? -1 : built.exitCode);
+        if (ready) summary += " | PCH ready";
+    }
+    job.status(config.name + ": " + summary);
+}
+
+// Measures the built program against input.txt, or each file in
+// bench_inputs/, and reports the statistics. Each input is compared with the
+// last benchmark of it, which only this (build job) thread touches. Returns
+// the status bar summary.
+std::string runBenchmarks(Job& job, const std::string& buildKey, const BuildConfig& config) {
+    static std::map<std::string, InputBenchmark> previousResults;
+    static std::string previousKey;
+
+    BenchmarkOptions options;
+    options.warmupRuns = BENCH_WARMUP_RUNS;
+    options.runs = BENCH_RUNS;
+    options.timeoutMs = RUN_TIMEOUT_MS;
+    options.memoryLimitBytes = needsUnlimitedAddressSpace(config) ? 0 : BENCH_MEMORY_LIMIT;
+    std::string previousLabel = buildKey == previousKey ? "previous run" : "previous build";
+
+    std::vector<std::string> inputs = benchmarkInputs("input.txt", BENCH_INPUT_DIR);
+    size_t failed = 0;
+    double totalMedian = 0.0;
+    for (const std::string& input : inputs) {
+        InputBenchmark result = benchmarkProgram(job, config.output, input, options);
+        if (job.cancelled()) return std::string();
+
+        auto previous = previousResults.find(input);
+        for (const std::string& line : formatBenchmark(result, options.warmupRuns,
+                                                       previous == previousResults.end() ? nullptr : &previous->second,
+                                                       previousLabel)) {
+            job.output(line);
+        }
+        if (!result.failure.empty()) failed++;
+        totalMedian += result.wall.median;
+        if (result.runs > 0) previousResults[input] = result;
+    }
+    previousKey = buildKey;
+
+    std::string summary = inputs.size() == 1 ? "Benchmark median " + formatSeconds(totalMedian)
+                                             : "Benchmarked " + std::to_string(inputs.size()) +
+                                                   " inputs, medians total " + formatSeconds(totalMedian);
+    if (failed > 0) summary += ", " + std::to_string(failed) + " failed";
+    return summary;
+}
+
+// Starts runBuild in the background. Compiler and program output stream into
+// the console as it arrives; the UI keeps running and Ctrl+K cancels.
+void compileAndRun() {
+    startBuild(false);
+}
+
+// Builds like compileAndRun, then times repeated runs of the program
+void benchmarkRun() {
+    startBuild(true);
+}
+
+// Builds with debug information and a sampler linked in, runs the program
+// once and paints the cost of each line into the gutter
+void profileRun() {
+    if (buildJob.running()) {
+        std::cout << "A build is already running" << std::endl;
+        return;
+    }
+
+    std::ofstream inputFile("input.txt");
+    inputFile << userInput;
+    inputFile.close();
+
+    clearConsole();
+    diagnosticIndex.clear();
+    checkLines.clear();
+    liveIsNewer = false;
+    clearProfile();
+    markDirty(DIRTY_GUTTER);
+
+    buildJob.start("profile", [source = buffer.snapshot(), config = buildConfigs[activeConfig]](Job& job) {
+        runProfile(job, source, config);
+    });
+    markDirty(DIRTY_STATUS);
+}
+
+// The profile itself, run on the build job's worker thread. Profiling builds
+// use the active configuration's compiler and flags, so the profile shows
+// the code Run would run, but never go through the build cache since the
+// profiler adds its own flags.
+void runProfile(Job& job, const TextSnapshot& source, const BuildConfig& config) {
+    std::string error;
+    if (!writeFileAtomically(SOURCE_FILE, source.runs(), error)) {
+        job.output("Error: " + error);
+        job.status("Profile failed");
+        return;
+    }
+
+    ProfileOptions options;
+    options.compiler = config.compiler;
+    options.flags = config.flags;
+    options.stdinFile = "input.txt";
+    options.compileTimeoutMs = COMPILE_TIMEOUT_MS;
+    options.runTimeoutMs = RUN_TIMEOUT_MS;
+    ProfileResult result = profileProgram(job, SOURCE_FILE, options, [&](const std::string& line) { job.output(" " + line); });
+
+    DiagnosticParser parser([&](const Diagnostic& diagnostic) { job.diagnostic(formatDiagnostic(diagnostic)); });
+    for (const std::string& line : result.compileOutput) parser.feedLine(line);
+
+    if (result.cancelled) {
+        job.status("Cancelled");
+        return;
+    }
+    if (!result.succeeded) {
+        job.status("Profile failed: " + result.failure);
+        return;
+    }
+    for (const std::string& line : formatProfile(result, SOURCE_FILE, PROFILE_TOP_LINES)) job.output(line);
+    job.status("Profiled (exit " + std::to_string(result.exitCode) + ") in " + formatSeconds(result.seconds) + ", " +
+               (result.method == ProfileMethod::Sampled ? std::to_string(result.total) + " samples"
+                                                        : std::string("line counts")));
+
+    std::lock_guard<std::mutex> lock(profileMutex);
+    finishedProfile = std::move(result);
+    profileFinished = true;
+}
+
+void clearProfile() {
+    profileCost.clear();
+    profileTotal = profileMax = 0;
+    markDirty(DIRTY_GUTTER);
+}
+
+void startBuild(bool benchmark) {
+    if (buildJob.running()) {
+        std::cout << "A build is already running" << std::endl;
+        return;
+    }
+
+    std::ofstream inputFile("input.txt");
+    inputFile << userInput;
+    inputFile.close();
+
+    clearConsole();
+    diagnosticIndex.clear();
+    checkLines.clear();
+    liveIsNewer = false;
+    markDirty(DIRTY_GUTTER);
+
+    buildJob.start("build", [source = buffer.snapshot(), config = buildConfigs[activeConfig], benchmark](Job& job) {
+        runBuild(job, source, config, benchmark);
+    });
+    markDirty(DIRTY_STATUS);
+}
+
+// --------- Build Configurations ---------
+// The single command that compiles and links the editor text
+std::vector<std::string> buildCommand(const BuildConfig& config) {
+    std::vector<std::string> command = {config.compiler, SOURCE_FILE};
+    command.insert(command.end(), config.flags.begin(), config.flags.end());
+    command.push_back("-o");
+    command.push_back(config.output);
+    if (compilerSupportsJsonDiagnostics(command[0])) command.push_back("-fdiagnostics-format=json");
+    return command;
+}
+
+// Reads ide_configs.txt, writing the default configurations first if it is
+// missing. A broken file leaves a single configuration with no flags.
+void loadConfigs() {
+    std::string error;
+    if (!loadBuildConfigs(CONFIG_FILE, OUTPUT_STEM, buildConfigs, error)) {
+        std::cerr << error << std::endl;
+        BuildConfig fallback;
+        fallback.name = "Default";
+        fallback.output = OUTPUT_STEM + ".exe";
+        buildConfigs = {fallback};
+    }
+    activeConfig = 0;
+    compareConfig = buildConfigs.size() > 1 ? 1 : 0;
+    updateConfigButtons();
+}
+
+void updateConfigButtons() {
+    for (Button& button : buttons) {
+        if (button.action == nextConfig) button.label = "Config: " + buildConfigs[activeConfig].name;
+        if (button.action == nextCompareConfig) button.label = "Compare With: " + buildConfigs[compareConfig].name;
+    }
+    markDirty(DIRTY_SIDEBAR);
+}
+
+// Each click selects the next configuration, wrapping around. Binaries are
+// kept per configuration, so switching back reuses the last build.
+void nextConfig() {
+    activeConfig = (activeConfig + 1) % buildConfigs.size();
+    std::cout << "Build configuration: " << buildConfigs[activeConfig].name << std::endl;
+    updateConfigButtons();
+    scheduleSyntaxCheck();
+}
+
+void nextCompareConfig() {
+    compareConfig = (compareConfig + 1) % buildConfigs.size();
+    updateConfigButtons();
+}
+
+// Builds the editor text under the active configuration and the one chosen
+// to compare with, then times both against input.txt
+void compareConfigs() {
+    if (buildJob.running()) {
+        std::cout << "A build is already running" << std::endl;
+        return;
+    }
+    if (compareConfig == activeConfig) {
+        console.append("Error: choose a different configuration to compare with");
+        markDirty(DIRTY_ERRORS);
+        return;
+    }
+
+    std::ofstream inputFile("input.txt");
+    inputFile << userInput;
+    inputFile.close();
+
+    clearConsole();
+    diagnosticIndex.clear();
+    checkLines.clear();
+    liveIsNewer = false;
+    markDirty(DIRTY_GUTTER);
+
+    buildJob.start("compare", [source = buffer.snapshot(), first = buildConfigs[activeConfig],
+                               second = buildConfigs[compareConfig]](Job& job) { runCompare(job, source, first, second); });
+    markDirty(DIRTY_STATUS);
+}
+
+// Both sides are compiled from scratch, without the build cache or a
+// precompiled header, so their compile times are comparable; the binaries
+// still go into the cache for the next Run.
+void runCompare(Job& job, const TextSnapshot& source, const BuildConfig& first, const BuildConfig& second) {
+    std::string error;
+    if (!writeFileAtomically(SOURCE_FILE, source.runs(), error)) {
+        job.output("Error: " + error);
+        job.status("Compare failed");
+        return;
+    }
+
+    ConfigMeasurement measured[2];
+    const BuildConfig* configs[2] = {&first, &second};
+    for (int i = 0; i < 2; i++) {
+        const BuildConfig& config = *configs[i];
+        ConfigMeasurement& side = measured[i];
+        side.name = config.name;
+        job.status("Compiling " + config.name + "...");
+
+        std::vector<std::string> command = buildCommand(config);
+        std::vector<std::string> diagnostics;
+        DiagnosticParser parser([&](const Diagnostic& diagnostic) {
+            std::string line = formatDiagnostic(diagnostic);
+            diagnostics.push_back(line);
+            job.diagnostic(line);
+        });
+        ProcessOptions compileOptions;
+        compileOptions.args = command;
+        ProcessResult compiled;
+        {
+            TRACE_SCOPE("compare compile");
+            compiled = job.runProcess(compileOptions, COMPILE_TIMEOUT_MS,
+                                      [&](const std::string& line, bool) { parser.feedLine(line); }, SIZE_MAX);
+        }
+        if (compiled.cancelled) {
+            job.status("Cancelled");
+            return;
+        }
+        side.built = compiled.started && !compiled.timedOut && compiled.exitCode == 0;
+        side.compileSeconds = compiled.seconds;
+        if (!side.built) continue;
+        std::string key = BuildCache::makeKey(source.runs(), command, compilerVersion(command[0]));
+        buildCache().store(key, config.output, diagnostics);
+        std::error_code ec;
+        side.binaryBytes = std::filesystem::file_size(config.output, ec);
+    }
+
+    for (int i = 0; i < 2 && measured[0].built && measured[1].built; i++) {
+        job.status("Timing " + configs[i]->name + "...");
+        BenchmarkOptions options;
+        options.warmupRuns = BENCH_WARMUP_RUNS;
+        options.runs = BENCH_RUNS;
+        options.timeoutMs = RUN_TIMEOUT_MS;
+        options.memoryLimitBytes = needsUnlimitedAddressSpace(*configs[i]) ? 0 : BENCH_MEMORY_LIMIT;
+        measured[i].run = benchmarkProgram(job, configs[i]->output, "input.txt", options);
+        if (job.cancelled()) {
+            job.status("Cancelled");
+            return;
+        }
+    }
+
+    for (const std::string& line : formatComparison(measured[0], measured[1])) job.output(line);
+    if (!measured[0].built || !measured[1].built) {
+        job.status("Compare failed: " + (measured[0].built ? second.name : first.name) + " did not compile");
+        return;
+    }
+    std::string summary = "Compared " + first.name + " and " + second.name;
+    double before = measured[0].run.wall.median, after = measured[1].run.wall.median;
+    if (measured[0].run.runs > 0 && measured[1].run.runs > 0 && before > 0 && after > 0) {
+        char ratio[96];
+        std::snprintf(ratio, sizeof(ratio), ", %s runs %.2fx %s", second.name.c_str(),
+                      after < before ? before / after : after / before, after < before ? "faster" : "slower");
+        summary += ratio;
+    }
+    job.status(summary);
+}
+
+// Builds the sources listed in ide_project.txt and runs the result. Only
+// translation units that changed are recompiled, several at a time; each
+// one's diagnostics reach the console when its compile ends.
+void runProjectBuild(Job& job, const ProjectManifest& manifest) {
+    ProjectOptions options = manifest.options;
+    options.timeoutMs = COMPILE_TIMEOUT_MS;
+    ProjectResult built = buildProject(job, manifest.sources, options, [&](const UnitResult& unit) {
+        DiagnosticParser parser([&](const Diagnostic& diagnostic) { job.diagnostic(formatDiagnostic(diagnostic)); });
+        for (const std::string& line : unit.output) parser.feedLine(line);
+    });
+
+    std::string buildNote = std::to_string(built.compiled) + " compiled, " + std::to_string(built.upToDate) +
+                            " up to date, " + (built.linked ? "linked" : "link skipped") + " in " +
+                            formatSeconds(built.seconds);
+    if (built.cancelled) {
+        job.status("Cancelled");
+        return;
+    }
+    if (!built.succeeded) {
+        job.status(built.failed > 0 ? "Build failed, " + std::to_string(built.failed) + " failed to compile" : "Link failed");
+        return;
+    }
+    lastCompileSeconds = built.seconds;
+
+    job.status("Running... (" + buildNote + ")");
+    ProcessResult ran = runProgram(job, options.output);
+    if (ran.cancelled) {
+        job.status("Killed");
+    } else if (ran.timedOut) {
+        job.status("Timed out after " + std::to_string(RUN_TIMEOUT_MS / 1000) + "s");
+    } else {
+        job.status("Finished (exit " + std::to_string(ran.exitCode) + ") in " + formatSeconds(ran.seconds) + ", " +
+                   buildNote);
+    }
+}
+
+void buildProjectAndRun() {
+    if (buildJob.running()) {
+        std::cout << "A build is already running" << std::endl;
+        return;
+    }
+    ProjectManifest manifest;
+    std::string error;
+    clearConsole();
+    diagnosticIndex.clear();
+    checkLines.clear();
+    liveIsNewer = false;
+    markDirty(DIRTY_GUTTER | DIRTY_STATUS);
+    if (!loadProjectManifest(PROJECT_FILE, manifest, error)) {
+        console.append("Error: " + error);
+        buildStatus = "No project";
+        return;
+    }
+
+    std::ofstream inputFile("input.txt");
+    inputFile << userInput;
+    inputFile.close();
+
+    buildJob.start("project", [manifest](Job& job) { runProjectBuild(job, manifest); });
+}
+
+void cancelBuild() {
+    if (buildJob.running()) {
+        std::cout << "Cancelling build..." << std::endl;
+        buildJob.cancel();
+    }
+}
+
+// Applies whatever the build job reported since the last call
+void pollBuildJob() {
+    static std::vector<JobEvent> events;
+    events.clear();
+    buildJob.poll(events);
+
+    uint64_t dropped = buildJob.takeDroppedOutput();
+    if (dropped > 0) {
+        console.addDropped(dropped);
+        markDirty(DIRTY_ERRORS);
+    }
+    for (JobEvent& event : events) {
+        if (event.type == JobEvent::Output) {
+            console.append(event.text);
+            markDirty(DIRTY_ERRORS);
+        } else if (event.type == JobEvent::Diagnostic) {
+            Diagnostic diagnostic = parseDiagnosticLine(event.text);
+            diagnosticIndex.add(diagnostic, diagnostic.file == SOURCE_FILE);
+            console.append(event.text);
+            markDirty(DIRTY_ERRORS | DIRTY_GUTTER | DIRTY_STATUS);
+        } else if (event.type == JobEvent::Status) {
+            buildStatus = std::move(event.text);
+            markDirty(DIRTY_STATUS);
+        } else {
+            markDirty(DIRTY_STATUS);
+        }
+    }
+
+    // A finished profile becomes the gutter heatmap
+    {
+        std::lock_guard<std::mutex> lock(profileMutex);
+        if (profileFinished) {
+            profileCost = std::move(finishedProfile.lineCost);
+            profileTotal = finishedProfile.total;
+            profileMax = profileCost.empty() ? 0 : *std::max_element(profileCost.begin(), profileCost.end());
+            profileFinished = false;
+            showProfile = true;
+            markDirty(DIRTY_GUTTER);
+        }
+    }
+
+    // Keep the elapsed time ticking while nothing else happens
+    if (buildJob.running()) {
+        markDirty(DIRTY_STATUS);
+        scheduleWake(PROGRESS_REFRESH_MS);
+    }
+}
+
+// --------- Diagnostic Navigation ---------
+// Moves the cursor to where the compiler pointed. Positions refer to the
+// text that was compiled, so they drift once the lines above are edited.
+void jumpToDiagnostic(const Diagnostic& diagnostic) {
+    bool inEditor = diagnostic.file == SOURCE_FILE || diagnostic.file == CHECK_FILE;
+    if (!inEditor || diagnostic.line <= 0) return;
+    currentLine = std::min(diagnostic.line - 1, lineCount() - 1);
+    cursorPos = std::min(std::max(diagnostic.column - 1, 0), lineLength(currentLine));
+    selecting = false;
+    ensureCursorVisible();
+    markDirty(DIRTY_EDITOR | DIRTY_GUTTER | DIRTY_STATUS);
+}
+
+void nextDiagnostic(bool forward) {
+    if (const Diagnostic* diagnostic = editorDiagnostics().next(currentLine, cursorPos, forward)) {
+        jumpToDiagnostic(*diagnostic);
+    }
+}
+
+// A click on a console line that names a place in the editor's file jumps there
+void clickErrorPanel(int mouseY) {
+    int row = (mouseY - ERROR_PANEL_RECT.y - 5) / CONSOLE_ROW_HEIGHT;
+    if (row < 0 || row >= consoleVisibleRows()) return;
+    size_t index = consoleScroll + row;
+    if (index >= panelLineCount()) return;
+    jumpToDiagnostic(parseDiagnosticLine(panelLine(index)));
+}
+
+// --------- Background Syntax Check ---------
+// Gutter markers, F8 and the status bar follow whichever of the last build
+// and the last syntax check is more recent
+const DiagnosticIndex& editorDiagnostics() {
+    return liveIsNewer ? liveDiagnostics : diagnosticIndex;
+}
+
+// The error panel shows the console, then the last check's diagnostics
+size_t panelLineCount() {
+    return console.size() + checkLines.size();
+}
+
+std::string_view panelLine(size_t i) {
+    return i < console.size() ? console.line(i) : std::string_view(checkLines[i - console.size()]);
+}
+
+// Called for every edit, so it only notes the time: a burst of typing keeps
+// pushing the check back, and a check already running is cancelled since
+// its answer is about older text
+void scheduleSyntaxCheck() {
+    editVersion++;
+    if (checkDelayMs == 0) return;
+    checkScheduled = true;
+    checkDueTicks = SDL_GetTicks() + checkDelayMs;
+    if (checkInFlight) checkJob.cancel();
+    scheduleWake(checkDelayMs);
+}
+
+// Runs g++ -fsyntax-only over a snapshot on the check job's thread, with the
+// precompiled header when one is ready
+void runSyntaxCheck(Job& job, const TextSnapshot& source, const BuildConfig& config) {
+    TRACE_SCOPE("syntax check");
+    std::string error;
+    if (!writeFileAtomically(CHECK_FILE, source.runs(), error)) return;
+
+    // The configuration's flags, so its language standard applies and its
+    // precompiled header can be used
+    std::vector<std::string> command = {config.compiler, "-fsyntax-only", CHECK_FILE};
+    command.insert(command.end(), config.flags.begin(), config.flags.end());
+    if (compilerSupportsJsonDiagnostics(command[0])) command.push_back("-fdiagnostics-format=json");
+    std::string head;
+    for (std::string_view run : source.runs()) {
+        if (head.size() >= PCH_SCAN_BYTES) break;
+        head.append(run.substr(0, PCH_SCAN_BYTES - head.size()));
+    }
+    PrecompiledHeader pch;
+    bool usePch = findPrecompiledHeader(head, command[0], config.flags, pch) && pch.ready;
+    if (usePch) {
+        std::vector<std::string> pchArgs = precompiledHeaderArgs(pch);
+        command.insert(command.end(), pchArgs.begin(), pchArgs.end());
+    }
+
+    DiagnosticParser parser([&](const Diagnostic& diagnostic) {
+        if (diagnostic.option == "-Winvalid-pch") return;
+        job.diagnostic(formatDiagnostic(diagnostic));
+    });
+    ProcessOptions options;
+    options.args = command;
+    job.runProcess(options, COMPILE_TIMEOUT_MS, [&](const std::string& line, bool) {
+        if (!isInvalidPchWarning(line)) parser.feedLine(line);
+    }, SIZE_MAX);
+}
+
+// Collects the running check's results and starts the next check once the
+// typing has paused. Results only replace the shown ones when the check
+// finished and no edit came in meanwhile.
+void pollSyntaxCheck() {
+    static std::vector<JobEvent> events;
+    events.clear();
+    checkJob.poll(events);
+
+    for (JobEvent& event : events) {
+        if (event.type == JobEvent::Diagnostic) {
+            pendingCheck.push_back(std::move(event.text));
+        } else if (event.type == JobEvent::Finished) {
+            checkInFlight = false;
+            if (!checkJob.cancelled() && checkedVersion == editVersion) {
+                liveDiagnostics.clear();
+                for (const std::string& line : pendingCheck) {
+                    Diagnostic diagnostic = parseDiagnosticLine(line);
+                    liveDiagnostics.add(diagnostic, diagnostic.file == CHECK_FILE);
+                }
+                checkLines.clear();
+                if (!pendingCheck.empty()) {
+                    checkLines.push_back("Syntax check: " + std::to_string(liveDiagnostics.errorCount()) + " errors, " +
+                                         std::to_string(liveDiagnostics.warningCount()) + " warnings");
+                    checkLines.insert(checkLines.end(), pendingCheck.begin(), pendingCheck.end());
+                }
+                liveIsNewer = true;
+                markDirty(DIRTY_GUTTER | DIRTY_ERRORS | DIRTY_STATUS);
+            }
+            pendingCheck.clear();
+            markDirty(DIRTY_STATUS);
+        }
+    }
+
+    if (!checkScheduled || checkInFlight) return;
+    Uint32 now = SDL_GetTicks();
+    if (!SDL_TICKS_PASSED(now, checkDueTicks)) {
+        scheduleWake(checkDueTicks - now);
+        return;
+    }
+    checkScheduled = false;
+    if (buffer.length() > SYNTAX_CHECK_MAX_BYTES) return;
+    checkedVersion = editVersion;
+    checkInFlight = checkJob.start("check", [source = buffer.snapshot(), config = buildConfigs[activeConfig]](Job& job) {
+        runSyntaxCheck(job, source, config);
+    });
+    markDirty(DIRTY_STATUS);
+}
+
+// --------- Error Panel Rendering ---------
+void showCompileErrors() {
+    clearConsole();
+    std::ifstream errorFile(ERROR_FILE);
+    std::string errorLine;
+    while (std::getline(errorFile, errorLine)) {
+        console.append(errorLine);
+    }
+    errorFile.close();
+}
+
+// --------- Input Handling ---------
+void handleInput(SDL_Event& e) {
+    TRACE_SCOPE("handleInput");
+    if (findOpen && handleFindInput(e)) return;
+    if (completionOpen && handleCompletionInput(e)) return;
+
+    int previousScroll = scrollOffset;
+    int previousLineCount = lineCount();
+
+    // Arrow and page keys extend the selection from the cursor when Shift is
+    // held and drop it otherwise
+    SDL_Keycode key = e.type == SDL_KEYDOWN ? e.key.keysym.sym : SDLK_UNKNOWN;
+    if (key == SDLK_UP || key == SDLK_DOWN || key == SDLK_LEFT || key == SDLK_RIGHT || key == SDLK_PAGEUP ||
+        key == SDLK_PAGEDOWN) {
+        if (SDL_GetModState() & KMOD_SHIFT) {
+            if (!hasSelection()) {
+                selectionStartLine = currentLine;
+                selectionStartPos = cursorPos;
+            }
+            selecting = true;
+        } else {
+            clearSelection();
+        }
+    }
+
+    // Typing over a selection replaces it, in the same undo step as the text
+    bool replacingSelection = hasSelection() &&
+        (e.type == SDL_TEXTINPUT || key == SDLK_RETURN || key == SDLK_LEFTPAREN || key == SDLK_RIGHTPAREN ||
+         key == SDLK_LEFTBRACKET || key == SDLK_RIGHTBRACKET);
+    if (replacingSelection) {
+        history.beginGroup(cursorOffset());
+        deleteSelection();
+    }
+
+    if (e.type == SDL_QUIT) {
+        quit = true;
+    } else if (e.type == SDL_KEYDOWN) {
+        if (e.key.keysym.sym == SDLK_PAGEUP) {
+            currentLine = std::max(0, currentLine - visibleLineCount());
+            scrollOffset -= visibleLineCount() * LINE_HEIGHT;
+            cursorPos = std::min(cursorPos, lineLength(currentLine));
+        } else if (e.key.keysym.sym == SDLK_PAGEDOWN) {
+            currentLine = std::min(lineCount() - 1, currentLine + visibleLineCount());
+            scrollOffset += visibleLineCount() * LINE_HEIGHT;
+            cursorPos = std::min(cursorPos, lineLength(currentLine));
+        } else if (e.key.keysym.sym == SDLK_UP) {
+            if (currentLine > 0) {
+                currentLine--;
+                cursorPos = std::min(cursorPos, lineLength(currentLine));
+            }
+        } else if (e.key.keysym.sym == SDLK_DOWN) {
+            if (currentLine < lineCount() - 1) {
+                currentLine++;
+                cursorPos = std::min(cursorPos, lineLength(currentLine));
+            }
+        } else if (e.key.keysym.sym == SDLK_s && SDL_GetModState() & KMOD_CTRL) {
+            saveToFile("saved_code.cpp");  // Ctrl+S saves the file in the background
+        } else if (e.key.keysym.sym == SDLK_o && SDL_GetModState() & KMOD_CTRL) {
+            loadFromFile("saved_code.cpp");  // Ctrl+O opens the file
+            std::cout << "File loaded from saved_code.cpp" << std::endl;
+        } else if (e.key.keysym.sym == SDLK_b && SDL_GetModState() & KMOD_CTRL) {
+            std::cout << "Compiling and running the code..." << std::endl;
+            compileAndRun();
+        } else if (e.key.keysym.sym == SDLK_k && SDL_GetModState() & KMOD_CTRL) {
+            cancelBuild();  // Ctrl+K stops the compiler or kills the running program
+        } else if (e.key.keysym.sym == SDLK_f && SDL_GetModState() & KMOD_CTRL) {
+            openFind(false);  // Ctrl+F finds
+        } else if (e.key.keysym.sym == SDLK_h && SDL_GetModState() & KMOD_CTRL) {
+            openFind(true);   // Ctrl+H finds and replaces
+        } else if (e.key.keysym.sym == SDLK_F3) {
+            showOverlay = !showOverlay;  // F3 shows frame, memory and compile statistics
+            markDirty(DIRTY_STATUS);
+        } else if (e.key.keysym.sym == SDLK_F4) {
+            toggleTracing();  // F4 starts a trace, or stops it and writes ide_trace.json
+        } else if (e.key.keysym.sym == SDLK_F6) {
+            showProfile = !showProfile;  // F6 hides or shows the profile heatmap in the gutter
+            markDirty(DIRTY_GUTTER);
+        } else if (e.key.keysym.sym == SDLK_F8) {
+            nextDiagnostic(!(SDL_GetModState() & KMOD_SHIFT));  // F8 / Shift+F8 step through errors and warnings
+        } else if (e.key.keysym.sym == SDLK_LEFT) {
+            if (cursorPos > 0) {
+                cursorPos--;
+            } else if (currentLine > 0) {
+                currentLine--;
+                cursorPos = lineLength(currentLine);
+            }
+        } else if (e.key.keysym.sym == SDLK_RIGHT) {
+            if (cursorPos < lineLength(currentLine)) {
+                cursorPos++;
+            } else if (currentLine < lineCount() - 1) {
+                currentLine++;
+                cursorPos = 0;
+            }
+        } else if (e.key.keysym.sym == SDLK_a && SDL_GetModState() & KMOD_CTRL) { 
+            // ---- Select All (Ctrl + A) ----
+            selectionStartLine = 0;
+            selectionStartPos = 0;
+            currentLine = lineCount() - 1;
+            cursorPos = lineLength(currentLine);
+            selecting = true;
+        } else if (e.key.keysym.sym == SDLK_x && SDL_GetModState() & KMOD_CTRL) { 
+            // ---- Cut (Ctrl + X) ----
+            if (hasSelection()) {
+                copySelection();
+                deleteSelection();
+            }
+        } else if (e.key.keysym.sym == SDLK_BACKSPACE || e.key.keysym.sym == SDLK_DELETE) {
+            if (hasSelection()) {
+                deleteSelection();
+            } else if (e.key.keysym.sym == SDLK_DELETE) {
+                // Deletes forward, joining with the next line at the end of this one
+                if (cursorOffset() < buffer.length()) eraseText(cursorOffset(), 1, EditKind::Deleting);
+            } else if (cursorPos > 0) {
+                eraseText(cursorOffset() - 1, 1, EditKind::Deleting);
+                cursorPos--;
+            } else if (currentLine > 0) {
+                // Join with the previous line
+                int previousLength = lineLength(currentLine - 1);
+                eraseText(cursorOffset() - 1, 1, EditKind::Deleting);
+                currentLine--;
+                cursorPos = previousLength;
+            }
+            if (completionOpen) updateCompletion();
+        }
+        // ---- Auto-Complete Feature ----
+        else if (e.key.keysym.sym == SDLK_LEFTPAREN) { // "("
+            insertText(cursorOffset(), "()", EditKind::Typing);
+            cursorPos++;
+        } else if (e.key.keysym.sym == SDLK_RIGHTPAREN) { // ")"
+            if (cursorPos < lineLength(currentLine) && buffer.charAt(cursorOffset()) == ')') {
+                cursorPos++;
+            } else {
+                insertText(cursorOffset(), ")", EditKind::Typing);
+                cursorPos++;
+            }
+        } else if (e.key.keysym.sym == SDLK_LEFTBRACKET) { // "["
+            insertText(cursorOffset(), "[]", EditKind::Typing);
+            cursorPos++;
+        } else if (e.key.keysym.sym == SDLK_RIGHTBRACKET) { // "]"
+            if (cursorPos < lineLength(currentLine) && buffer.charAt(cursorOffset()) == ']') {
+                cursorPos++;
+            } else {
+                insertText(cursorOffset(), "]", EditKind::Typing);
+                cursorPos++;
+            }
+        } else if (e.key.keysym.sym == SDLK_RETURN) {
+            insertText(cursorOffset(), "\n");
+            currentLine++;
+            cursorPos = 0;
+        } else if (e.key.keysym.sym == SDLK_z && SDL_GetModState() & KMOD_CTRL) {
+            undo();
+        } else if (e.key.keysym.sym == SDLK_y && SDL_GetModState() & KMOD_CTRL) {
+            redo();
+        } else if (e.key.keysym.sym == SDLK_c && SDL_GetModState() & KMOD_CTRL) {
+            copySelection();  // Copy the selection, or the cursor line without one
+        } else if (e.key.keysym.sym == SDLK_v && SDL_GetModState() & KMOD_CTRL) {
+            pasteClipboard();
+        }
+        
+    } else if (e.type == SDL_TEXTINPUT) {
+        char ch = e.text.text[0];
+
+        if (ch == '{') {
+            insertText(cursorOffset(), "{}", EditKind::Typing);
+            cursorPos++;
+        } else if (ch == '}') {
+            if (cursorPos < lineLength(currentLine) && buffer.charAt(cursorOffset()) == '}') {
+                cursorPos++;
+            } else {
+                insertText(cursorOffset(), "}", EditKind::Typing);
+                cursorPos++;
+            }
+        } else {
+            insertText(cursorOffset(), e.text.text, EditKind::Typing);
+            cursorPos += strlen(e.text.text);
+        }
+
+        // Typing an identifier asks for suggestions; anything else ends it
+        if (std::isalnum((unsigned char)ch) || ch == '_') {
+            updateCompletion();
+        } else {
+            closeCompletion();
+        }
+    }
+
+    if (replacingSelection) history.endGroup();
+
+    // Keyboard edits and cursor moves keep the cursor in view
+    if (e.type == SDL_KEYDOWN || e.type == SDL_TEXTINPUT) {
+        ensureCursorVisible();
+        markDirty(DIRTY_EDITOR | DIRTY_STATUS);
+    }
+
+    handleMouseInput(e);
+
+    if (scrollOffset != previousScroll || lineCount() != previousLineCount) {
+        markDirty(DIRTY_EDITOR | DIRTY_GUTTER);
+    }
+}
+
+
+// --------- Main Loop ---------
+// Left out of the benchmark build (-DIDE_NO_MAIN), which drives the editor
+// from its own main
+#ifndef IDE_NO_MAIN
+int main(int argc, char* argv[])
+{
+    std::cout << "Initializing SDL..." << std::endl;
+    if (!init()) {
+        std::cerr << "Initialization failed! Exiting..." << std::endl;
+        return -1;
+    }
+    std::cout << "SDL Initialized Successfully!" << std::endl;
+
+    // Sleep until an event arrives, drain everything that queued up, then
+    // redraw whatever the handlers marked dirty
+    SDL_Event e;
+    while (!quit) {
+        if (waitForEvent(e)) {
+            do {
+                if (e.type == SDL_QUIT) {
+                    std::cout << "SDL_QUIT event detected! Exiting program..." << std::endl;
+                    quit = true;
+                } else if (e.type == SDL_WINDOWEVENT || e.type == SDL_RENDER_TARGETS_RESET ||
+                           e.type == SDL_RENDER_DEVICE_RESET) {
+                    markDirty(DIRTY_ALL);
+                }
+
+                handleInput(e);
+            } while (SDL_PollEvent(&e));
+        }
+
+        pollBuildJob();
+        pollSyntaxCheck();
+        pollIdentifierIndex();
+        pollSaveQueue();
+        pollJournal();
+        renderFrame();
+    }
+
+    std::cout << "Exiting program..." << std::endl;
+    close();
+    return 0;
+}
+#endif // IDE_NO_MAIN
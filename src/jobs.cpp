@@ -0,0 +1,211 @@
+#include "jobs.hpp"
+#include "trace.hpp"
+#include <algorithm>
+
+// How long runProcess waits for output before rechecking cancel and timeout
+const int READ_SLICE_MS = 50;
+
+// Output allowed to queue up for the UI, in lines and in bytes. A program
+// that prints faster than the UI drains loses its oldest lines instead of
+// growing the queue.
+const size_t MAX_PENDING_OUTPUT = 20000;
+const size_t MAX_PENDING_OUTPUT_BYTES = 8 * 1024 * 1024;
+
+Job::Job(std::function<void()> notify) : notify(std::move(notify)) {}
+
+Job::~Job() {
+    cancel();
+    wait();
+}
+
+bool Job::start(const std::string& name, Task task) {
+    if (busy.load()) return false;
+    wait();  // Join the previous, already finished worker
+
+    jobName = name;
+    startTime = std::chrono::steady_clock::now();
+    cancelRequested = false;
+    busy = true;
+
+    worker = std::thread([this, task, name]() {
+        traceThreadName(name);
+        task(*this);
+        busy = false;
+        post(JobEvent::Finished, std::string());
+    });
+    return true;
+}
+
+void Job::cancel() {
+    cancelRequested = true;
+    std::lock_guard<std::mutex> lock(mutex);
+    for (ChildProcess* child : children) child->kill();
+}
+
+void Job::wait() {
+    if (worker.joinable()) worker.join();
+}
+
+double Job::elapsedSeconds() const {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+void Job::poll(std::vector<JobEvent>& out) {
+    std::lock_guard<std::mutex> lock(mutex);
+    while (!events.empty()) {
+        out.push_back(std::move(events.front()));
+        events.pop_front();
+    }
+    pendingOutput = 0;
+    pendingOutputBytes = 0;
+}
+
+uint64_t Job::takeDroppedOutput() {
+    std::lock_guard<std::mutex> lock(mutex);
+    uint64_t lines = droppedOutput;
+    droppedOutput = 0;
+    return lines;
+}
+
+void Job::post(JobEvent::Type type, const std::string& text) {
+    bool wasEmpty;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        wasEmpty = events.empty();
+        bool isOutput = type == JobEvent::Output || type == JobEvent::Diagnostic;
+        while (isOutput && pendingOutput > 0 &&
+               (pendingOutput == MAX_PENDING_OUTPUT || pendingOutputBytes + text.size() > MAX_PENDING_OUTPUT_BYTES)) {
+            auto oldest = std::find_if(events.begin(), events.end(), [](const JobEvent& event) {
+                return event.type == JobEvent::Output || event.type == JobEvent::Diagnostic;
+            });
+            pendingOutputBytes -= oldest->text.size();
+            events.erase(oldest);
+            pendingOutput--;
+            droppedOutput++;
+        }
+        if (isOutput) {
+            pendingOutput++;
+            pendingOutputBytes += text.size();
+        }
+        events.push_back({type, text});
+    }
+    // One wake-up per batch; the main loop drains everything at once
+    if (wasEmpty && notify) notify();
+}
+
+void Job::output(const std::string& text) {
+    post(JobEvent::Output, text);
+}
+
+void Job::diagnostic(const std::string& text) {
+    post(JobEvent::Diagnostic, text);
+}
+
+void Job::status(const std::string& text) {
+    post(JobEvent::Status, text);
+}
+
+// Cuts one pipe's output into lines. It remembers how far it has looked for
+// a newline, so a long unfinished line is not rescanned on every read, and
+// sends a line that grows past maxBytes on at once, skipping the rest of it
+// up to the next newline.
+struct LineSplitter {
+    explicit LineSplitter(size_t maxBytes) : maxBytes(maxBytes) {}
+
+    size_t maxBytes;
+    std::string pending;     // Read but not yet handed on; ChildProcess::read appends here
+    size_t scanned = 0;      // pending has no newline before this
+    bool skipping = false;   // The current line was already cut short
+
+    // Hands complete lines to onLine and returns how many were cut short
+    uint64_t split(bool fromStderr, const Job::LineHandler& onLine) {
+        uint64_t cut = 0;
+        size_t start = 0;
+        size_t newline;
+        while ((newline = pending.find('\n', std::max(start, scanned))) != std::string::npos) {
+            if (!skipping) {
+                size_t end = newline;
+                if (end > start && pending[end - 1] == '\r') end--;
+                onLine(pending.substr(start, end - start), fromStderr);
+            }
+            skipping = false;
+            start = newline + 1;
+        }
+        if (!skipping && pending.size() - start > maxBytes) {
+            onLine(pending.substr(start, maxBytes), fromStderr);
+            skipping = true;
+            cut++;
+        }
+        if (skipping) {
+            pending.clear();
+        } else {
+            pending.erase(0, start);
+        }
+        scanned = pending.size();
+        return cut;
+    }
+
+    // Whatever is left has no trailing newline
+    void finish(bool fromStderr, const Job::LineHandler& onLine) {
+        if (!skipping && !pending.empty()) onLine(pending, fromStderr);
+        pending.clear();
+    }
+};
+
+ProcessResult Job::runProcess(const ProcessOptions& options, int timeoutMs, const LineHandler& onLine,
+                              size_t maxLineBytes) {
+    ProcessResult result;
+    ChildProcess process;
+    std::string error;
+    auto begin = std::chrono::steady_clock::now();
+
+    if (cancelled()) {
+        result.cancelled = true;
+        return result;
+    }
+    if (!process.start(options, error)) {
+        onLine(error, true);
+        return result;
+    }
+    result.started = true;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        children.push_back(&process);
+    }
+    // cancel() may have run between the check above and publishing the child
+    if (cancelled()) process.kill();
+
+    auto enforceTimeout = [&]() {
+        auto elapsed = std::chrono::steady_clock::now() - begin;
+        if (timeoutMs > 0 && !result.timedOut && elapsed > std::chrono::milliseconds(timeoutMs)) {
+            result.timedOut = true;
+            process.kill();
+        }
+    };
+
+    LineSplitter out(maxLineBytes), err(maxLineBytes);
+    while (process.read(READ_SLICE_MS, out.pending, err.pending)) {
+        uint64_t cut = out.split(false, onLine) + err.split(true, onLine);
+        if (cut > 0) {
+            std::lock_guard<std::mutex> lock(mutex);
+            droppedOutput += cut;
+        }
+        enforceTimeout();
+    }
+    out.finish(false, onLine);
+    err.finish(true, onLine);
+
+    // A child can close its output and keep running; it stays in children,
+    // where cancel() can reach it, and under the timeout until it exits
+    while (!process.exited(READ_SLICE_MS)) enforceTimeout();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        children.erase(std::find(children.begin(), children.end(), &process));
+    }
+    result.exitCode = process.wait();
+    result.usage = process.usage();
+    result.cancelled = cancelled();
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    return result;
+}
@@ -0,0 +1,101 @@
+#ifndef JOBS_HPP
+#define JOBS_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "process.hpp"
+
+// Something a background job wants the UI to know about
+struct JobEvent {
+    enum Type { Output, Diagnostic, Status, Finished };  // Diagnostic text is a formatDiagnostic line
+
+    Type type;
+    std::string text;
+};
+
+// Outcome of one child process run by a job
+struct ProcessResult {
+    bool started = false;
+    bool timedOut = false;
+    bool cancelled = false;
+    int exitCode = -1;
+    double seconds = 0.0;
+    ResourceUsage usage;
+};
+
+// Runs one task at a time on a worker thread. The task talks to the UI only
+// through events, which the main loop drains with poll(); every posted event
+// also calls the notify callback so a sleeping event loop wakes up.
+class Job {
+public:
+    using Task = std::function<void(Job&)>;
+    using LineHandler = std::function<void(const std::string& line, bool fromStderr)>;
+
+    explicit Job(std::function<void()> notify);
+    Job(const Job&) = delete;
+    Job& operator=(const Job&) = delete;
+    ~Job();
+
+    // Starts the task unless one is still running
+    bool start(const std::string& name, Task task);
+
+    // Asks the task to stop and kills the children it is waiting on
+    void cancel();
+
+    // Blocks until the worker thread has finished
+    void wait();
+
+    bool running() const { return busy.load(); }
+    bool cancelled() const { return cancelRequested.load(); }
+    const std::string& name() const { return jobName; }
+    double elapsedSeconds() const;
+
+    // Main thread: moves pending events into events
+    void poll(std::vector<JobEvent>& events);
+
+    // Main thread: output lines thrown away because the UI fell behind, plus
+    // the lines runProcess cut short
+    uint64_t takeDroppedOutput();
+
+    // --------- Worker Side ---------
+    // All of a line the console keeps
+    static constexpr size_t MAX_LINE_BYTES = 4096;
+
+    // Runs a child to completion, calling onLine for every line it prints.
+    // A line longer than maxLineBytes is handed on as soon as it gets there
+    // and the rest of it is dropped. The child is killed when timeoutMs
+    // passes (0 means no limit) or the job is cancelled. A task may call
+    // this from several threads at once.
+    ProcessResult runProcess(const ProcessOptions& options, int timeoutMs, const LineHandler& onLine,
+                             size_t maxLineBytes = MAX_LINE_BYTES);
+
+    void output(const std::string& text);
+    void diagnostic(const std::string& text);
+    void status(const std::string& text);
+
+private:
+    void post(JobEvent::Type type, const std::string& text);
+
+    std::function<void()> notify;
+    std::thread worker;
+    std::atomic<bool> busy{false};
+    std::atomic<bool> cancelRequested{false};
+    std::string jobName;
+    std::chrono::steady_clock::time_point startTime;
+
+    std::mutex mutex;                 // Guards events and children
+    std::deque<JobEvent> events;
+    size_t pendingOutput = 0;         // Output and Diagnostic events in events, and their bytes
+    size_t pendingOutputBytes = 0;
+    uint64_t droppedOutput = 0;
+    std::vector<ChildProcess*> children;  // The processes runProcess calls are waiting on
+};
+
+#endif // JOBS_HPP
@@ -0,0 +1,86 @@
+#include "line_layout.hpp"
+
+// --------- Line Layout ---------
+size_t LineLayout::columnAt(int px) const {
+    if (px <= 0) return 0;
+    // First boundary right of px; the character under px starts at the
+    // boundary before it
+    size_t right = std::upper_bound(x.begin(), x.end(), px) - x.begin();
+    if (right == x.size()) right = x.size() - 1;
+    size_t left = right > 0 ? right - 1 : 0;
+    while (left > 0 && x[left - 1] == x[left]) left--;   // Back to the first byte of the character
+    if (px - x[left] <= x[right] - px) right = left;
+    while (right > 0 && x[right - 1] == x[right]) right--;
+    return right;
+}
+
+size_t LineLayout::visibleEnd(int px) const {
+    return std::lower_bound(x.begin(), x.end() - 1, px) - x.begin();
+}
+
+// --------- Cache ---------
+LineLayoutCache::LineLayoutCache(size_t capacity) : capacity(std::max<size_t>(1, capacity)) {}
+
+void LineLayoutCache::clear() {
+    entries.clear();
+    slots.clear();
+}
+
+void LineLayoutCache::onEdit(size_t firstLine, size_t removedLines, size_t insertedLines) {
+    size_t removeEnd = firstLine + removedLines;
+    size_t kept = 0;
+    for (size_t k = 0; k < entries.size(); k++) {
+        Entry& entry = entries[k];
+        if (entry.line >= firstLine && entry.line < removeEnd) continue;
+        if (entry.line >= removeEnd) entry.line = entry.line - removedLines + insertedLines;
+        if (kept != k) entries[kept] = std::move(entry);
+        kept++;
+    }
+    entries.resize(kept);
+    slots.clear();
+    for (size_t k = 0; k < entries.size(); k++) slots[entries[k].line] = k;
+}
+
+const LineLayout& LineLayoutCache::layout(size_t line, std::string_view text, GlyphAtlas& atlas) {
+    clock++;
+    auto found = slots.find(line);
+    // A length mismatch means an edit was not reported; measure again
+    if (found != slots.end() && entries[found->second].layout.length() == text.size()) {
+        hitCount++;
+        Entry& entry = entries[found->second];
+        entry.lastUse = clock;
+        return entry.layout;
+    }
+    missCount++;
+
+    size_t slot;
+    if (found != slots.end()) {
+        slot = found->second;
+    } else if (entries.size() < capacity) {
+        slot = entries.size();
+        entries.emplace_back();
+    } else {
+        slot = 0;
+        for (size_t k = 1; k < entries.size(); k++) {
+            if (entries[k].lastUse < entries[slot].lastUse) slot = k;
+        }
+        slots.erase(entries[slot].line);
+    }
+    Entry& entry = entries[slot];
+    entry.line = line;
+    entry.lastUse = clock;
+    slots[line] = slot;
+
+    // Line breaks take no space, the same as when the text is drawn
+    std::vector<int>& x = entry.layout.x;
+    x.resize(text.size() + 1);
+    int pen = 0;
+    for (size_t i = 0; i < text.size();) {
+        size_t start = i;
+        Uint32 codepoint = decodeUtf8(text, i);
+        for (size_t k = start; k < i; k++) x[k] = pen;
+        if (codepoint != '\n' && codepoint != '\r') pen += atlas.advance(codepoint);
+    }
+    x[text.size()] = pen;
+    return entry.layout;
+}
@@ -0,0 +1,70 @@
+#ifndef LINE_LAYOUT_HPP
+#define LINE_LAYOUT_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "glyph_atlas.hpp"
+
+// Horizontal positions of the characters of one line, as prefix sums of
+// their glyph advances
+struct LineLayout {
+    // x[k] is where the character holding byte k starts, relative to the
+    // start of the text, so every byte of a UTF-8 sequence shares its
+    // character's position. x.back() is the width of the line.
+    std::vector<int> x;
+
+    size_t length() const { return x.size() - 1; }
+    int width() const { return x.back(); }
+
+    // Pixel offset of a byte column, clamped to the end of the line
+    int columnX(size_t column) const { return x[std::min(column, x.size() - 1)]; }
+
+    // The character boundary nearest to pixel offset px, by binary search
+    size_t columnAt(int px) const;
+
+    // Bytes of the characters that start left of px, which is all of the
+    // line that needs drawing when px is the right edge of the view
+    size_t visibleEnd(int px) const;
+};
+
+// Layouts of recently drawn lines, keyed by line number. A line is measured
+// once and reused until an edit touches it; lines below an edit keep their
+// layouts and are renumbered. The least recently used layout is dropped
+// when the cache is full.
+class LineLayoutCache {
+public:
+    explicit LineLayoutCache(size_t capacity);
+
+    // The whole document was replaced
+    void clear();
+
+    // Call after lines [firstLine, firstLine + removedLines) were replaced
+    // by insertedLines new lines
+    void onEdit(size_t firstLine, size_t removedLines, size_t insertedLines);
+
+    // The layout of line, whose current text is given, measured with atlas
+    // if it is not cached. Valid until the next call.
+    const LineLayout& layout(size_t line, std::string_view text, GlyphAtlas& atlas);
+
+    size_t hits() const { return hitCount; }
+    size_t misses() const { return missCount; }
+
+private:
+    struct Entry {
+        size_t line = 0;
+        uint64_t lastUse = 0;
+        LineLayout layout;
+    };
+
+    size_t capacity;
+    std::vector<Entry> entries;
+    std::unordered_map<size_t, size_t> slots;   // Line to its entry
+    uint64_t clock = 0;
+    size_t hitCount = 0, missCount = 0;
+};
+
+#endif // LINE_LAYOUT_HPP
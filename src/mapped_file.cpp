@@ -0,0 +1,100 @@
+#include "mapped_file.hpp"
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+// --------- Windows Implementation ---------
+bool MappedFile::open(const std::string& path, std::string& error) {
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        error = "Could not open " + path;
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize)) {
+        CloseHandle(file);
+        error = "Could not read the size of " + path;
+        return false;
+    }
+    length = (size_t)fileSize.QuadPart;
+    if (length == 0) {
+        CloseHandle(file);
+        return true;
+    }
+
+    mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);  // The mapping keeps the file open
+    if (!mapping) {
+        error = "Could not map " + path;
+        return false;
+    }
+    bytes = (const char*)MapViewOfFile((HANDLE)mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!bytes) {
+        CloseHandle((HANDLE)mapping);
+        mapping = nullptr;
+        error = "Could not map " + path;
+        return false;
+    }
+    return true;
+}
+
+MappedFile::~MappedFile() {
+    if (bytes) UnmapViewOfFile(bytes);
+    if (mapping) CloseHandle((HANDLE)mapping);
+}
+
+void MappedFile::adviseSequential(bool) const {}
+
+#else
+
+// --------- POSIX Implementation ---------
+bool MappedFile::open(const std::string& path, std::string& error) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        error = "Could not open " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        error = "Could not stat " + path + ": " + std::strerror(errno);
+        ::close(fd);
+        return false;
+    }
+    length = (size_t)info.st_size;
+    if (length == 0) {
+        ::close(fd);
+        return true;
+    }
+
+    void* address = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);  // The mapping holds its own reference to the file
+    if (address == MAP_FAILED) {
+        error = "Could not map " + path + ": " + std::strerror(errno);
+        length = 0;
+        return false;
+    }
+    bytes = (const char*)address;
+    return true;
+}
+
+MappedFile::~MappedFile() {
+    if (bytes) munmap((void*)bytes, length);
+}
+
+void MappedFile::adviseSequential(bool sequential) const {
+    if (bytes) madvise((void*)bytes, length, sequential ? MADV_SEQUENTIAL : MADV_NORMAL);
+}
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <string>
+
+// A read-only memory mapping of a whole file. Pages are loaded by the OS as
+// they are touched, so opening costs nothing up front and untouched parts of
+// the file never take memory.
+class MappedFile {
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile();
+
+    bool open(const std::string& path, std::string& error);
+
+    const char* data() const { return bytes; }
+    size_t size() const { return length; }
+
+    // Hints that the mapping will be read front to back (or not)
+    void adviseSequential(bool sequential) const;
+
+private:
+    const char* bytes = nullptr;
+    size_t length = 0;
+#ifdef _WIN32
+    void* mapping = nullptr;   // HANDLE
+#endif
+};
+
+#endif // MAPPED_FILE_HPP
@@ -0,0 +1,120 @@
+#include "newline_scan.hpp"
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__)
+#define NEWLINE_SCAN_X86 1
+#include <immintrin.h>
+#endif
+
+// Below this a single thread finishes before extra threads would start
+const size_t PARALLEL_SCAN_BYTES = 8 * 1024 * 1024;
+const unsigned MAX_SCAN_THREADS = 8;
+
+static void scanScalar(const char* data, size_t from, size_t to, std::vector<uint32_t>& out) {
+    const char* end = data + to;
+    for (const char* p = data + from; p < end; p++) {
+        p = (const char*)std::memchr(p, '\n', end - p);
+        if (!p) break;
+        out.push_back((uint32_t)(p - data));
+    }
+}
+
+#ifdef NEWLINE_SCAN_X86
+
+static inline int lowestBit(unsigned mask) {
+#if defined(__GNUC__)
+    return __builtin_ctz(mask);
+#else
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return (int)index;
+#endif
+}
+
+// 16 bytes per compare; the movemask has one bit per newline
+static void scanSse2(const char* data, size_t from, size_t to, std::vector<uint32_t>& out) {
+    const __m128i newline = _mm_set1_epi8('\n');
+    size_t i = from;
+    for (; i + 16 <= to; i += 16) {
+        __m128i bytes = _mm_loadu_si128((const __m128i*)(data + i));
+        unsigned mask = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, newline));
+        while (mask) {
+            out.push_back((uint32_t)(i + lowestBit(mask)));
+            mask &= mask - 1;
+        }
+    }
+    scanScalar(data, i, to, out);
+}
+
+#if defined(__GNUC__)
+#define NEWLINE_SCAN_AVX2 1
+
+__attribute__((target("avx2")))
+static void scanAvx2(const char* data, size_t from, size_t to, std::vector<uint32_t>& out) {
+    const __m256i newline = _mm256_set1_epi8('\n');
+    size_t i = from;
+    for (; i + 32 <= to; i += 32) {
+        __m256i bytes = _mm256_loadu_si256((const __m256i*)(data + i));
+        unsigned mask = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, newline));
+        while (mask) {
+            out.push_back((uint32_t)(i + __builtin_ctz(mask)));
+            mask &= mask - 1;
+        }
+    }
+    scanSse2(data, i, to, out);
+}
+#endif
+
+#endif // NEWLINE_SCAN_X86
+
+using ScanFunction = void (*)(const char*, size_t, size_t, std::vector<uint32_t>&);
+
+static ScanFunction bestScanner() {
+#if defined(NEWLINE_SCAN_AVX2)
+    if (__builtin_cpu_supports("avx2")) return scanAvx2;
+#endif
+#if defined(NEWLINE_SCAN_X86)
+    return scanSse2;
+#else
+    return scanScalar;
+#endif
+}
+
+void findNewlines(const char* data, size_t from, size_t size, std::vector<uint32_t>& out) {
+    static const ScanFunction scan = bestScanner();
+    if (from >= size) return;
+
+    size_t bytes = size - from;
+    unsigned threads = std::min(MAX_SCAN_THREADS, std::max(1u, std::thread::hardware_concurrency()));
+    if (bytes < PARALLEL_SCAN_BYTES || threads == 1) {
+        scan(data, from, size, out);
+        return;
+    }
+
+    // Each thread scans its own slice into its own list; the lists are
+    // already in order, so joining them is a concatenation
+    std::vector<std::vector<uint32_t>> parts(threads);
+    std::vector<std::thread> workers;
+    size_t slice = (bytes + threads - 1) / threads;
+    for (unsigned t = 0; t < threads; t++) {
+        size_t begin = from + std::min(bytes, t * slice);
+        size_t end = from + std::min(bytes, (t + 1) * slice);
+        workers.emplace_back([&, t, begin, end]() {
+            parts[t].reserve((end - begin) / 64);
+            scan(data, begin, end, parts[t]);
+        });
+    }
+    size_t total = out.size();
+    for (unsigned t = 0; t < threads; t++) {
+        workers[t].join();
+        total += parts[t].size();
+    }
+
+    out.reserve(total);
+    for (std::vector<uint32_t>& part : parts) {
+        out.insert(out.end(), part.begin(), part.end());
+        std::vector<uint32_t>().swap(part);
+    }
+}
@@ -0,0 +1,13 @@
+#ifndef NEWLINE_SCAN_HPP
+#define NEWLINE_SCAN_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Appends the offset of every '\n' in data[from, size) to out, in order.
+// Uses AVX2 or SSE2 when the CPU has them; large inputs are split across
+// threads. Offsets must fit in 32 bits.
+void findNewlines(const char* data, size_t from, size_t size, std::vector<uint32_t>& out);
+
+#endif // NEWLINE_SCAN_HPP
@@ -0,0 +1,138 @@
+#include "pch.hpp"
+#include "compile.hpp"
+#include "sha256.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+
+namespace fs = std::filesystem;
+
+const char* PCH_DIR = ".ide_pch";
+const char* PCH_HEADER_NAME = "ide_pch.hpp";
+const size_t PCH_MAX_ENTRIES = 3;  // A .gch of <bits/stdc++.h> alone can pass 100 MB
+
+static std::string_view trim(std::string_view line) {
+    size_t start = line.find_first_not_of(" \t\r");
+    if (start == std::string_view::npos) return std::string_view();
+    size_t end = line.find_last_not_of(" \t\r");
+    return line.substr(start, end - start + 1);
+}
+
+// Only system headers are precompiled: a local header can change without
+// the source changing, and the key would not notice
+static bool isSystemInclude(std::string_view line) {
+    if (line.empty() || line[0] != '#') return false;
+    line = trim(line.substr(1));
+    if (line.substr(0, 7) != "include") return false;
+    line = trim(line.substr(7));
+    return !line.empty() && line[0] == '<' && line.find('>') != std::string_view::npos;
+}
+
+std::string leadingIncludeBlock(std::string_view source) {
+    std::string block;
+    size_t start = 0;
+    while (start < source.size()) {
+        size_t end = source.find('\n', start);
+        if (end == std::string_view::npos) end = source.size();
+        std::string_view line = trim(source.substr(start, end - start));
+        start = end + 1;
+
+        if (line.empty() || line.substr(0, 2) == "//") continue;
+        if (line.substr(0, 2) == "/*" && line.find("*/") == line.size() - 2) continue;
+        if (!isSystemInclude(line)) break;
+        block.append(line);
+        block += '\n';
+    }
+    return block;
+}
+
+bool findPrecompiledHeader(std::string_view source, const std::string& compiler,
+                           const std::vector<std::string>& flags, PrecompiledHeader& pch) {
+    std::string block = leadingIncludeBlock(source);
+    if (block.empty()) return false;
+
+    Sha256 hash;
+    hash.update(compilerVersion(compiler));
+    hash.update(std::string_view("\0", 1));
+    for (const std::string& flag : flags) {
+        hash.update(flag);
+        hash.update(std::string_view("\0", 1));
+    }
+    hash.update(block);
+
+    fs::path directory = fs::path(PCH_DIR) / hash.hexDigest();
+    pch.directory = directory.string();
+    pch.header = (directory / PCH_HEADER_NAME).string();
+    pch.includes = block;
+
+    std::error_code ec;
+    pch.ready = fs::exists(pch.header + ".gch", ec);
+    if (pch.ready) fs::last_write_time(directory, fs::file_time_type::clock::now(), ec);
+    return true;
+}
+
+std::vector<std::string> precompiledHeaderCommand(const PrecompiledHeader& pch, const std::string& compiler,
+                                                  const std::vector<std::string>& flags) {
+    std::error_code ec;
+    fs::create_directories(pch.directory, ec);
+    std::ofstream file(pch.header, std::ios::binary);
+    file << pch.includes;
+    file.close();
+
+    std::vector<std::string> command = {compiler};
+    command.insert(command.end(), flags.begin(), flags.end());
+    command.insert(command.end(), {"-x", "c++-header", pch.header, "-o", pch.header + ".gch.tmp"});
+    return command;
+}
+
+bool finishPrecompiledHeader(PrecompiledHeader& pch, int exitCode) {
+    std::error_code ec;
+    std::string staging = pch.header + ".gch.tmp";
+    if (exitCode != 0) {
+        fs::remove(staging, ec);
+        return false;
+    }
+    fs::rename(staging, pch.header + ".gch", ec);
+    pch.ready = !ec;
+
+    // Keep only the most recently used headers
+    std::vector<std::pair<fs::file_time_type, fs::path>> entries;
+    for (const fs::directory_entry& entry : fs::directory_iterator(PCH_DIR, ec)) {
+        if (entry.is_directory(ec)) entries.push_back({fs::last_write_time(entry.path(), ec), entry.path()});
+    }
+    if (entries.size() > PCH_MAX_ENTRIES) {
+        std::sort(entries.begin(), entries.end());
+        for (size_t i = 0; i + PCH_MAX_ENTRIES < entries.size(); i++) {
+            if (entries[i].second != fs::path(pch.directory)) fs::remove_all(entries[i].second, ec);
+        }
+    }
+    return pch.ready;
+}
+
+std::vector<std::string> precompiledHeaderArgs(const PrecompiledHeader& pch) {
+    return {"-include", pch.header, "-Winvalid-pch"};
+}
+
+bool isInvalidPchWarning(const std::string& line) {
+    return line.find("-Winvalid-pch") != std::string::npos;
+}
+
+void discardPrecompiledHeader(PrecompiledHeader& pch) {
+    std::error_code ec;
+    fs::remove(pch.header + ".gch", ec);
+    pch.ready = false;
+}
+
+double pchBaselineSeconds(const PrecompiledHeader& pch) {
+    std::ifstream file(fs::path(pch.directory) / "baseline.txt");
+    double seconds = -1.0;
+    file >> seconds;
+    return file ? seconds : -1.0;
+}
+
+void setPchBaselineSeconds(const PrecompiledHeader& pch, double seconds) {
+    std::error_code ec;
+    fs::create_directories(pch.directory, ec);
+    std::ofstream file(fs::path(pch.directory) / "baseline.txt");
+    file << seconds << '\n';
+}
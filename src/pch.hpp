@@ -0,0 +1,47 @@
+#ifndef PCH_HPP
+#define PCH_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+// A precompiled header for the block of system includes a program starts
+// with. It lives in .ide_pch/<key>/, where the key hashes the include block
+// together with the compiler version and flags, so a change to any of them
+// selects (and later builds) a different header.
+struct PrecompiledHeader {
+    std::string directory;
+    std::string header;   // Pass with -include; g++ picks up header + ".gch"
+    std::string includes; // The include block the header consists of
+    bool ready = false;   // The .gch has been built
+};
+
+// Returns the #include <...> lines at the top of source, skipping blank lines
+// and comments, up to the first line that is anything else
+std::string leadingIncludeBlock(std::string_view source);
+
+// Locates the precompiled header for source. Returns false when the source
+// has no leading include block worth precompiling.
+bool findPrecompiledHeader(std::string_view source, const std::string& compiler,
+                           const std::vector<std::string>& flags, PrecompiledHeader& pch);
+
+// Writes the header and returns the command that compiles it. Run the
+// command, then call finishPrecompiledHeader with its exit code.
+std::vector<std::string> precompiledHeaderCommand(const PrecompiledHeader& pch, const std::string& compiler,
+                                                  const std::vector<std::string>& flags);
+bool finishPrecompiledHeader(PrecompiledHeader& pch, int exitCode);
+
+// Arguments that make a compile use the header
+std::vector<std::string> precompiledHeaderArgs(const PrecompiledHeader& pch);
+
+// True if a diagnostic line says the .gch was rejected; the header is then
+// discarded so it gets rebuilt
+bool isInvalidPchWarning(const std::string& line);
+void discardPrecompiledHeader(PrecompiledHeader& pch);
+
+// Compile time without the header, measured before it was built, for the
+// before/after report. Negative if unknown.
+double pchBaselineSeconds(const PrecompiledHeader& pch);
+void setPchBaselineSeconds(const PrecompiledHeader& pch, double seconds);
+
+#endif // PCH_HPP
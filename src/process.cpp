@@ -0,0 +1,440 @@
+#include "process.hpp"
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+static const size_t READ_CHUNK = 64 * 1024;
+static const long long MEMORY_SAMPLE_NS = 5000000;  // How often read() looks at the child's peak memory
+static const int EXIT_POLL_MS = 5;                  // How often exited() checks on a child that has closed its pipes
+
+std::string joinCommandLine(const std::vector<std::string>& args) {
+    std::string line;
+    for (const std::string& arg : args) {
+        if (!line.empty()) line += ' ';
+        if (!arg.empty() && arg.find_first_of(" \t\"") == std::string::npos) {
+            line += arg;
+            continue;
+        }
+        // Quoting rules understood by both CommandLineToArgvW and POSIX shells
+        line += '"';
+        size_t backslashes = 0;
+        for (char c : arg) {
+            if (c == '\\') {
+                backslashes++;
+            } else {
+                if (c == '"') line.append(backslashes + 1, '\\');
+                backslashes = 0;
+            }
+            line += c;
+        }
+        line.append(backslashes, '\\');
+        line += '"';
+    }
+    return line;
+}
+
+ChildProcess::~ChildProcess() {
+    if (started && !reaped) {
+        kill();
+        wait();
+    }
+    closePipes();
+}
+
+#ifdef _WIN32
+
+// --------- Windows Implementation ---------
+bool ChildProcess::start(const ProcessOptions& options, std::string& error) {
+    SECURITY_ATTRIBUTES inherit = {sizeof(SECURITY_ATTRIBUTES), nullptr, TRUE};
+    HANDLE outWrite = nullptr, errWrite = nullptr;
+    HANDLE outReadHandle = nullptr, errReadHandle = nullptr;
+
+    if (!CreatePipe(&outReadHandle, &outWrite, &inherit, 0)) {
+        error = "Could not create output pipe";
+        return false;
+    }
+    SetHandleInformation(outReadHandle, HANDLE_FLAG_INHERIT, 0);
+    if (!options.mergeStderr) {
+        if (!CreatePipe(&errReadHandle, &errWrite, &inherit, 0)) {
+            CloseHandle(outReadHandle);
+            CloseHandle(outWrite);
+            error = "Could not create error pipe";
+            return false;
+        }
+        SetHandleInformation(errReadHandle, HANDLE_FLAG_INHERIT, 0);
+    }
+
+    const char* inputPath = options.stdinFile.empty() ? "NUL" : options.stdinFile.c_str();
+    HANDLE input = CreateFileA(inputPath, GENERIC_READ, FILE_SHARE_READ, &inherit, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (input == INVALID_HANDLE_VALUE) {
+        input = CreateFileA("NUL", GENERIC_READ, FILE_SHARE_READ, &inherit, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    }
+
+    STARTUPINFOA startup = {};
+    startup.cb = sizeof(startup);
+    startup.dwFlags = STARTF_USESTDHANDLES;
+    startup.hStdInput = input;
+    startup.hStdOutput = outWrite;
+    startup.hStdError = options.mergeStderr ? outWrite : errWrite;
+
+    std::string commandLine = joinCommandLine(options.args);
+    PROCESS_INFORMATION info = {};
+    // A memory limit needs a job object, which the child joins before it runs
+    DWORD flags = CREATE_NO_WINDOW | (options.memoryLimitBytes ? CREATE_SUSPENDED : 0);
+    BOOL created = CreateProcessA(nullptr, &commandLine[0], nullptr, nullptr, TRUE, flags,
+                                  nullptr, nullptr, &startup, &info);
+
+    CloseHandle(outWrite);
+    if (errWrite) CloseHandle(errWrite);
+    if (input != INVALID_HANDLE_VALUE) CloseHandle(input);
+
+    if (!created) {
+        CloseHandle(outReadHandle);
+        if (errReadHandle) CloseHandle(errReadHandle);
+        error = "Could not start " + options.args[0];
+        return false;
+    }
+
+    if (options.memoryLimitBytes) {
+        HANDLE job = CreateJobObjectA(nullptr, nullptr);
+        JOBOBJECT_EXTENDED_LIMIT_INFORMATION limits = {};
+        limits.BasicLimitInformation.LimitFlags = JOB_OBJECT_LIMIT_PROCESS_MEMORY;
+        limits.ProcessMemoryLimit = options.memoryLimitBytes;
+        if (job) {
+            SetInformationJobObject(job, JobObjectExtendedLimitInformation, &limits, sizeof(limits));
+            AssignProcessToJobObject(job, info.hProcess);
+        }
+        limitJob = job;
+        ResumeThread(info.hThread);
+    }
+    CloseHandle(info.hThread);
+    processHandle = info.hProcess;
+    outRead = outReadHandle;
+    errRead = errReadHandle;
+    started = true;
+    reaped = false;
+    return true;
+}
+
+// Anonymous pipes cannot be waited on, so peek at both and sleep briefly
+// between attempts until something arrives or the timeout passes
+bool ChildProcess::read(int timeoutMs, std::string& out, std::string& err) {
+    DWORD startTicks = GetTickCount();
+    char chunk[4096];
+
+    while (outRead || errRead) {
+        bool gotData = false;
+        HANDLE* handles[2] = {(HANDLE*)&outRead, (HANDLE*)&errRead};
+        std::string* targets[2] = {&out, &err};
+
+        for (int k = 0; k < 2; k++) {
+            HANDLE& handle = *handles[k];
+            if (!handle) continue;
+            DWORD available = 0;
+            if (!PeekNamedPipe(handle, nullptr, 0, nullptr, &available, nullptr)) {
+                CloseHandle(handle);
+                handle = nullptr;
+                continue;
+            }
+            while (available > 0) {
+                DWORD got = 0;
+                DWORD want = available < sizeof(chunk) ? available : (DWORD)sizeof(chunk);
+                if (!ReadFile(handle, chunk, want, &got, nullptr) || got == 0) break;
+                targets[k]->append(chunk, got);
+                available -= got;
+                gotData = true;
+            }
+        }
+
+        if (gotData) return true;
+        if (GetTickCount() - startTicks >= (DWORD)timeoutMs) return true;
+        Sleep(5);
+    }
+    return false;
+}
+
+void ChildProcess::kill() {
+    if (started && !reaped) TerminateProcess((HANDLE)processHandle, 1);
+}
+
+bool ChildProcess::exited(int timeoutMs) {
+    if (!started || reaped) return true;
+    return WaitForSingleObject((HANDLE)processHandle, (DWORD)timeoutMs) != WAIT_TIMEOUT;
+}
+
+int ChildProcess::wait() {
+    if (!started) return -1;
+    if (!reaped) {
+        WaitForSingleObject((HANDLE)processHandle, INFINITE);
+        DWORD code = 0;
+        GetExitCodeProcess((HANDLE)processHandle, &code);
+        exitCode = (int)code;
+
+        FILETIME created, exited, kernel, user;
+        if (GetProcessTimes((HANDLE)processHandle, &created, &exited, &kernel, &user)) {
+            auto seconds = [](const FILETIME& time) {
+                return (((unsigned long long)time.dwHighDateTime << 32) | time.dwLowDateTime) / 1e7;
+            };
+            resources.userSeconds = seconds(user);
+            resources.systemSeconds = seconds(kernel);
+        }
+        PROCESS_MEMORY_COUNTERS memory = {};
+        if (K32GetProcessMemoryInfo((HANDLE)processHandle, &memory, sizeof(memory))) {
+            resources.peakMemoryBytes = memory.PeakPagefileUsage;
+        }
+        CloseHandle((HANDLE)processHandle);
+        processHandle = nullptr;
+        if (limitJob) CloseHandle((HANDLE)limitJob);
+        limitJob = nullptr;
+        reaped = true;
+    }
+    return exitCode;
+}
+
+void ChildProcess::closePipes() {
+    if (outRead) CloseHandle((HANDLE)outRead);
+    if (errRead) CloseHandle((HANDLE)errRead);
+    outRead = errRead = nullptr;
+}
+
+#else
+
+// --------- POSIX Implementation ---------
+static long long monotonicNs() {
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+// Peak resident set of the program the child is running now, or 0. Unlike
+// the child's ru_maxrss this excludes the copy of our own memory it was
+// forked with.
+static size_t readPeakResident(pid_t pid) {
+#ifdef __linux__
+    char path[64];
+    std::snprintf(path, sizeof(path), "/proc/%d/status", (int)pid);
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return 0;
+    char text[4096];
+    ssize_t got = ::read(fd, text, sizeof(text) - 1);
+    close(fd);
+    if (got <= 0) return 0;
+    text[got] = '\0';
+    const char* line = std::strstr(text, "VmHWM:");
+    return line ? (size_t)std::strtoull(line + 6, nullptr, 10) * 1024 : 0;
+#else
+    (void)pid;
+    return 0;
+#endif
+}
+
+// Close-on-exec from the start, so a child forked by another thread in the
+// meantime cannot inherit the ends. macOS has no pipe2 and keeps the window.
+static bool makePipe(int fds[2]) {
+#ifdef __APPLE__
+    if (pipe(fds) != 0) return false;
+    fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+    fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+    return true;
+#else
+    return pipe2(fds, O_CLOEXEC) == 0;
+#endif
+}
+
+bool ChildProcess::start(const ProcessOptions& options, std::string& error) {
+    if (options.args.empty()) {
+        error = "No program given";
+        return false;
+    }
+
+    int outPipe[2], errPipe[2] = {-1, -1};
+    if (!makePipe(outPipe)) {
+        error = std::string("Could not create pipe: ") + std::strerror(errno);
+        return false;
+    }
+    if (!options.mergeStderr && !makePipe(errPipe)) {
+        close(outPipe[0]);
+        close(outPipe[1]);
+        error = std::string("Could not create pipe: ") + std::strerror(errno);
+        return false;
+    }
+
+    // Everything the child needs is prepared before fork; only
+    // async-signal-safe calls happen between fork and exec
+    std::vector<char*> argv;
+    for (const std::string& arg : options.args) argv.push_back(const_cast<char*>(arg.c_str()));
+    argv.push_back(nullptr);
+    const char* inputPath = options.stdinFile.empty() ? "/dev/null" : options.stdinFile.c_str();
+    rlimit memoryLimit = {(rlim_t)options.memoryLimitBytes, (rlim_t)options.memoryLimitBytes};
+    rusage self = {};
+    getrusage(RUSAGE_SELF, &self);
+#ifdef __APPLE__
+    forkBaselineBytes = (size_t)self.ru_maxrss;
+#else
+    forkBaselineBytes = (size_t)self.ru_maxrss * 1024;
+#endif
+    sampledPeakBytes = 0;
+    lastSampleNs = 0;
+    resources = ResourceUsage();
+
+    // Closed by the exec, so reading it to the end waits until the child is
+    // running the program rather than a copy of us
+    int execPipe[2] = {-1, -1};
+    if (!makePipe(execPipe)) execPipe[0] = execPipe[1] = -1;
+
+    pid = fork();
+    if (pid < 0) {
+        error = std::string("fork failed: ") + std::strerror(errno);
+        if (execPipe[0] >= 0) {
+            close(execPipe[0]);
+            close(execPipe[1]);
+        }
+        close(outPipe[0]);
+        close(outPipe[1]);
+        if (errPipe[0] >= 0) {
+            close(errPipe[0]);
+            close(errPipe[1]);
+        }
+        return false;
+    }
+
+    if (pid == 0) {
+        setpgid(0, 0);  // Own process group, so kill() also reaches grandchildren
+        int input = open(inputPath, O_RDONLY);
+        if (input < 0) input = open("/dev/null", O_RDONLY);
+        dup2(input, STDIN_FILENO);
+        if (input > STDIN_FILENO) close(input);
+        dup2(outPipe[1], STDOUT_FILENO);
+        dup2(options.mergeStderr ? outPipe[1] : errPipe[1], STDERR_FILENO);
+        if (options.memoryLimitBytes) setrlimit(RLIMIT_AS, &memoryLimit);
+        execvp(argv[0], argv.data());
+
+        const char message[] = "Could not execute program\n";
+        ssize_t ignored = write(STDERR_FILENO, message, sizeof(message) - 1);
+        (void)ignored;
+        _exit(127);
+    }
+
+    setpgid(pid, pid);
+    if (execPipe[0] >= 0) {
+        close(execPipe[1]);
+        char unused;
+        while (::read(execPipe[0], &unused, 1) < 0 && errno == EINTR) {}
+        close(execPipe[0]);
+    }
+    close(outPipe[1]);
+    outFd = outPipe[0];
+    if (errPipe[0] >= 0) {
+        close(errPipe[1]);
+        errFd = errPipe[0];
+    }
+    started = true;
+    reaped = false;
+    return true;
+}
+
+void ChildProcess::sampleMemory() {
+    long long now = monotonicNs();
+    if (reaped || now - lastSampleNs < MEMORY_SAMPLE_NS) return;
+    sampledPeakBytes = std::max(sampledPeakBytes, readPeakResident(pid));
+    lastSampleNs = now;
+}
+
+bool ChildProcess::read(int timeoutMs, std::string& out, std::string& err) {
+    if (outFd < 0 && errFd < 0) return false;
+
+    pollfd fds[2];
+    int count = 0;
+    if (outFd >= 0) fds[count++] = {outFd, POLLIN, 0};
+    if (errFd >= 0) fds[count++] = {errFd, POLLIN, 0};
+
+    // VmHWM only rises, so any sample taken after the peak has it exactly
+    int ready = poll(fds, count, timeoutMs);
+    sampleMemory();
+    if (ready <= 0) return true;
+
+    char chunk[READ_CHUNK];
+    for (int k = 0; k < count; k++) {
+        if (!(fds[k].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+        bool isOut = fds[k].fd == outFd;
+        ssize_t got = ::read(fds[k].fd, chunk, sizeof(chunk));
+        if (got > 0) {
+            (isOut ? out : err).append(chunk, got);
+        } else if (got == 0 || errno != EINTR) {
+            close(fds[k].fd);
+            (isOut ? outFd : errFd) = -1;
+        }
+    }
+    return outFd >= 0 || errFd >= 0;
+}
+
+void ChildProcess::kill() {
+    if (started && !reaped && pid > 0) ::kill(-pid, SIGKILL);
+}
+
+// WNOWAIT leaves the child a zombie, so its pid (and process group) cannot
+// be reused under a concurrent kill() until wait() reaps it
+bool ChildProcess::exited(int timeoutMs) {
+    if (!started || reaped) return true;
+    long long deadline = monotonicNs() + (long long)timeoutMs * 1000000;
+    while (true) {
+        siginfo_t info = {};
+        int status = waitid(P_PID, (id_t)pid, &info, WEXITED | WNOHANG | WNOWAIT);
+        if (status < 0 && errno == EINTR) continue;
+        if (status < 0 || info.si_pid == pid) return true;
+        sampleMemory();
+        if (monotonicNs() >= deadline) return false;
+        poll(nullptr, 0, EXIT_POLL_MS);
+    }
+}
+
+int ChildProcess::wait() {
+    if (!started) return -1;
+    if (!reaped) {
+        int status = 0;
+        rusage usage = {};
+        while (wait4(pid, &status, 0, &usage) < 0 && errno == EINTR) {}
+        exitCode = WIFEXITED(status) ? WEXITSTATUS(status) : -WTERMSIG(status);
+
+        resources.userSeconds = usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6;
+        resources.systemSeconds = usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+#ifdef __APPLE__
+        size_t maxResident = (size_t)usage.ru_maxrss;          // Bytes on macOS
+#else
+        size_t maxResident = (size_t)usage.ru_maxrss * 1024;   // Kilobytes on Linux
+#endif
+#ifdef __linux__
+        // The kernel carries the forked copy's high-water mark across exec,
+        // so ru_maxrss only describes the program once it passes our own peak
+        resources.peakMemoryBytes = maxResident > forkBaselineBytes ? maxResident : sampledPeakBytes;
+#else
+        resources.peakMemoryBytes = maxResident;
+#endif
+        reaped = true;
+    }
+    return exitCode;
+}
+
+void ChildProcess::closePipes() {
+    if (outFd >= 0) close(outFd);
+    if (errFd >= 0) close(errFd);
+    outFd = errFd = -1;
+}
+
+#endif
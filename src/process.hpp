@@ -0,0 +1,82 @@
+#ifndef PROCESS_HPP
+#define PROCESS_HPP
+
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/types.h>
+#endif
+
+// How to launch a child process
+struct ProcessOptions {
+    std::vector<std::string> args;  // args[0] is the program, looked up on PATH
+    std::string stdinFile;          // Read as stdin when set, otherwise stdin is empty
+    bool mergeStderr = false;       // Send stderr down the stdout pipe
+    size_t memoryLimitBytes = 0;    // Address space (POSIX) or committed memory (Windows); 0 for no limit
+};
+
+// What a finished child consumed, as reported by the OS when it was reaped
+struct ResourceUsage {
+    double userSeconds = 0.0;
+    double systemSeconds = 0.0;
+    size_t peakMemoryBytes = 0;     // Peak resident set (POSIX) or peak committed memory (Windows); 0 if unknown
+};
+
+// A child process whose stdout and stderr are read through pipes
+class ChildProcess {
+public:
+    ChildProcess() = default;
+    ChildProcess(const ChildProcess&) = delete;
+    ChildProcess& operator=(const ChildProcess&) = delete;
+    ~ChildProcess();
+
+    bool start(const ProcessOptions& options, std::string& error);
+
+    // Waits up to timeoutMs for output and appends whatever arrived. Returns
+    // false once both pipes are closed and nothing more will come.
+    bool read(int timeoutMs, std::string& out, std::string& err);
+
+    // Kills the child (and on POSIX its whole process group)
+    void kill();
+
+    // Waits up to timeoutMs for the child to exit without reaping it, so
+    // kill() stays safe to call from another thread. Returns true once it
+    // has exited and wait() will not block.
+    bool exited(int timeoutMs);
+
+    // Reaps the child and returns its exit code, or -signal if it was killed
+    int wait();
+
+    // Valid once wait() has returned
+    const ResourceUsage& usage() const { return resources; }
+
+private:
+    void closePipes();
+#ifndef _WIN32
+    void sampleMemory();
+#endif
+
+#ifdef _WIN32
+    void* processHandle = nullptr;  // Win32 HANDLEs, kept opaque to spare users <windows.h>
+    void* outRead = nullptr;
+    void* errRead = nullptr;
+    void* limitJob = nullptr;       // Job object enforcing memoryLimitBytes
+#else
+    pid_t pid = -1;
+    int outFd = -1;
+    int errFd = -1;
+    size_t forkBaselineBytes = 0;   // Our own peak RSS when the child was forked
+    size_t sampledPeakBytes = 0;    // Largest VmHWM read while the child ran (Linux)
+    long long lastSampleNs = 0;
+#endif
+    bool started = false;
+    bool reaped = false;
+    int exitCode = -1;
+    ResourceUsage resources;
+};
+
+// Quotes an argument list into a single command line for display or logging
+std::string joinCommandLine(const std::vector<std::string>& args);
+
+#endif // PROCESS_HPP
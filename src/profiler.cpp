@@ -0,0 +1,480 @@
+#include "profiler.hpp"
+#include "trace.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+
+namespace fs = std::filesystem;
+
+// Linked into sampling builds. The CPU-time timer's handler stores the
+// interrupted program counter and, while it stays inside the program's own
+// code, the return addresses found by following the frame pointers. The
+// samples are written out when the program exits normally.
+static const char* SAMPLER_SOURCE = R"(// Written by the IDE's profiler; linked into profiling builds only
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <link.h>
+#include <sys/time.h>
+#include <ucontext.h>
+
+namespace {
+const int MAX_SAMPLES = 65536;
+const int MAX_DEPTH = 8;
+const int STACK_SCAN = 256;   // Words searched for a return into the program
+uintptr_t samples[MAX_SAMPLES][MAX_DEPTH];
+volatile sig_atomic_t sampleCount = 0;
+uintptr_t loadBias = 0, textStart = 0, textEnd = 0;
+uintptr_t stackLow = 0, stackHigh = 0;   // The main thread's stack
+
+int findText(dl_phdr_info* info, size_t, void*) {
+    // The first object is the program itself
+    loadBias = info->dlpi_addr;
+    for (int i = 0; i < info->dlpi_phnum; i++) {
+        const ElfW(Phdr)& segment = info->dlpi_phdr[i];
+        if (segment.p_type != PT_LOAD || !(segment.p_flags & PF_X)) continue;
+        uintptr_t start = info->dlpi_addr + segment.p_vaddr;
+        if (!textStart || start < textStart) textStart = start;
+        if (start + segment.p_memsz > textEnd) textEnd = start + segment.p_memsz;
+    }
+    return 1;
+}
+
+void findStack() {
+    FILE* maps = std::fopen("/proc/self/maps", "r");
+    if (!maps) return;
+    char line[512];
+    while (std::fgets(line, sizeof(line), maps)) {
+        unsigned long low, high;
+        if (std::strstr(line, "[stack]") && std::sscanf(line, "%lx-%lx", &low, &high) == 2) {
+            stackLow = low;
+            stackHigh = high;
+        }
+    }
+    std::fclose(maps);
+}
+
+bool inProgram(uintptr_t address) {
+    return address >= textStart && address < textEnd;
+}
+
+bool returnsFromCall(uintptr_t address) {
+    if (!inProgram(address) || address < textStart + 5) return false;
+#if defined(__x86_64__)
+    const unsigned char* code = (const unsigned char*)address;
+    return code[-5] == 0xe8 || (code[-2] == 0xff && (code[-1] & 0xf8) == 0xd0);   // call rel32, call *reg
+#elif defined(__aarch64__)
+    uint32_t call = *(const uint32_t*)(address - 4);
+    return (call & 0xfc000000) == 0x94000000 || (call & 0xfffffc1f) == 0xd63f0000;   // bl, blr
+#else
+    return false;
+#endif
+}
+
+bool onStack(uintptr_t frame, uintptr_t sp) {
+    return frame >= sp && frame >= stackLow && frame + 2 * sizeof(uintptr_t) <= stackHigh;
+}
+
+void onSample(int, siginfo_t*, void* context) {
+    int n = sampleCount;
+    if (n >= MAX_SAMPLES) return;
+    const mcontext_t& machine = ((ucontext_t*)context)->uc_mcontext;
+#if defined(__x86_64__)
+    uintptr_t pc = machine.gregs[REG_RIP], frame = machine.gregs[REG_RBP], sp = machine.gregs[REG_RSP];
+#elif defined(__aarch64__)
+    uintptr_t pc = machine.pc, frame = machine.regs[29], sp = machine.sp;
+#else
+    uintptr_t pc = 0, frame = 0, sp = 0;
+#endif
+    uintptr_t* stack = samples[n];
+    stack[0] = pc;
+    int depth = 1;
+    if (!inProgram(pc)) {
+        // In a library, whose frames cannot be trusted: the innermost call
+        // from the program is the nearest word on the stack that returns
+        // just after a call instruction in the program's code
+        const uintptr_t* words = (const uintptr_t*)sp;
+        for (int i = 0; i < STACK_SCAN && sp >= stackLow && (uintptr_t)(words + i + 1) <= stackHigh; i++) {
+            if (returnsFromCall(words[i])) {
+                stack[depth++] = words[i];
+                pc = words[i];
+                break;
+            }
+        }
+    }
+    // Library code may use the frame pointer register for anything, so the
+    // chain is only followed from, and through, the program's own functions
+    for (; depth < MAX_DEPTH && inProgram(pc) && onStack(frame, sp); depth++) {
+        const uintptr_t* links = (const uintptr_t*)frame;
+        uintptr_t next = links[0], ret = links[1];
+        if (!inProgram(ret)) break;
+        stack[depth] = ret;
+        if (next <= frame) break;
+        pc = ret;
+        frame = next;
+    }
+    sampleCount = n + 1;
+}
+
+struct Sampler {
+    Sampler() {
+        dl_iterate_phdr(findText, nullptr);
+        findStack();
+        struct sigaction action;
+        std::memset(&action, 0, sizeof(action));
+        action.sa_sigaction = onSample;
+        action.sa_flags = SA_SIGINFO | SA_RESTART;
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGPROF, &action, nullptr);
+        itimerval timer = {{0, @INTERVAL@}, {0, @INTERVAL@}};
+        setitimer(ITIMER_PROF, &timer, nullptr);
+    }
+
+    ~Sampler() {
+        itimerval off;
+        std::memset(&off, 0, sizeof(off));
+        setitimer(ITIMER_PROF, &off, nullptr);
+        FILE* out = std::fopen("@OUTPUT@", "w");
+        if (!out) return;
+        std::fprintf(out, "bias %lx\n", (unsigned long)loadBias);
+        for (int i = 0; i < sampleCount; i++) {
+            for (int depth = 0; depth < MAX_DEPTH && samples[i][depth]; depth++) {
+                std::fprintf(out, "%lx ", (unsigned long)samples[i][depth]);
+            }
+            std::fputc('\n', out);
+        }
+        std::fclose(out);
+    }
+} sampler;
+}
+)";
+
+static void replaceAll(std::string& text, const std::string& from, const std::string& to) {
+    for (size_t at = text.find(from); at != std::string::npos; at = text.find(from, at + to.size())) {
+        text.replace(at, from.size(), to);
+    }
+}
+
+static std::vector<std::string> readLines(const std::string& path) {
+    std::vector<std::string> lines;
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) lines.push_back(line);
+    return lines;
+}
+
+static bool sameFile(const std::string& reported, const std::string& source) {
+    return fs::path(reported).filename() == fs::path(source).filename();
+}
+
+// Compiles with the configuration's flags and then the extra arguments,
+// keeping the compiler's output
+static bool build(Job& job, const ProfileOptions& options, const std::vector<std::string>& args, ProfileResult& result) {
+    ProcessOptions compileOptions;
+    compileOptions.args = {options.compiler};
+    compileOptions.args.insert(compileOptions.args.end(), options.flags.begin(), options.flags.end());
+    compileOptions.args.insert(compileOptions.args.end(), args.begin(), args.end());
+    compileOptions.mergeStderr = true;
+    ProcessResult compiled;
+    {
+        TRACE_SCOPE("profile compile");
+        compiled = job.runProcess(compileOptions, options.compileTimeoutMs,
+            [&](const std::string& line, bool) { result.compileOutput.push_back(line); });
+    }
+    if (compiled.cancelled) {
+        result.cancelled = true;
+        return false;
+    }
+    if (!compiled.started || compiled.timedOut || compiled.exitCode != 0) {
+        result.failure = compiled.timedOut ? "compile timed out" : "compile failed";
+        return false;
+    }
+    return true;
+}
+
+static bool runOnce(Job& job, const std::string& program, const ProfileOptions& options,
+                    const std::function<void(const std::string&)>& onOutput, ProfileResult& result) {
+    ProcessOptions runOptions;
+#ifdef _WIN32
+    runOptions.args = {program};
+#else
+    runOptions.args = {fs::path(program).is_absolute() ? program : "./" + program};
+#endif
+    runOptions.stdinFile = options.stdinFile;
+    runOptions.mergeStderr = true;
+    ProcessResult ran;
+    {
+        TRACE_SCOPE("profile run");
+        ran = job.runProcess(runOptions, options.runTimeoutMs, [&](const std::string& line, bool) { onOutput(line); });
+    }
+    result.exitCode = ran.exitCode;
+    result.seconds = ran.seconds;
+    if (ran.cancelled) {
+        result.cancelled = true;
+        return false;
+    }
+    if (!ran.started) {
+        result.failure = "could not start the program";
+        return false;
+    }
+    if (ran.timedOut) {
+        result.failure = "the program timed out after " + std::to_string(options.runTimeoutMs / 1000) + "s";
+        return false;
+    }
+    return true;
+}
+
+// --------- Sampling ---------
+#ifndef _WIN32
+// Source locations of program addresses, all looked up by one addr2line.
+// Each address gets its chain of inlined calls, innermost first, since in an
+// optimized build the code of a line is often inlined into another function.
+using InlineChain = std::vector<std::pair<std::string, int>>;
+
+static bool resolveAddresses(Job& job, const std::string& program, const std::vector<uintptr_t>& addresses,
+                             std::vector<InlineChain>& locations) {
+    ProcessOptions options;
+    options.args = {"addr2line", "-a", "-i", "-e", program};
+    char hex[32];
+    for (uintptr_t address : addresses) {
+        std::snprintf(hex, sizeof(hex), "0x%lx", (unsigned long)address);
+        options.args.push_back(hex);
+    }
+    locations.clear();
+    ProcessResult resolved = job.runProcess(options, 30000, [&](const std::string& line, bool fromStderr) {
+        if (fromStderr) return;
+        // -a starts each address's rows with the address itself
+        if (line.compare(0, 2, "0x") == 0) {
+            locations.emplace_back();
+            return;
+        }
+        if (locations.empty()) return;
+        // "file:line", sometimes followed by " (discriminator N)"; "??:0" when unknown
+        std::string location = line.substr(0, line.find(" ("));
+        size_t colon = location.rfind(':');
+        int number = colon == std::string::npos ? 0 : std::atoi(location.c_str() + colon + 1);
+        locations.back().emplace_back(location.substr(0, colon == std::string::npos ? location.size() : colon), number);
+    });
+    return resolved.started && resolved.exitCode == 0 && locations.size() == addresses.size();
+}
+
+// Attributes each sample to the first of its addresses that lies in source,
+// looking through the calls inlined at each
+static bool loadSamples(Job& job, const std::string& samplesPath, const std::string& program, const std::string& source,
+                        ProfileResult& result) {
+    std::ifstream file(samplesPath);
+    std::string line;
+    unsigned long bias = 0;
+    if (!std::getline(file, line) || std::sscanf(line.c_str(), "bias %lx", &bias) != 1) return false;
+
+    // Return addresses point after the call; one byte back is the call itself
+    std::vector<std::vector<uintptr_t>> samples;
+    std::unordered_map<uintptr_t, size_t> index;
+    std::vector<uintptr_t> addresses;
+    while (std::getline(file, line)) {
+        std::istringstream words(line);
+        std::string word;
+        std::vector<uintptr_t> stack;
+        while (words >> word) {
+            uintptr_t address = (uintptr_t)std::strtoull(word.c_str(), nullptr, 16) - bias - (stack.empty() ? 0 : 1);
+            if (index.emplace(address, addresses.size()).second) addresses.push_back(address);
+            stack.push_back(address);
+        }
+        if (!stack.empty()) samples.push_back(std::move(stack));
+    }
+    if (samples.empty()) return true;
+
+    std::vector<InlineChain> locations;
+    {
+        TRACE_SCOPE("addr2line");
+        job.status("Resolving " + std::to_string(addresses.size()) + " addresses...");
+        if (!resolveAddresses(job, program, addresses, locations)) {
+            result.failure = "addr2line could not read the profiling build";
+            return false;
+        }
+    }
+
+    for (const std::vector<uintptr_t>& stack : samples) {
+        result.total++;
+        bool counted = false;
+        for (size_t i = 0; i < stack.size() && !counted; i++) {
+            for (const std::pair<std::string, int>& location : locations[index[stack[i]]]) {
+                if (location.second > 0 && sameFile(location.first, source)) {
+                    size_t line = location.second - 1;
+                    if (line >= result.lineCost.size()) result.lineCost.resize(line + 1);
+                    result.lineCost[line]++;
+                    counted = true;
+                    break;
+                }
+            }
+        }
+        if (!counted) result.outside++;
+    }
+    return true;
+}
+#endif
+
+// --------- Line Counts ---------
+// gcov -t prints each file as "count:line:text" rows after a "Source:" row;
+// a count of "-" is a line with no code and "#####" one that never ran
+static void parseGcov(const std::string& text, const std::string& source, ProfileResult& result) {
+    std::istringstream lines(text);
+    std::string row;
+    bool inSource = false;
+    while (std::getline(lines, row)) {
+        size_t first = row.find(':');
+        if (first == std::string::npos) continue;
+        size_t second = row.find(':', first + 1);
+        if (second == std::string::npos) continue;
+        int number = std::atoi(row.c_str() + first + 1);
+        if (number == 0) {
+            const std::string marker = "Source:";
+            if (row.compare(second + 1, marker.size(), marker) == 0) {
+                inSource = sameFile(row.substr(second + 1 + marker.size()), source);
+            }
+            continue;
+        }
+        if (!inSource) continue;
+        std::string count = row.substr(0, first);
+        count.erase(0, count.find_first_not_of(' '));
+        if (count.empty() || !std::isdigit((unsigned char)count[0])) continue;
+        uint64_t executions = std::strtoull(count.c_str(), nullptr, 10);
+        if (number > (int)result.lineCost.size()) result.lineCost.resize(number);
+        result.lineCost[number - 1] += executions;
+        result.total += executions;
+    }
+}
+
+static bool countLines(Job& job, const std::string& source, const ProfileOptions& options,
+                       const std::function<void(const std::string&)>& onOutput, ProfileResult& result) {
+    std::string program = options.directory + "/coverage.exe";
+    job.status("Building with line counters...");
+    if (!build(job, options, {"-g", "--coverage", source, "-o", program}, result)) return false;
+
+    // Counts add up across runs, so only this run's may be there
+    std::error_code ec;
+    for (const fs::directory_entry& entry : fs::directory_iterator(options.directory, ec)) {
+        if (entry.path().extension() == ".gcda") fs::remove(entry.path(), ec);
+    }
+    job.status("Profiling...");
+    if (!runOnce(job, program, options, onOutput, result)) return false;
+
+    std::string gcda;
+    for (const fs::directory_entry& entry : fs::directory_iterator(options.directory, ec)) {
+        if (entry.path().extension() == ".gcda") gcda = entry.path().generic_string();
+    }
+    if (gcda.empty()) {
+        result.failure = "the program wrote no line counts (it must return from main or call exit)";
+        return false;
+    }
+
+    ProcessOptions gcovOptions;
+    gcovOptions.args = {"gcov", "-t", gcda};
+    std::string report;
+    ProcessResult ran;
+    {
+        TRACE_SCOPE("gcov");
+        ran = job.runProcess(gcovOptions, 30000, [&](const std::string& line, bool fromStderr) {
+            if (!fromStderr) report += line + "\n";
+        });
+    }
+    if (!ran.started || ran.exitCode != 0) {
+        result.failure = "gcov failed";
+        return false;
+    }
+    result.method = ProfileMethod::LineCounts;
+    result.lineCost.clear();
+    result.total = result.outside = 0;
+    parseGcov(report, source, result);
+    return true;
+}
+
+// --------- Profile ---------
+ProfileResult profileProgram(Job& job, const std::string& source, const ProfileOptions& options,
+                             const std::function<void(const std::string&)>& onOutput) {
+    TRACE_SCOPE("profile program");
+    ProfileResult result;
+    std::error_code ec;
+    fs::create_directories(options.directory, ec);
+
+#ifndef _WIN32
+    std::string samplerPath = options.directory + "/sampler.cpp";
+    std::string samplesPath = options.directory + "/samples.txt";
+    std::string program = options.directory + "/profile.exe";
+    std::string sampler = SAMPLER_SOURCE;
+    replaceAll(sampler, "@INTERVAL@", std::to_string(options.sampleIntervalUs));
+    replaceAll(sampler, "@OUTPUT@", samplesPath);
+    std::ofstream(samplerPath, std::ios::binary | std::ios::trunc) << sampler;
+    fs::remove(samplesPath, ec);
+
+    job.status("Building for profiling...");
+    if (!build(job, options, {"-g", "-fno-omit-frame-pointer", source, samplerPath, "-o", program}, result)) {
+        return result;
+    }
+    job.status("Profiling...");
+    if (!runOnce(job, program, options, onOutput, result)) return result;
+    if (!fs::exists(samplesPath, ec)) {
+        result.failure = "the program wrote no samples (it must return from main or call exit)";
+        return result;
+    }
+    if (!loadSamples(job, samplesPath, program, source, result)) return result;
+    if (result.total >= options.minSamples) {
+        result.succeeded = true;
+        return result;
+    }
+    // Too short to sample; count line executions in a second, silent run
+    ProfileResult counted;
+    counted.exitCode = result.exitCode;
+    if (countLines(job, source, options, [](const std::string&) {}, counted)) counted.succeeded = true;
+    counted.seconds = result.seconds;
+    return counted;
+#else
+    // No CPU-time timer signal to sample with
+    if (countLines(job, source, options, onOutput, result)) result.succeeded = true;
+    return result;
+#endif
+}
+
+std::vector<std::string> formatProfile(const ProfileResult& result, const std::string& source, size_t topLines) {
+    std::vector<std::string> lines;
+    char text[200];
+    if (result.method == ProfileMethod::Sampled) {
+        std::snprintf(text, sizeof(text), "Profile: %llu samples over %.2fs of run time",
+                      (unsigned long long)result.total, result.seconds);
+        lines.push_back(text);
+        if (result.outside > 0) {
+            std::snprintf(text, sizeof(text), "  %.1f%% in library code with no caller in %s",
+                          100.0 * result.outside / result.total, source.c_str());
+            lines.push_back(text);
+        }
+    } else {
+        std::snprintf(text, sizeof(text), "Profile: %llu line executions counted by gcov",
+                      (unsigned long long)result.total);
+        lines.push_back(text);
+    }
+
+    std::vector<size_t> order;
+    for (size_t i = 0; i < result.lineCost.size(); i++) {
+        if (result.lineCost[i] > 0) order.push_back(i);
+    }
+    std::stable_sort(order.begin(), order.end(),
+                     [&](size_t a, size_t b) { return result.lineCost[a] > result.lineCost[b]; });
+    if (order.size() > topLines) order.resize(topLines);
+
+    std::vector<std::string> sourceLines = readLines(source);
+    for (size_t line : order) {
+        std::string code = line < sourceLines.size() ? sourceLines[line] : std::string();
+        code.erase(0, code.find_first_not_of(" \t"));
+        if (code.size() > 70) code = code.substr(0, 67) + "...";
+        std::snprintf(text, sizeof(text), "  %5.1f%%  line %zu: %s", 100.0 * result.lineCost[line] / result.total,
+                      line + 1, code.c_str());
+        lines.push_back(text);
+    }
+    return lines;
+}
@@ -0,0 +1,56 @@
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "jobs.hpp"
+
+// How the cost of each line was measured
+enum class ProfileMethod {
+    Sampled,      // Where the program was when a CPU-time timer fired
+    LineCounts    // How often each line ran, from gcov
+};
+
+struct ProfileOptions {
+    std::string compiler = "g++";
+    std::vector<std::string> flags;           // The build configuration's, such as -O2; the profiler adds its own after
+    std::string directory = ".ide_profile";   // Profiling builds, the sampler and its samples
+    std::string stdinFile;
+    int compileTimeoutMs = 60000;
+    int runTimeoutMs = 10000;
+    int sampleIntervalUs = 1000;               // Of CPU time
+    size_t minSamples = 20;                    // Fewer than this and line counts are used instead
+};
+
+struct ProfileResult {
+    bool succeeded = false;
+    bool cancelled = false;
+    std::string failure;                       // Why there is no profile, if there is none
+    std::vector<std::string> compileOutput;    // Everything the compiler printed
+    ProfileMethod method = ProfileMethod::Sampled;
+    std::vector<uint64_t> lineCost;            // Samples or executions of each zero-based source line
+    uint64_t total = 0;                        // Samples, or executions of all lines
+    uint64_t outside = 0;                      // Samples in library code, or in other files with no caller in the source
+    int exitCode = 0;
+    double seconds = 0.0;                      // Of the profiled run
+};
+
+// Builds source with debug information and runs it once, on the job's
+// thread, with onOutput receiving each line the program prints. On POSIX
+// systems a small sampler is linked into the build: a CPU-time timer
+// records the program counter and the callers found through the frame
+// pointers, and addr2line maps each one to a source line. A sample in a
+// header or library function counts for the nearest caller in source, when
+// the frame pointers lead to one. When the run is too short for enough
+// samples, and on Windows, the program is built with --coverage and run
+// again, and gcov's per-line execution counts are the cost instead.
+ProfileResult profileProgram(Job& job, const std::string& source, const ProfileOptions& options,
+                             const std::function<void(const std::string&)>& onOutput);
+
+// Console lines: how the profile was taken, then the costliest topLines
+// lines of source with their share and text
+std::vector<std::string> formatProfile(const ProfileResult& result, const std::string& source, size_t topLines);
+
+#endif // PROFILER_HPP
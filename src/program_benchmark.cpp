@@ -0,0 +1,152 @@
+#include "program_benchmark.hpp"
+#include "trace.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+SampleStats summarizeSamples(std::vector<double> values) {
+    SampleStats stats;
+    if (values.empty()) return stats;
+    std::sort(values.begin(), values.end());
+    auto rank = [&](double percentile) {
+        size_t index = (size_t)std::ceil(percentile / 100.0 * values.size());
+        return values[std::min(values.size() - 1, index > 0 ? index - 1 : 0)];
+    };
+    stats.min = values.front();
+    stats.max = values.back();
+    stats.median = rank(50);
+    stats.p95 = rank(95);
+
+    double sum = 0.0;
+    for (double value : values) sum += value;
+    stats.mean = sum / values.size();
+    double squares = 0.0;
+    for (double value : values) squares += (value - stats.mean) * (value - stats.mean);
+    stats.stddev = values.size() > 1 ? std::sqrt(squares / (values.size() - 1)) : 0.0;
+    return stats;
+}
+
+static std::string describeFailure(const ProcessResult& result, int timeoutMs) {
+    if (!result.started) return "could not start the program";
+    if (result.timedOut) return "timed out after " + std::to_string(timeoutMs / 1000) + "s";
+    if (result.exitCode < 0) return "killed by signal " + std::to_string(-result.exitCode);
+    return "exit code " + std::to_string(result.exitCode);
+}
+
+InputBenchmark benchmarkProgram(Job& job, const std::string& program, const std::string& input,
+                                const BenchmarkOptions& options) {
+    TRACE_SCOPE("benchmark input");
+    InputBenchmark benchmark;
+    benchmark.input = input;
+
+    ProcessOptions runOptions;
+#ifdef _WIN32
+    runOptions.args = {program};
+#else
+    runOptions.args = {"./" + program};
+#endif
+    runOptions.stdinFile = input;
+    runOptions.mergeStderr = true;
+    runOptions.memoryLimitBytes = options.memoryLimitBytes;
+
+    std::vector<double> wall, cpu, user, system, memory;
+    for (int run = 0; run < options.warmupRuns + options.runs; run++) {
+        bool warmup = run < options.warmupRuns;
+        job.status((warmup ? "Warming up " : "Benchmarking ") + input + " " +
+                   std::to_string(warmup ? run + 1 : run - options.warmupRuns + 1) + "/" +
+                   std::to_string(warmup ? options.warmupRuns : options.runs) + "...");
+
+        ProcessResult result = job.runProcess(runOptions, options.timeoutMs, [](const std::string&, bool) {});
+        if (result.cancelled) {
+            benchmark.failure = "cancelled";
+            break;
+        }
+        if (!result.started || result.timedOut || result.exitCode != 0) {
+            benchmark.failure = describeFailure(result, options.timeoutMs);
+            if (options.memoryLimitBytes && result.usage.peakMemoryBytes * 10 >= options.memoryLimitBytes * 9) {
+                benchmark.failure += " (near the memory limit)";
+            }
+            break;
+        }
+        if (warmup) continue;
+
+        wall.push_back(result.seconds);
+        user.push_back(result.usage.userSeconds);
+        system.push_back(result.usage.systemSeconds);
+        cpu.push_back(result.usage.userSeconds + result.usage.systemSeconds);
+        if (result.usage.peakMemoryBytes > 0) memory.push_back((double)result.usage.peakMemoryBytes);
+    }
+
+    benchmark.runs = (int)wall.size();
+    benchmark.wall = summarizeSamples(wall);
+    benchmark.cpu = summarizeSamples(cpu);
+    benchmark.user = summarizeSamples(user);
+    benchmark.system = summarizeSamples(system);
+    benchmark.memory = summarizeSamples(memory);
+    return benchmark;
+}
+
+std::vector<std::string> benchmarkInputs(const std::string& defaultInput, const std::string& directory) {
+    std::vector<std::string> inputs;
+    std::error_code ec;
+    if (fs::is_directory(directory, ec)) {
+        for (const fs::directory_entry& entry : fs::directory_iterator(directory, ec)) {
+            if (entry.is_regular_file(ec)) inputs.push_back(entry.path().generic_string());
+        }
+        std::sort(inputs.begin(), inputs.end());
+    }
+    if (inputs.empty()) inputs.push_back(defaultInput);
+    return inputs;
+}
+
+// --------- Report ---------
+static std::string statsLine(const char* label, const SampleStats& stats, double scale, const char* unit) {
+    char line[160];
+    double spread = stats.mean > 0 ? stats.stddev / stats.mean * 100.0 : 0.0;
+    std::snprintf(line, sizeof(line), "  %-7s min %.2f %s   median %.2f %s   p95 %.2f %s   spread %.1f%%", label,
+                  stats.min * scale, unit, stats.median * scale, unit, stats.p95 * scale, unit, spread);
+    return line;
+}
+
+std::vector<std::string> formatBenchmark(const InputBenchmark& result, int warmupRuns, const InputBenchmark* previous,
+                                         const std::string& previousLabel) {
+    std::vector<std::string> lines;
+    lines.push_back("Benchmark " + result.input + ": " + std::to_string(result.runs) + " runs after " +
+                    std::to_string(warmupRuns) + " warmup");
+    if (result.runs > 0) {
+        lines.push_back(statsLine("wall", result.wall, 1000.0, "ms"));
+        lines.push_back(statsLine("cpu", result.cpu, 1000.0, "ms"));
+        char split[96];
+        std::snprintf(split, sizeof(split), "          (median user %.2f ms, sys %.2f ms)", result.user.median * 1000.0,
+                      result.system.median * 1000.0);
+        lines.push_back(split);
+        if (result.memory.max > 0) {
+            lines.push_back(statsLine("memory", result.memory, 1.0 / (1024 * 1024), "MB"));
+        } else {
+            lines.push_back("  memory  not measured (runs too short to sample and smaller than the IDE)");
+        }
+    }
+
+    // A change counts only when the two runs' ranges do not overlap
+    if (previous && previous->runs > 0 && result.runs > 0) {
+        double before = previous->wall.median, after = result.wall.median;
+        const char* verdict = "within noise";
+        if (result.wall.p95 < previous->wall.min) verdict = "faster";
+        if (result.wall.min > previous->wall.p95) verdict = "slower";
+        char line[160];
+        std::snprintf(line, sizeof(line), "  vs %s: median %.2f ms -> %.2f ms (%+.1f%%), %s", previousLabel.c_str(),
+                      before * 1000.0, after * 1000.0, before > 0 ? (after - before) / before * 100.0 : 0.0, verdict);
+        std::string comparison = line;
+        if (previous->memory.max > 0 && result.memory.max > 0) {
+            std::snprintf(line, sizeof(line), "; peak memory %.1f -> %.1f MB", previous->memory.median / (1024 * 1024),
+                          result.memory.median / (1024 * 1024));
+            comparison += line;
+        }
+        lines.push_back(comparison);
+    }
+    if (!result.failure.empty()) lines.push_back("Error: " + result.input + ": stopped, " + result.failure);
+    return lines;
+}
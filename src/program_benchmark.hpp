@@ -0,0 +1,52 @@
+#ifndef PROGRAM_BENCHMARK_HPP
+#define PROGRAM_BENCHMARK_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "jobs.hpp"
+
+// Summary of one measured quantity across the timed runs
+struct SampleStats {
+    double min = 0.0;
+    double median = 0.0;
+    double p95 = 0.0;
+    double max = 0.0;
+    double mean = 0.0;
+    double stddev = 0.0;
+};
+
+// Nearest-rank percentiles; all zero for no values
+SampleStats summarizeSamples(std::vector<double> values);
+
+struct BenchmarkOptions {
+    int warmupRuns = 2;                 // Run first and thrown away, to warm caches and the page cache
+    int runs = 10;
+    int timeoutMs = 10000;              // Per run
+    size_t memoryLimitBytes = 0;        // Per run; 0 for no limit
+};
+
+// The timed runs of a program against one input file
+struct InputBenchmark {
+    std::string input;
+    int runs = 0;                       // Timed runs that completed
+    std::string failure;                // Why the runs stopped early, if they did
+    SampleStats wall, cpu, memory;      // Seconds, user + system seconds, peak bytes
+    SampleStats user, system;
+};
+
+// Runs program with input as stdin, warmups first, on the job's thread. The
+// program's output is discarded. Stops at the first run that fails, times
+// out or is cancelled, keeping the runs measured so far.
+InputBenchmark benchmarkProgram(Job& job, const std::string& program, const std::string& input,
+                                const BenchmarkOptions& options);
+
+// defaultInput, or when directory exists, every file in it in name order
+std::vector<std::string> benchmarkInputs(const std::string& defaultInput, const std::string& directory);
+
+// Console lines for one input, compared with an earlier measurement of the
+// same input when previous is given
+std::vector<std::string> formatBenchmark(const InputBenchmark& result, int warmupRuns, const InputBenchmark* previous,
+                                         const std::string& previousLabel);
+
+#endif // PROGRAM_BENCHMARK_HPP
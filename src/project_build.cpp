@@ -0,0 +1,331 @@
+#include "project_build.hpp"
+#include "compile.hpp"
+#include "sha256.hpp"
+#include "trace.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+static std::string trim(const std::string& text) {
+    size_t start = text.find_first_not_of(" \t\r");
+    if (start == std::string::npos) return std::string();
+    size_t end = text.find_last_not_of(" \t\r");
+    return text.substr(start, end - start + 1);
+}
+
+static std::vector<std::string> splitWords(const std::string& text) {
+    std::vector<std::string> words;
+    std::istringstream stream(text);
+    std::string word;
+    while (stream >> word) words.push_back(word);
+    return words;
+}
+
+static bool readFile(const std::string& path, std::string& out) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+    std::stringstream contents;
+    contents << file.rdbuf();
+    out = contents.str();
+    return true;
+}
+
+static void writeFile(const std::string& path, const std::string& text) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << text;
+}
+
+// --------- Manifest ---------
+bool loadProjectManifest(const std::string& path, ProjectManifest& manifest, std::string& error) {
+    std::ifstream file(path);
+    if (!file) {
+        error = "Unable to open " + path;
+        return false;
+    }
+    manifest = ProjectManifest();
+    ProjectOptions& options = manifest.options;
+
+    std::string line;
+    int number = 0;
+    while (std::getline(file, line)) {
+        number++;
+        std::string text = trim(line);
+        if (text.empty() || text[0] == '#') continue;
+
+        size_t equals = text.find('=');
+        if (equals == std::string::npos) {
+            manifest.sources.push_back(text);
+            continue;
+        }
+        std::string key = trim(text.substr(0, equals));
+        std::string value = trim(text.substr(equals + 1));
+        if (key == "compiler") {
+            options.compiler = value;
+        } else if (key == "flags") {
+            options.compileFlags = splitWords(value);
+        } else if (key == "link") {
+            options.linkFlags = splitWords(value);
+        } else if (key == "output") {
+            options.output = value;
+        } else if (key == "jobs") {
+            options.parallelism = (unsigned)std::max(0, std::atoi(value.c_str()));
+        } else {
+            error = path + ":" + std::to_string(number) + ": unknown option '" + key + "'";
+            return false;
+        }
+    }
+    if (manifest.sources.empty()) {
+        error = path + ": no sources listed";
+        return false;
+    }
+    return true;
+}
+
+// --------- Dependency Tracking ---------
+struct Unit {
+    std::string source;
+    std::string object;
+    std::string depfile;
+    std::string stampFile;   // The command the object was last built with
+    std::string stamp;
+    std::vector<std::string> command;
+};
+
+static Unit makeUnit(const std::string& source, const ProjectOptions& options, const std::string& version, bool json) {
+    // Named after the file, plus a hash of its path so that files of the same
+    // name in different directories get different objects
+    Unit unit;
+    unit.source = source;
+    std::string base = options.buildDir + "/" + fs::path(source).stem().string() + "-" + sha256Hex(source).substr(0, 8);
+    unit.object = base + ".o";
+    unit.depfile = base + ".d";
+    unit.stampFile = base + ".cmd";
+
+    unit.command = {options.compiler};
+    unit.command.insert(unit.command.end(), options.compileFlags.begin(), options.compileFlags.end());
+    unit.command.insert(unit.command.end(), {"-c", source, "-o", unit.object, "-MMD", "-MF", unit.depfile});
+    if (json) unit.command.push_back("-fdiagnostics-format=json");
+    unit.stamp = joinCommandLine(unit.command) + "\n" + version + "\n";
+    return unit;
+}
+
+// The prerequisites of the first rule in a make-style depfile, which for
+// -MMD are the source and the non-system headers it included
+static bool readDepfile(const std::string& path, std::vector<std::string>& prerequisites) {
+    std::string text;
+    if (!readFile(path, text)) return false;
+
+    // The target ends at the first colon followed by whitespace, which skips
+    // Windows drive letters
+    size_t colon = text.find(':');
+    while (colon != std::string::npos && colon + 1 < text.size() && !std::isspace((unsigned char)text[colon + 1])) {
+        colon = text.find(':', colon + 1);
+    }
+    if (colon == std::string::npos) return false;
+
+    std::string current;
+    auto flush = [&]() {
+        if (!current.empty()) prerequisites.push_back(std::move(current));
+        current.clear();
+    };
+    for (size_t i = colon + 1; i < text.size(); i++) {
+        char c = text[i];
+        if (c == '\\' && i + 1 < text.size()) {
+            char next = text[i + 1];
+            if (next == '\n' || next == '\r') {  // Line continuation
+                flush();
+                i++;
+                if (next == '\r' && i + 1 < text.size() && text[i + 1] == '\n') i++;
+                continue;
+            }
+            if (next == ' ' || next == '#') {
+                current += next;
+                i++;
+                continue;
+            }
+            current += c;  // A Windows path separator
+        } else if (c == '$' && i + 1 < text.size() && text[i + 1] == '$') {
+            current += '$';
+            i++;
+        } else if (c == '\n') {
+            break;
+        } else if (c == ' ' || c == '\t' || c == '\r') {
+            flush();
+        } else {
+            current += c;
+        }
+    }
+    flush();
+    return !prerequisites.empty();
+}
+
+static bool isUpToDate(const Unit& unit) {
+    std::error_code ec;
+    fs::file_time_type objectTime = fs::last_write_time(unit.object, ec);
+    if (ec) return false;
+
+    std::string stamp;
+    if (!readFile(unit.stampFile, stamp) || stamp != unit.stamp) return false;
+
+    std::vector<std::string> prerequisites;
+    if (!readDepfile(unit.depfile, prerequisites)) return false;
+    for (const std::string& prerequisite : prerequisites) {
+        fs::file_time_type time = fs::last_write_time(prerequisite, ec);
+        if (ec || time > objectTime) return false;
+    }
+    return true;
+}
+
+// --------- Build ---------
+ProjectResult buildProject(Job& job, const std::vector<std::string>& sources, const ProjectOptions& options,
+                           const std::function<void(const UnitResult&)>& onUnit) {
+    TRACE_SCOPE("build project");
+    auto begin = std::chrono::steady_clock::now();
+    auto elapsed = [&]() { return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count(); };
+    ProjectResult result;
+
+    std::error_code ec;
+    fs::create_directories(options.buildDir, ec);
+    std::string version = compilerVersion(options.compiler);
+    bool json = compilerSupportsJsonDiagnostics(options.compiler);
+
+    std::vector<Unit> units;
+    std::vector<size_t> stale;
+    {
+        TRACE_SCOPE("dependency scan");
+        for (const std::string& source : sources) {
+            units.push_back(makeUnit(source, options, version, json));
+            if (isUpToDate(units.back())) {
+                result.upToDate++;
+            } else {
+                stale.push_back(units.size() - 1);
+            }
+        }
+    }
+
+    // Reports arrive from several workers; the handler sees one at a time
+    std::mutex reportMutex;
+    auto report = [&](const UnitResult& unit) {
+        std::lock_guard<std::mutex> lock(reportMutex);
+        onUnit(unit);
+    };
+
+    std::atomic<size_t> nextUnit{0}, finished{0}, failed{0};
+    auto work = [&]() {
+        for (size_t k; (k = nextUnit++) < stale.size();) {
+            if (job.cancelled()) break;
+            Unit& unit = units[stale[k]];
+            std::error_code removeError;
+            fs::remove(unit.stampFile, removeError);  // Not up to date until this compile succeeds
+
+            ProcessOptions compileOptions;
+            compileOptions.args = unit.command;
+            compileOptions.mergeStderr = true;
+            UnitResult unitResult;
+            unitResult.source = unit.source;
+            ProcessResult compiled;
+            {
+                TRACE_SCOPE("compile unit");
+                compiled = job.runProcess(compileOptions, options.timeoutMs,
+                    [&](const std::string& line, bool) { unitResult.output.push_back(line); },
+                    SIZE_MAX);  // JSON diagnostics arrive as one line
+            }
+            if (compiled.cancelled) break;
+            if (compiled.timedOut) unitResult.output.push_back(unit.source + ": compile timed out");
+            unitResult.succeeded = compiled.started && !compiled.timedOut && compiled.exitCode == 0;
+            unitResult.seconds = compiled.seconds;
+            if (unitResult.succeeded) {
+                writeFile(unit.stampFile, unit.stamp);
+            } else {
+                failed++;
+            }
+            report(unitResult);
+            job.status("Compiling " + std::to_string(++finished) + "/" + std::to_string(stale.size()) + "...");
+        }
+    };
+
+    size_t workers = options.parallelism ? options.parallelism : std::max(1u, std::thread::hardware_concurrency());
+    workers = std::min(workers, stale.size());
+    if (workers > 0) {
+        job.status("Compiling " + std::to_string(stale.size()) + " of " + std::to_string(units.size()) + " units...");
+        // The job's own thread is one of the workers
+        std::vector<std::thread> pool;
+        for (size_t w = 1; w < workers; w++) {
+            pool.emplace_back([&work]() {
+                traceThreadName("compile");
+                work();
+            });
+        }
+        work();
+        for (std::thread& thread : pool) thread.join();
+    }
+
+    result.failed = failed;
+    result.compiled = finished - failed;
+    if (job.cancelled()) {
+        result.cancelled = true;
+        result.seconds = elapsed();
+        return result;
+    }
+    if (result.failed > 0) {
+        result.seconds = elapsed();
+        return result;
+    }
+
+    // --------- Link ---------
+    std::vector<std::string> command = {options.compiler};
+    for (const Unit& unit : units) command.push_back(unit.object);
+    command.insert(command.end(), options.linkFlags.begin(), options.linkFlags.end());
+    command.insert(command.end(), {"-o", options.output});
+    std::string linkStampFile = options.buildDir + "/link.cmd";
+    std::string linkStamp = joinCommandLine(command) + "\n" + version + "\n";
+
+    bool relink = result.compiled > 0;
+    fs::file_time_type outputTime = fs::last_write_time(options.output, ec);
+    std::string stamp;
+    if (ec || !readFile(linkStampFile, stamp) || stamp != linkStamp) relink = true;
+    for (size_t i = 0; i < units.size() && !relink; i++) {
+        fs::file_time_type objectTime = fs::last_write_time(units[i].object, ec);
+        if (ec || objectTime > outputTime) relink = true;
+    }
+
+    if (relink) {
+        job.status("Linking...");
+        fs::remove(linkStampFile, ec);
+        ProcessOptions linkOptions;
+        linkOptions.args = command;
+        linkOptions.mergeStderr = true;
+        UnitResult linkResult;
+        ProcessResult linked;
+        {
+            TRACE_SCOPE("link");
+            linked = job.runProcess(linkOptions, options.timeoutMs,
+                [&](const std::string& line, bool) { linkResult.output.push_back(line); });
+        }
+        if (linked.cancelled) {
+            result.cancelled = true;
+            result.seconds = elapsed();
+            return result;
+        }
+        linkResult.succeeded = linked.started && !linked.timedOut && linked.exitCode == 0;
+        linkResult.seconds = linked.seconds;
+        report(linkResult);
+        if (!linkResult.succeeded) {
+            result.seconds = elapsed();
+            return result;
+        }
+        writeFile(linkStampFile, linkStamp);
+        result.linked = true;
+    }
+    result.succeeded = true;
+    result.seconds = elapsed();
+    return result;
+}
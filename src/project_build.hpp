@@ -0,0 +1,58 @@
+#ifndef PROJECT_BUILD_HPP
+#define PROJECT_BUILD_HPP
+
+#include <functional>
+#include <string>
+#include <vector>
+#include "jobs.hpp"
+
+// How the translation units of a project are compiled and linked
+struct ProjectOptions {
+    std::string compiler = "g++";
+    std::vector<std::string> compileFlags;
+    std::vector<std::string> linkFlags;
+    std::string buildDir = ".ide_build";   // Objects, depfiles and command stamps
+    std::string output = "project_output.exe";
+    unsigned parallelism = 0;              // Compiles at once; 0 uses every core
+    int timeoutMs = 60000;                 // Per compile and for the link
+};
+
+// A project file: one source per line, plus "key = value" options (compiler,
+// flags, link, output, jobs). Blank lines and lines starting with # are
+// skipped.
+struct ProjectManifest {
+    std::vector<std::string> sources;
+    ProjectOptions options;
+};
+
+bool loadProjectManifest(const std::string& path, ProjectManifest& manifest, std::string& error);
+
+// One compile or the link, with everything the compiler printed
+struct UnitResult {
+    std::string source;     // Empty for the link
+    bool succeeded = false;
+    double seconds = 0.0;
+    std::vector<std::string> output;
+};
+
+struct ProjectResult {
+    bool succeeded = false;
+    bool cancelled = false;
+    size_t compiled = 0;    // Units compiled this time
+    size_t upToDate = 0;    // Units whose object was reused
+    size_t failed = 0;
+    bool linked = false;    // False when no object changed and the output was kept
+    double seconds = 0.0;
+};
+
+// Builds sources into options.output on the job's thread. Each unit is
+// compiled to its own object by a bounded pool of workers; a unit is skipped
+// when its object is newer than the source and every header listed in the
+// depfile g++ wrote last time (-MMD), and its command line is unchanged.
+// The objects are linked only if one of them changed or the output is
+// missing. onUnit is called once per finished compile and for the link, one
+// call at a time, as soon as each one ends.
+ProjectResult buildProject(Job& job, const std::vector<std::string>& sources, const ProjectOptions& options,
+                           const std::function<void(const UnitResult&)>& onUnit);
+
+#endif // PROJECT_BUILD_HPP
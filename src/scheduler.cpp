@@ -0,0 +1,51 @@
+#include "scheduler.hpp"
+#include <algorithm>
+#include <atomic>
+
+// Upper bound on a single idle wait, so the loop still turns over now and then
+const int IDLE_WAIT_MS = 1000;
+
+static std::atomic<unsigned> dirtyRegions(DIRTY_ALL);
+static Uint32 wakeEventType = (Uint32)-1;
+static Uint32 wakeDeadline = 0;  // SDL_GetTicks() value, 0 when nothing is scheduled
+
+void initScheduler() {
+    wakeEventType = SDL_RegisterEvents(1);
+}
+
+void markDirty(unsigned regions) {
+    dirtyRegions.fetch_or(regions);
+}
+
+unsigned takeDirty() {
+    return dirtyRegions.exchange(DIRTY_NONE);
+}
+
+void wakeEventLoop() {
+    if (wakeEventType == (Uint32)-1) return;
+    SDL_Event wake;
+    SDL_zero(wake);
+    wake.type = wakeEventType;
+    SDL_PushEvent(&wake);
+}
+
+void scheduleWake(Uint32 delayMs) {
+    Uint32 deadline = SDL_GetTicks() + delayMs;
+    if (wakeDeadline == 0 || SDL_TICKS_PASSED(wakeDeadline, deadline)) {
+        wakeDeadline = deadline;
+    }
+}
+
+bool waitForEvent(SDL_Event& e) {
+    int timeout = IDLE_WAIT_MS;
+    if (wakeDeadline != 0) {
+        Uint32 now = SDL_GetTicks();
+        timeout = SDL_TICKS_PASSED(now, wakeDeadline) ? 0 : std::min<int>(timeout, wakeDeadline - now);
+    }
+
+    int received = (dirtyRegions.load() || timeout == 0) ? SDL_PollEvent(&e) : SDL_WaitEventTimeout(&e, timeout);
+    if (wakeDeadline != 0 && SDL_TICKS_PASSED(SDL_GetTicks(), wakeDeadline)) {
+        wakeDeadline = 0;
+    }
+    return received && e.type != wakeEventType;
+}
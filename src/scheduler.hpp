@@ -0,0 +1,37 @@
+#ifndef SCHEDULER_HPP
+#define SCHEDULER_HPP
+
+#include <SDL2/SDL.h>
+
+// Screen regions that can be redrawn independently
+enum DirtyRegion : unsigned {
+    DIRTY_NONE    = 0,
+    DIRTY_EDITOR  = 1 << 0,
+    DIRTY_GUTTER  = 1 << 1,
+    DIRTY_SIDEBAR = 1 << 2,
+    DIRTY_STATUS  = 1 << 3,
+    DIRTY_ERRORS  = 1 << 4,
+    DIRTY_ALL     = (1 << 5) - 1
+};
+
+// Registers the wake-up event; call once after SDL_Init
+void initScheduler();
+
+// Flags regions for the next frame. Safe to call from any thread.
+void markDirty(unsigned regions);
+
+// Returns the pending regions and clears them
+unsigned takeDirty();
+
+// Wakes the main loop from another thread
+void wakeEventLoop();
+
+// Makes the next wait return after at most delayMs, for redraws driven by
+// time rather than events (such as an elapsed-time counter)
+void scheduleWake(Uint32 delayMs);
+
+// Blocks until an event arrives, returning false if the wait ended without
+// one. Never blocks while something is waiting to be redrawn.
+bool waitForEvent(SDL_Event& e);
+
+#endif // SCHEDULER_HPP
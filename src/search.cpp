@@ -0,0 +1,305 @@
+#include "search.hpp"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__)
+#define SEARCH_X86 1
+#include <immintrin.h>
+#endif
+
+static inline char lowerAscii(char c) {
+    return (c >= 'A' && c <= 'Z') ? (char)(c + ('a' - 'A')) : c;
+}
+
+static inline char upperAscii(char c) {
+    return (c >= 'a' && c <= 'z') ? (char)(c - ('a' - 'A')) : c;
+}
+
+static inline bool isWordChar(char c) {
+    unsigned char u = (unsigned char)c;
+    return (u >= 'a' && u <= 'z') || (u >= 'A' && u <= 'Z') || (u >= '0' && u <= '9') || u == '_' || u >= 0x80;
+}
+
+static bool equalsAt(const char* text, std::string_view needle, bool caseSensitive) {
+    if (caseSensitive) return std::memcmp(text, needle.data(), needle.size()) == 0;
+    for (size_t i = 0; i < needle.size(); i++) {
+        if (lowerAscii(text[i]) != lowerAscii(needle[i])) return false;
+    }
+    return true;
+}
+
+// --------- Literal Search ---------
+static size_t findScalar(std::string_view haystack, std::string_view needle, size_t from, bool caseSensitive) {
+    const char* data = haystack.data();
+    size_t last = haystack.size() - needle.size();  // Last possible start
+    char first = lowerAscii(needle[0]);
+    for (size_t i = from; i <= last; i++) {
+        if (caseSensitive) {
+            const void* hit = std::memchr(data + i, needle[0], last - i + 1);
+            if (!hit) break;
+            i = (const char*)hit - data;
+        } else if (lowerAscii(data[i]) != first) {
+            continue;
+        }
+        if (equalsAt(data + i, needle, caseSensitive)) return i;
+    }
+    return std::string_view::npos;
+}
+
+#ifdef SEARCH_X86
+
+static inline int lowestBit(unsigned mask) {
+#if defined(__GNUC__)
+    return __builtin_ctz(mask);
+#else
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return (int)index;
+#endif
+}
+
+// Tests 16 candidate starts per step: a start survives when both the
+// needle's first byte and its last byte line up, which rejects almost every
+// position before any full comparison
+static size_t findSse2(std::string_view haystack, std::string_view needle, size_t from, bool caseSensitive) {
+    const char* data = haystack.data();
+    size_t n = needle.size();
+    size_t last = haystack.size() - n;
+    char first = needle[0], final = needle[n - 1];
+    __m128i firstLower = _mm_set1_epi8(caseSensitive ? first : lowerAscii(first));
+    __m128i firstUpper = _mm_set1_epi8(caseSensitive ? first : upperAscii(first));
+    __m128i finalLower = _mm_set1_epi8(caseSensitive ? final : lowerAscii(final));
+    __m128i finalUpper = _mm_set1_epi8(caseSensitive ? final : upperAscii(final));
+
+    size_t i = from;
+    for (; i + 15 <= last; i += 16) {
+        __m128i head = _mm_loadu_si128((const __m128i*)(data + i));
+        __m128i tail = _mm_loadu_si128((const __m128i*)(data + i + n - 1));
+        __m128i headHit = _mm_or_si128(_mm_cmpeq_epi8(head, firstLower), _mm_cmpeq_epi8(head, firstUpper));
+        __m128i tailHit = _mm_or_si128(_mm_cmpeq_epi8(tail, finalLower), _mm_cmpeq_epi8(tail, finalUpper));
+        unsigned mask = (unsigned)_mm_movemask_epi8(_mm_and_si128(headHit, tailHit));
+        while (mask) {
+            size_t pos = i + lowestBit(mask);
+            if (equalsAt(data + pos, needle, caseSensitive)) return pos;
+            mask &= mask - 1;
+        }
+    }
+    return findScalar(haystack, needle, i, caseSensitive);
+}
+
+#endif // SEARCH_X86
+
+size_t findLiteral(std::string_view haystack, std::string_view needle, size_t from, bool caseSensitive) {
+    if (needle.empty() || from > haystack.size() || haystack.size() - from < needle.size()) {
+        return std::string_view::npos;
+    }
+#ifdef SEARCH_X86
+    return findSse2(haystack, needle, from, caseSensitive);
+#else
+    return findScalar(haystack, needle, from, caseSensitive);
+#endif
+}
+
+// --------- Query ---------
+bool SearchIndex::setQuery(const std::string& newPattern, SearchOptions newOptions, std::string& error) {
+    clear();
+    if (newPattern.empty()) return true;
+
+    if (newOptions.regex) {
+        try {
+            auto flags = std::regex::ECMAScript | std::regex::optimize;
+            if (!newOptions.caseSensitive) flags |= std::regex::icase;
+            compiled = std::regex(newPattern, flags);
+        } catch (const std::regex_error& e) {
+            error = std::string("Invalid regex: ") + e.what();
+            return false;
+        }
+    }
+    pattern = newPattern;
+    options = newOptions;
+    hasQuery = true;
+    return true;
+}
+
+void SearchIndex::clear() {
+    hasQuery = false;
+    pattern.clear();
+    entries.clear();
+    firstDirty = dirtyCount = total = 0;
+}
+
+bool SearchIndex::isMatch(std::string_view line, size_t column, size_t length) const {
+    if (length == 0) return false;
+    if (!options.wholeWord) return true;
+    bool startsWord = column == 0 || !isWordChar(line[column - 1]);
+    bool endsWord = column + length >= line.size() || !isWordChar(line[column + length]);
+    return startsWord && endsWord;
+}
+
+void SearchIndex::matchLine(std::string_view line, std::vector<SearchMatch>& out) const {
+    out.clear();
+    if (!hasQuery) return;
+
+    if (options.regex) {
+        for (std::cregex_iterator it(line.data(), line.data() + line.size(), compiled), end; it != end; ++it) {
+            size_t column = (size_t)it->position(0), length = (size_t)it->length(0);
+            if (isMatch(line, column, length)) out.push_back({(uint32_t)column, (uint32_t)length});
+        }
+        return;
+    }
+
+    size_t pos = findLiteral(line, pattern, 0, options.caseSensitive);
+    while (pos != std::string_view::npos) {
+        if (isMatch(line, pos, pattern.size())) {
+            out.push_back({(uint32_t)pos, (uint32_t)pattern.size()});
+            pos = findLiteral(line, pattern, pos + pattern.size(), options.caseSensitive);
+        } else {
+            pos = findLiteral(line, pattern, pos + 1, options.caseSensitive);
+        }
+    }
+}
+
+// --------- Incremental Index ---------
+void SearchIndex::reset(size_t lineCount) {
+    entries.clear();
+    if (!hasQuery) return;
+    entries.resize(lineCount);
+    firstDirty = 0;
+    dirtyCount = lineCount;
+    total = 0;
+}
+
+void SearchIndex::onEdit(size_t firstLine, size_t removedLines, size_t insertedLines) {
+    if (!hasQuery) return;
+    if (firstLine >= entries.size()) {
+        dirtyCount += firstLine + 1 - entries.size();
+        entries.resize(firstLine + 1);
+    }
+    size_t removeEnd = std::min(firstLine + removedLines, entries.size());
+    removedLines = removeEnd - firstLine;
+
+    // Removed lines take their matches with them; surviving lines are rescanned
+    for (size_t k = firstLine; k < removeEnd; k++) {
+        total -= entries[k].matches.size();
+        entries[k].matches.clear();
+        if (entries[k].dirty) dirtyCount--;
+        entries[k].dirty = true;
+    }
+    size_t common = std::min(removedLines, insertedLines);
+    dirtyCount += common;
+    if (insertedLines > removedLines) {
+        entries.insert(entries.begin() + removeEnd, insertedLines - removedLines, LineEntry());
+        dirtyCount += insertedLines - removedLines;
+    } else if (removedLines > insertedLines) {
+        entries.erase(entries.begin() + firstLine + common, entries.begin() + removeEnd);
+    }
+    firstDirty = std::min(firstDirty, firstLine);
+}
+
+void SearchIndex::refresh(const TextBuffer& buffer) {
+    if (!hasQuery) return;
+    if (entries.size() != buffer.lineCount()) reset(buffer.lineCount());
+
+    for (size_t i = firstDirty; i < entries.size() && dirtyCount > 0; i++) {
+        LineEntry& entry = entries[i];
+        if (!entry.dirty) continue;
+        total -= entry.matches.size();
+        matchLine(buffer.lineView(i, scratch), entry.matches);
+        total += entry.matches.size();
+        entry.dirty = false;
+        dirtyCount--;
+    }
+    firstDirty = entries.size();
+}
+
+const std::vector<SearchMatch>& SearchIndex::lineMatches(size_t line) const {
+    static const std::vector<SearchMatch> none;
+    return line < entries.size() ? entries[line].matches : none;
+}
+
+size_t SearchIndex::matchIndex(size_t line, uint32_t column) const {
+    size_t index = 0;
+    for (size_t i = 0; i < line && i < entries.size(); i++) index += entries[i].matches.size();
+    for (const SearchMatch& match : lineMatches(line)) {
+        if (match.column >= column) break;
+        index++;
+    }
+    return index;
+}
+
+bool SearchIndex::find(size_t line, size_t column, bool forward, size_t& matchLine, SearchMatch& match) const {
+    if (total == 0 || entries.empty()) return false;
+    size_t count = entries.size();
+    line = std::min(line, count - 1);
+
+    if (forward) {
+        for (const SearchMatch& m : entries[line].matches) {
+            if (m.column >= column) {
+                matchLine = line;
+                match = m;
+                return true;
+            }
+        }
+        // The remaining lines, then around to the start of this one
+        for (size_t step = 1; step <= count; step++) {
+            size_t i = (line + step) % count;
+            if (!entries[i].matches.empty()) {
+                matchLine = i;
+                match = entries[i].matches.front();
+                return true;
+            }
+        }
+    } else {
+        const std::vector<SearchMatch>& here = entries[line].matches;
+        for (size_t k = here.size(); k-- > 0;) {
+            if (here[k].column < column) {
+                matchLine = line;
+                match = here[k];
+                return true;
+            }
+        }
+        for (size_t step = 1; step <= count; step++) {
+            size_t i = (line + count - step) % count;
+            if (!entries[i].matches.empty()) {
+                matchLine = i;
+                match = entries[i].matches.back();
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// --------- Replacement ---------
+std::string SearchIndex::replacementFor(std::string_view line, const SearchMatch& match,
+                                        const std::string& replacement) const {
+    if (!options.regex) return replacement;
+    for (std::cregex_iterator it(line.data(), line.data() + line.size(), compiled), end; it != end; ++it) {
+        if ((size_t)it->position(0) == match.column) return it->format(replacement);
+    }
+    return replacement;
+}
+
+void SearchIndex::replaceLine(std::string_view line, const std::vector<SearchMatch>& matches,
+                              const std::string& replacement, std::string& out) const {
+    size_t pos = 0;
+    if (options.regex) {
+        // Walk the regex matches alongside the index so groups can be expanded
+        size_t next = 0;
+        for (std::cregex_iterator it(line.data(), line.data() + line.size(), compiled), end;
+             it != end && next < matches.size(); ++it) {
+            if ((size_t)it->position(0) != matches[next].column) continue;
+            out.append(line.substr(pos, matches[next].column - pos));
+            out += it->format(replacement);
+            pos = matches[next].column + matches[next].length;
+            next++;
+        }
+    } else {
+        for (const SearchMatch& match : matches) {
+            out.append(line.substr(pos, match.column - pos));
+            out += replacement;
+            pos = match.column + match.length;
+        }
+    }
+    out.append(line.substr(pos));
+}
@@ -0,0 +1,94 @@
+#ifndef SEARCH_HPP
+#define SEARCH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "text_buffer.hpp"
+
+struct SearchOptions {
+    bool caseSensitive = false;
+    bool wholeWord = false;
+    bool regex = false;   // ECMAScript syntax, matched one line at a time
+};
+
+// A match inside one line
+struct SearchMatch {
+    uint32_t column;
+    uint32_t length;
+};
+
+// Position of needle in haystack at or after from, or npos. Candidates are
+// found 16 bytes at a time by comparing the needle's first and last bytes,
+// then verified. Case-insensitive matching folds ASCII letters only.
+size_t findLiteral(std::string_view haystack, std::string_view needle, size_t from, bool caseSensitive);
+
+// The matches of one query across a document, kept per line like the
+// highlighter's lexer state. An edit marks only the lines it touched, and
+// refresh() rescans just those, so a keystroke does not rescan the file.
+// Matches never span lines.
+class SearchIndex {
+public:
+    // Sets the pattern and marks every line for a rescan. Returns false,
+    // leaving the index empty, when a regex does not compile.
+    bool setQuery(const std::string& pattern, SearchOptions options, std::string& error);
+    void clear();
+    bool active() const { return hasQuery; }
+
+    // The whole document was replaced
+    void reset(size_t lineCount);
+
+    // Call after lines [firstLine, firstLine + removedLines) were replaced
+    // by insertedLines new lines
+    void onEdit(size_t firstLine, size_t removedLines, size_t insertedLines);
+
+    // Rescans the lines marked by setQuery, reset or onEdit
+    void refresh(const TextBuffer& buffer);
+
+    // Valid after refresh()
+    const std::vector<SearchMatch>& lineMatches(size_t line) const;
+    size_t matchCount() const { return total; }
+    size_t lineCount() const { return entries.size(); }
+
+    // Zero-based position of the match at (line, column) among all matches
+    size_t matchIndex(size_t line, uint32_t column) const;
+
+    // The first match at or after (line, column), or when going backwards
+    // the last one before it, wrapping around the document
+    bool find(size_t line, size_t column, bool forward, size_t& matchLine, SearchMatch& match) const;
+
+    // Finds the matches of the current query in one line
+    void matchLine(std::string_view line, std::vector<SearchMatch>& out) const;
+
+    // What one match of line is replaced with; regex replacements may refer
+    // to groups as $1, $2, ...
+    std::string replacementFor(std::string_view line, const SearchMatch& match, const std::string& replacement) const;
+
+    // Appends line to out with each of its matches replaced
+    void replaceLine(std::string_view line, const std::vector<SearchMatch>& matches, const std::string& replacement,
+                     std::string& out) const;
+
+private:
+    struct LineEntry {
+        std::vector<SearchMatch> matches;
+        bool dirty = true;
+    };
+
+    bool isMatch(std::string_view line, size_t column, size_t length) const;
+
+    std::string pattern;
+    SearchOptions options;
+    std::regex compiled;
+    bool hasQuery = false;
+
+    std::vector<LineEntry> entries;
+    size_t firstDirty = 0;   // No line below this needs a rescan
+    size_t dirtyCount = 0;
+    size_t total = 0;
+    std::string scratch;
+};
+
+#endif // SEARCH_HPP
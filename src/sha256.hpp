@@ -0,0 +1,33 @@
+#ifndef SHA256_HPP
+#define SHA256_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Incremental SHA-256 (FIPS 180-4)
+class Sha256 {
+public:
+    Sha256();
+
+    void update(std::string_view data);
+    void update(const void* data, size_t size);
+
+    // Finishes the digest and returns it as 64 lowercase hex digits. The
+    // object must not be updated afterwards.
+    std::string hexDigest();
+
+private:
+    void processBlock(const uint8_t* block);
+
+    uint32_t state[8];
+    uint8_t block[64];
+    size_t blockUsed = 0;
+    uint64_t totalBytes = 0;
+};
+
+// Hex SHA-256 of a single piece of data
+std::string sha256Hex(std::string_view data);
+
+#endif // SHA256_HPP
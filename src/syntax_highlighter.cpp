@@ -0,0 +1,302 @@
+#include "syntax_highlighter.hpp"
+#include <algorithm>
+#include <unordered_set>
+
+static const std::unordered_set<std::string_view>& keywords() {
+    static const std::unordered_set<std::string_view> words = {
+        "alignas", "alignof", "asm", "auto", "bool", "break", "case", "catch", "char", "char8_t",
+        "char16_t", "char32_t", "class", "concept", "const", "consteval", "constexpr", "constinit",
+        "const_cast", "continue", "co_await", "co_return", "co_yield", "decltype", "default", "delete",
+        "do", "double", "dynamic_cast", "else", "enum", "explicit", "export", "extern", "false",
+        "final", "float", "for", "friend", "goto", "if", "inline", "int", "long", "mutable",
+        "namespace", "new", "noexcept", "nullptr", "operator", "override", "private", "protected",
+        "public", "register", "reinterpret_cast", "requires", "return", "short", "signed", "sizeof",
+        "static", "static_assert", "static_cast", "struct", "switch", "template", "this",
+        "thread_local", "throw", "true", "try", "typedef", "typeid", "typename", "union", "unsigned",
+        "using", "virtual", "void", "volatile", "wchar_t", "while"
+    };
+    return words;
+}
+
+static bool isIdentifierStart(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || (unsigned char)c >= 0x80;
+}
+
+static bool isIdentifierChar(char c) {
+    return isIdentifierStart(c) || (c >= '0' && c <= '9');
+}
+
+static bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+// Index just past the closing quote, or the end of the line if unterminated
+static size_t scanQuoted(std::string_view line, size_t from, char quote, bool& closed) {
+    size_t i = from;
+    while (i < line.size()) {
+        if (line[i] == '\\') {
+            i += 2;
+        } else if (line[i] == quote) {
+            closed = true;
+            return i + 1;
+        } else {
+            i++;
+        }
+    }
+    closed = false;
+    return line.size();
+}
+
+uint16_t SyntaxHighlighter::internDelimiter(std::string_view delimiter) {
+    for (size_t i = 0; i < delimiters.size(); i++) {
+        if (delimiters[i] == delimiter) return (uint16_t)(i + 1);
+    }
+    delimiters.emplace_back(delimiter);
+    return (uint16_t)delimiters.size();
+}
+
+LexState SyntaxHighlighter::lexLine(std::string_view line, LexState state, std::vector<TokenSpan>* spans) {
+    auto emit = [&](size_t start, size_t end, TokenType type) {
+        if (spans && end > start) spans->push_back({(uint32_t)start, (uint32_t)(end - start), type});
+    };
+
+    size_t n = line.size();
+    size_t contentEnd = (n > 0 && line[n - 1] == '\r') ? n - 1 : n;
+    bool continues = contentEnd > 0 && line[contentEnd - 1] == '\\';
+    size_t i = 0;
+    bool inDirective = false;
+
+    // Finish whatever the previous line left open
+    switch (state.mode) {
+    case LexState::BlockComment: {
+        size_t close = line.find("*/");
+        if (close == std::string_view::npos) {
+            emit(0, n, TokenType::Comment);
+            return state;
+        }
+        emit(0, close + 2, TokenType::Comment);
+        i = close + 2;
+        break;
+    }
+    case LexState::LineComment:
+        emit(0, n, TokenType::Comment);
+        return continues ? state : LexState();
+    case LexState::String: {
+        bool closed;
+        i = scanQuoted(line, 0, '"', closed);
+        emit(0, i, TokenType::String);
+        if (!closed) return continues ? state : LexState();
+        break;
+    }
+    case LexState::RawString: {
+        std::string close = ")" + delimiters[state.delimiter - 1] + "\"";
+        size_t end = line.find(close);
+        if (end == std::string_view::npos) {
+            emit(0, n, TokenType::String);
+            return state;
+        }
+        i = end + close.size();
+        emit(0, i, TokenType::String);
+        break;
+    }
+    case LexState::Preprocessor:
+        inDirective = true;
+        break;
+    case LexState::Normal:
+        break;
+    }
+    bool lineStart = state.mode == LexState::Normal;
+
+    while (i < n) {
+        char c = line[i];
+        char next = i + 1 < n ? line[i + 1] : '\0';
+        size_t tokenStart = i;
+
+        if (c == ' ' || c == '\t' || c == '\r') {
+            i++;
+            continue;
+        }
+
+        // Preprocessor directive: color the directive name and an <header>
+        if (c == '#' && lineStart) {
+            size_t j = i + 1;
+            while (j < n && (line[j] == ' ' || line[j] == '\t')) j++;
+            size_t nameStart = j;
+            while (j < n && isIdentifierChar(line[j])) j++;
+            emit(i, j, TokenType::Preprocessor);
+            inDirective = true;
+
+            if (line.substr(nameStart, j - nameStart) == "include") {
+                while (j < n && (line[j] == ' ' || line[j] == '\t')) j++;
+                if (j < n && line[j] == '<') {
+                    size_t close = line.find('>', j);
+                    size_t end = close == std::string_view::npos ? n : close + 1;
+                    emit(j, end, TokenType::String);
+                    j = end;
+                }
+            }
+            i = j;
+            lineStart = false;
+            continue;
+        }
+        lineStart = false;
+
+        if (c == '/' && next == '/') {
+            emit(i, n, TokenType::Comment);
+            return continues ? LexState{LexState::LineComment, 0} : LexState();
+        }
+        if (c == '/' && next == '*') {
+            size_t close = line.find("*/", i + 2);
+            if (close == std::string_view::npos) {
+                emit(i, n, TokenType::Comment);
+                return LexState{LexState::BlockComment, 0};
+            }
+            emit(i, close + 2, TokenType::Comment);
+            i = close + 2;
+            continue;
+        }
+
+        if (isIdentifierStart(c)) {
+            size_t j = i;
+            while (j < n && isIdentifierChar(line[j])) j++;
+            std::string_view word = line.substr(i, j - i);
+            char after = j < n ? line[j] : '\0';
+
+            // Raw string: R"delim( ... )delim" with an optional encoding prefix
+            if (after == '"' && (word == "R" || word == "LR" || word == "uR" || word == "UR" || word == "u8R")) {
+                size_t open = line.find('(', j + 1);
+                if (open != std::string_view::npos && open - (j + 1) <= 16) {
+                    std::string_view delimiter = line.substr(j + 1, open - (j + 1));
+                    std::string close = ")" + std::string(delimiter) + "\"";
+                    size_t end = line.find(close, open + 1);
+                    if (end == std::string_view::npos) {
+                        emit(i, n, TokenType::String);
+                        return LexState{LexState::RawString, internDelimiter(delimiter)};
+                    }
+                    emit(i, end + close.size(), TokenType::String);
+                    i = end + close.size();
+                    continue;
+                }
+            }
+
+            bool encodingPrefix = word == "L" || word == "u" || word == "U" || word == "u8";
+            if (encodingPrefix && (after == '"' || after == '\'')) {
+                i = j;
+                c = after;
+            } else {
+                emit(i, j, keywords().count(word) ? TokenType::Keyword : TokenType::Identifier);
+                i = j;
+                continue;
+            }
+        }
+
+        // tokenStart still points at an encoding prefix if one was consumed
+        if (c == '"') {
+            bool closed;
+            i = scanQuoted(line, i + 1, '"', closed);
+            emit(tokenStart, i, TokenType::String);
+            if (!closed && continues) {
+                return LexState{LexState::String, 0};
+            }
+            continue;
+        }
+        if (c == '\'') {
+            bool closed;
+            i = scanQuoted(line, i + 1, '\'', closed);
+            emit(tokenStart, i, TokenType::Char);
+            continue;
+        }
+
+        if (isDigit(c) || (c == '.' && isDigit(next))) {
+            size_t j = i + 1;
+            while (j < n) {
+                char d = line[j];
+                char prev = line[j - 1];
+                if (isIdentifierChar(d) || d == '.') {
+                    j++;
+                } else if (d == '\'' && j + 1 < n && isIdentifierChar(line[j + 1])) {
+                    j++;  // Digit separator
+                } else if ((d == '+' || d == '-') && (prev == 'e' || prev == 'E' || prev == 'p' || prev == 'P')) {
+                    j++;  // Exponent sign
+                } else {
+                    break;
+                }
+            }
+            emit(i, j, TokenType::Number);
+            i = j;
+            continue;
+        }
+
+        i++;
+    }
+
+    if (inDirective && continues) return LexState{LexState::Preprocessor, 0};
+    return LexState();
+}
+
+// --------- Line State Cache ---------
+void SyntaxHighlighter::reset(size_t lineCount) {
+    entries.assign(lineCount, LineEntry());
+    validPrefix = 0;
+}
+
+void SyntaxHighlighter::onEdit(size_t firstLine, size_t removedLines, size_t insertedLines) {
+    if (firstLine >= entries.size()) {
+        entries.resize(firstLine + 1);
+    }
+    size_t removeEnd = std::min(firstLine + removedLines, entries.size());
+    removedLines = removeEnd - firstLine;
+
+    // Lines that survive in place just become dirty
+    size_t common = std::min(removedLines, insertedLines);
+    for (size_t k = firstLine; k < firstLine + common; k++) {
+        entries[k].dirty = true;
+    }
+
+    // The last line of the new block inherits the old block's end state, so
+    // the line after it is only re-lexed if that state really changes
+    LexState carried = removedLines > 0 ? entries[removeEnd - 1].end : LexState();
+    if (insertedLines > removedLines) {
+        entries.insert(entries.begin() + removeEnd, insertedLines - removedLines, LineEntry{carried, true});
+    } else if (removedLines > insertedLines) {
+        if (common > 0) entries[firstLine + common - 1].end = carried;
+        entries.erase(entries.begin() + firstLine + common, entries.begin() + removeEnd);
+    }
+
+    validPrefix = std::min(validPrefix, firstLine);
+}
+
+void SyntaxHighlighter::ensureLexed(const TextBuffer& buffer, size_t upTo) {
+    if (entries.size() != buffer.lineCount()) entries.resize(buffer.lineCount());
+    if (upTo >= entries.size()) upTo = entries.size() - 1;
+    if (validPrefix > upTo) return;
+
+    LexState state = validPrefix == 0 ? LexState() : entries[validPrefix - 1].end;
+    bool changed = false;
+    for (size_t k = validPrefix; k <= upTo; k++) {
+        LineEntry& entry = entries[k];
+        if (entry.dirty || changed) {
+            LexState end = lexLine(buffer.lineView(k, scratch), state, nullptr);
+            changed = end != entry.end;
+            entry.end = end;
+            entry.dirty = false;
+        } else {
+            changed = false;
+        }
+        state = entry.end;
+    }
+
+    // The next line was lexed from a state that no longer holds
+    if (changed && upTo + 1 < entries.size()) entries[upTo + 1].dirty = true;
+    validPrefix = upTo + 1;
+}
+
+void SyntaxHighlighter::highlight(const TextBuffer& buffer, size_t line, std::string_view text, std::vector<TokenSpan>& spans) {
+    spans.clear();
+    LexState state;
+    if (line > 0) {
+        ensureLexed(buffer, line - 1);
+        state = entries[line - 1].end;
+    }
+    lexLine(text, state, &spans);
+}
@@ -0,0 +1,85 @@
+#ifndef SYNTAX_HIGHLIGHTER_HPP
+#define SYNTAX_HIGHLIGHTER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "text_buffer.hpp"
+
+enum class TokenType : uint8_t {
+    Text,
+    Keyword,
+    Identifier,
+    Number,
+    String,
+    Char,
+    Comment,
+    Preprocessor
+};
+
+// A colored run inside one line
+struct TokenSpan {
+    uint32_t start;
+    uint32_t length;
+    TokenType type;
+};
+
+// What the lexer is in the middle of when a line ends
+struct LexState {
+    enum Mode : uint8_t {
+        Normal,
+        BlockComment,     // Inside /* ... */
+        LineComment,      // // comment continued with a trailing backslash
+        String,           // "..." continued with a trailing backslash
+        RawString,        // R"delim( ... )delim"
+        Preprocessor      // Directive continued with a trailing backslash
+    };
+
+    Mode mode = Normal;
+    uint16_t delimiter = 0;  // Raw string delimiter, interned by the highlighter
+
+    bool operator==(const LexState& other) const {
+        return mode == other.mode && delimiter == other.delimiter;
+    }
+    bool operator!=(const LexState& other) const { return !(*this == other); }
+};
+
+// C++ highlighter with a per-line cache of the lexer state at the end of
+// each line. An edit marks only the touched lines; re-lexing then runs from
+// the first of them and stops as soon as a line ends in the same state it
+// did before, so a keystroke costs a line or two unless it opens or closes a
+// multi-line construct.
+class SyntaxHighlighter {
+public:
+    // Forgets all cached state for a document of the given size
+    void reset(size_t lineCount);
+
+    // Call after lines [firstLine, firstLine + removedLines) were replaced
+    // by insertedLines new lines
+    void onEdit(size_t firstLine, size_t removedLines, size_t insertedLines);
+
+    // Produces the spans of a visible line, lexing any stale lines before it
+    void highlight(const TextBuffer& buffer, size_t line, std::string_view text, std::vector<TokenSpan>& spans);
+
+    // Lexes one line from a start state, appending spans, and returns the
+    // state at the end of the line
+    LexState lexLine(std::string_view line, LexState state, std::vector<TokenSpan>* spans);
+
+private:
+    struct LineEntry {
+        LexState end;
+        bool dirty = true;
+    };
+
+    void ensureLexed(const TextBuffer& buffer, size_t upTo);
+    uint16_t internDelimiter(std::string_view delimiter);
+
+    std::vector<LineEntry> entries;
+    size_t validPrefix = 0;   // Lines below this are known to be up to date
+    std::vector<std::string> delimiters;
+    std::string scratch;
+};
+
+#endif // SYNTAX_HIGHLIGHTER_HPP
@@ -0,0 +1,172 @@
+// Randomized test of TextBuffer against a plain std::string.
+//
+// Build from src/ with the buffer and what it depends on:
+//   g++ -O1 -g tests/text_buffer_test.cpp text_buffer.cpp newline_scan.cpp mapped_file.cpp -o text_buffer_test
+// Run:
+//   ./text_buffer_test [--seed N] [--ops N]
+//
+// Every step inserts, erases, replaces the document or takes a snapshot,
+// applies the same change to the model and compares lengths, line starts,
+// line views, offset->line lookups and substrings. The first mismatch is
+// printed with the seed and step that reproduce it.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "../text_buffer.hpp"
+
+static uint32_t seed = 1;
+static size_t step = 0;
+
+static void fail(const std::string& what) {
+    std::fprintf(stderr, "FAIL (seed %u, step %zu): %s\n", seed, step, what.c_str());
+    std::exit(1);
+}
+
+static void expect(bool ok, const std::string& what) {
+    if (!ok) fail(what);
+}
+
+// --------- Reference Model ---------
+static std::vector<size_t> modelLineStarts(const std::string& text) {
+    std::vector<size_t> starts = {0};
+    for (size_t i = 0; i < text.size(); i++) {
+        if (text[i] == '\n') starts.push_back(i + 1);
+    }
+    return starts;
+}
+
+static size_t modelLineOf(const std::vector<size_t>& starts, size_t offset) {
+    return std::upper_bound(starts.begin(), starts.end(), offset) - starts.begin() - 1;
+}
+
+// --------- Random Input ---------
+// Mostly short runs like typing and pasting, with newlines, carriage
+// returns and now and then a block long enough to fill an add chunk
+static std::string randomText(std::mt19937& rng) {
+    static const char alphabet[] = "abcxyz \t{};()\n\n\r";
+    size_t length;
+    switch (rng() % 10) {
+    case 0: length = 0; break;
+    case 1: length = 200 + rng() % 2000; break;
+    case 2: length = (rng() % 50 == 0) ? 70000 + rng() % 30000 : 1 + rng() % 100; break;
+    default: length = 1 + rng() % 8; break;
+    }
+    std::string text(length, ' ');
+    for (char& c : text) c = alphabet[rng() % (sizeof(alphabet) - 1)];
+    return text;
+}
+
+// --------- Comparison ---------
+static void compare(const TextBuffer& buffer, const std::string& model, std::mt19937& rng, bool full) {
+    std::vector<size_t> starts = modelLineStarts(model);
+    expect(buffer.length() == model.size(),
+           "length " + std::to_string(buffer.length()) + " != " + std::to_string(model.size()));
+    expect(buffer.lineCount() == starts.size(),
+           "lineCount " + std::to_string(buffer.lineCount()) + " != " + std::to_string(starts.size()));
+
+    // Every line after big changes, a sample of them otherwise
+    std::vector<size_t> lines;
+    if (full || starts.size() <= 64) {
+        for (size_t line = 0; line < starts.size(); line++) lines.push_back(line);
+    } else {
+        lines = {0, starts.size() - 1};
+        for (int k = 0; k < 32; k++) lines.push_back(rng() % starts.size());
+    }
+    std::string scratch;
+    for (size_t line : lines) {
+        size_t start = starts[line];
+        size_t end = line + 1 < starts.size() ? starts[line + 1] - 1 : model.size();
+        std::string where = "line " + std::to_string(line);
+        expect(buffer.lineStart(line) == start, where + ": lineStart " + std::to_string(buffer.lineStart(line)) +
+                                                    " != " + std::to_string(start));
+        expect(buffer.lineLength(line) == end - start, where + ": lineLength");
+        expect(buffer.lineView(line, scratch) == std::string_view(model).substr(start, end - start),
+               where + ": lineView");
+        size_t column = rng() % (end - start + 3);
+        expect(buffer.offsetOf(line, column) == start + std::min(column, end - start), where + ": offsetOf");
+    }
+    expect(buffer.lineStart(starts.size()) == model.size(), "lineStart past the last line");
+
+    for (int k = 0; k < 32; k++) {
+        size_t offset = rng() % (model.size() + 1);
+        std::string where = "offset " + std::to_string(offset);
+        expect(buffer.lineOf(offset) == modelLineOf(starts, offset), where + ": lineOf " +
+               std::to_string(buffer.lineOf(offset)) + " != " + std::to_string(modelLineOf(starts, offset)));
+        if (offset < model.size()) expect(buffer.charAt(offset) == model[offset], where + ": charAt");
+        size_t count = rng() % 300;
+        expect(buffer.substr(offset, count) == model.substr(offset, count), where + ": substr");
+    }
+    if (full) expect(buffer.text() == model, "text");
+}
+
+int main(int argc, char* argv[]) {
+    size_t ops = 20000;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--seed" && i + 1 < argc) {
+            seed = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--ops" && i + 1 < argc) {
+            ops = std::strtoul(argv[++i], nullptr, 10);
+        } else {
+            std::fprintf(stderr, "Usage: %s [--seed N] [--ops N]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    std::mt19937 rng(seed);
+    TextBuffer buffer;
+    std::string model;
+    std::vector<std::pair<TextSnapshot, std::string>> snapshots;  // Each with the text it was taken of
+
+    for (step = 0; step < ops; step++) {
+        bool full = false;
+        unsigned kind = rng() % 100;
+        if (kind < 50) {
+            size_t offset = rng() % (model.size() + 1);
+            std::string text = randomText(rng);
+            buffer.insert(offset, text);
+            model.insert(offset, text);
+        } else if (kind < 90) {
+            size_t offset = rng() % (model.size() + 1);
+            size_t count = std::min<size_t>(rng() % 4 == 0 ? rng() % 5000 : rng() % 10, model.size() - offset);
+            buffer.erase(offset, count);
+            model.erase(offset, count);
+        } else if (kind < 92) {
+            std::string text = randomText(rng);
+            buffer.setText(text);
+            model = text;
+            full = true;
+        } else if (kind < 93) {
+            // Bytes held elsewhere, like a mapped file
+            auto owner = std::make_shared<std::string>(randomText(rng));
+            buffer.setExternal(owner, owner->data(), owner->size());
+            model = *owner;
+            full = true;
+        } else if (kind < 96) {
+            snapshots.emplace_back(buffer.snapshot(), model);
+            if (snapshots.size() > 8) snapshots.erase(snapshots.begin());
+        } else {
+            // Undo-style replacement: erase a range and insert at the same place
+            size_t offset = rng() % (model.size() + 1);
+            size_t count = std::min<size_t>(rng() % 20, model.size() - offset);
+            std::string text = randomText(rng);
+            buffer.erase(offset, count);
+            buffer.insert(offset, text);
+            model.replace(offset, count, text);
+        }
+        compare(buffer, model, rng, full || step % 500 == 0);
+    }
+
+    // Snapshots must not have seen any of the edits made after them
+    for (const auto& [snapshot, text] : snapshots) {
+        expect(snapshot.length() == text.size() && snapshot.text() == text, "snapshot changed after it was taken");
+    }
+    std::printf("OK: %zu operations, seed %u, final length %zu, %zu lines\n", ops, seed, model.size(),
+                buffer.lineCount());
+    return 0;
+}
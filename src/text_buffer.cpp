@@ -0,0 +1,384 @@
+#include "text_buffer.hpp"
+#include "newline_scan.hpp"
+#include <algorithm>
+#include <cstring>
+
+TextBuffer::TextBuffer() {
+    setText(std::string());
+}
+
+TextBuffer::TextBuffer(std::string text) {
+    setText(std::move(text));
+}
+
+// --------- Tree Maintenance ---------
+uint32_t TextBuffer::nextPriority() {
+    // xorshift32; treap balance only needs the priorities to look random
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+int TextBuffer::newNode(uint32_t chunk, uint32_t start, uint32_t length) {
+    Node n;
+    n.chunk = chunk;
+    n.start = start;
+    n.length = length;
+    n.lineFeeds = countLineFeeds(chunk, start, length);
+    n.totalLength = length;
+    n.totalLineFeeds = n.lineFeeds;
+    n.priority = nextPriority();
+    n.left = n.right = NIL;
+
+    if (!freeNodes.empty()) {
+        int index = freeNodes.back();
+        freeNodes.pop_back();
+        nodes[index] = n;
+        return index;
+    }
+    nodes.push_back(n);
+    return (int)nodes.size() - 1;
+}
+
+void TextBuffer::freeTree(int node) {
+    if (node == NIL) return;
+    freeTree(nodes[node].left);
+    freeTree(nodes[node].right);
+    freeNodes.push_back(node);
+}
+
+void TextBuffer::update(int node) {
+    Node& n = nodes[node];
+    n.totalLength = n.length;
+    n.totalLineFeeds = n.lineFeeds;
+    if (n.left != NIL) {
+        n.totalLength += nodes[n.left].totalLength;
+        n.totalLineFeeds += nodes[n.left].totalLineFeeds;
+    }
+    if (n.right != NIL) {
+        n.totalLength += nodes[n.right].totalLength;
+        n.totalLineFeeds += nodes[n.right].totalLineFeeds;
+    }
+}
+
+uint32_t TextBuffer::countLineFeeds(uint32_t chunk, uint32_t start, uint32_t length) const {
+    const std::vector<uint32_t>& newlines = chunks[chunk]->newlines;
+    auto first = std::lower_bound(newlines.begin(), newlines.end(), start);
+    auto last = std::lower_bound(first, newlines.end(), start + length);
+    return (uint32_t)(last - first);
+}
+
+// Splits the tree so that left holds exactly the first offset bytes. A piece
+// straddling the split point is cut in two.
+void TextBuffer::split(int node, size_t offset, int& left, int& right) {
+    if (node == NIL) {
+        left = right = NIL;
+        return;
+    }
+
+    size_t leftLength = nodes[node].left == NIL ? 0 : nodes[nodes[node].left].totalLength;
+    size_t pieceLength = nodes[node].length;
+
+    if (offset <= leftLength) {
+        int subLeft, subRight;
+        split(nodes[node].left, offset, subLeft, subRight);
+        nodes[node].left = subRight;
+        update(node);
+        left = subLeft;
+        right = node;
+    } else if (offset >= leftLength + pieceLength) {
+        int subLeft, subRight;
+        split(nodes[node].right, offset - leftLength - pieceLength, subLeft, subRight);
+        nodes[node].right = subLeft;
+        update(node);
+        left = node;
+        right = subRight;
+    } else {
+        uint32_t cut = (uint32_t)(offset - leftLength);
+        int tail = newNode(nodes[node].chunk, nodes[node].start + cut, (uint32_t)pieceLength - cut);
+
+        // The tail inherits the right subtree, so it also takes the priority
+        // that keeps that subtree a valid heap below it
+        nodes[tail].priority = nodes[node].priority;
+        nodes[tail].right = nodes[node].right;
+        update(tail);
+
+        nodes[node].right = NIL;
+        nodes[node].length = cut;
+        nodes[node].lineFeeds = countLineFeeds(nodes[node].chunk, nodes[node].start, cut);
+        update(node);
+
+        left = node;
+        right = tail;
+    }
+}
+
+int TextBuffer::merge(int left, int right) {
+    if (left == NIL) return right;
+    if (right == NIL) return left;
+
+    if (nodes[left].priority > nodes[right].priority) {
+        int merged = merge(nodes[left].right, right);
+        nodes[left].right = merged;
+        update(left);
+        return left;
+    }
+    int merged = merge(left, nodes[right].left);
+    nodes[right].left = merged;
+    update(right);
+    return right;
+}
+
+// Grows the last piece of a subtree in place when the new text was appended
+// right behind it in the same chunk. This keeps a run of typing in one piece.
+bool TextBuffer::extendLastPiece(int node, uint32_t chunk, uint32_t end, uint32_t length, uint32_t lineFeeds) {
+    int last = node;
+    while (nodes[last].right != NIL) last = nodes[last].right;
+    if (nodes[last].chunk != chunk || nodes[last].start + nodes[last].length != end) return false;
+
+    nodes[last].length += length;
+    nodes[last].lineFeeds += lineFeeds;
+    for (int n = node; n != NIL; n = nodes[n].right) {
+        nodes[n].totalLength += length;
+        nodes[n].totalLineFeeds += lineFeeds;
+    }
+    return true;
+}
+
+// --------- Chunk Storage ---------
+void TextBuffer::indexNewlines(Chunk& chunk, size_t from) const {
+    findNewlines(chunk.data, from, chunk.size, chunk.newlines);
+}
+
+uint32_t TextBuffer::appendToAddChunk(std::string_view text, uint32_t& start) {
+    if (addChunk < 0 || chunks[addChunk]->capacity - chunks[addChunk]->size < text.size()) {
+        auto chunk = std::make_shared<Chunk>();
+        chunk->capacity = std::max(ADD_CHUNK_SIZE, text.size());
+        std::shared_ptr<char> bytes(new char[chunk->capacity], std::default_delete<char[]>());
+        chunk->data = bytes.get();
+        chunk->storage = bytes;
+        chunks.push_back(chunk);
+        addChunk = (int)chunks.size() - 1;
+    }
+
+    Chunk& chunk = *chunks[addChunk];
+    start = (uint32_t)chunk.size;
+    std::memcpy(chunk.data + chunk.size, text.data(), text.size());
+    chunk.size += text.size();
+    indexNewlines(chunk, start);
+    return (uint32_t)addChunk;
+}
+
+// --------- Editing ---------
+void TextBuffer::setText(std::string text) {
+    auto storage = std::make_shared<std::string>(std::move(text));
+    setExternal(storage, storage->data(), storage->size());
+}
+
+void TextBuffer::setExternal(std::shared_ptr<const void> owner, const char* data, size_t size) {
+    chunks.clear();
+    nodes.clear();
+    freeNodes.clear();
+    root = NIL;
+    addChunk = -1;
+
+    for (size_t offset = 0; offset < size; offset += MAX_CHUNK_SIZE) {
+        auto chunk = std::make_shared<Chunk>();
+        chunk->storage = owner;
+        chunk->data = const_cast<char*>(data + offset);  // Only add chunks are ever written
+        chunk->size = chunk->capacity = std::min(MAX_CHUNK_SIZE, size - offset);
+        indexNewlines(*chunk, 0);
+        chunks.push_back(chunk);
+        root = merge(root, newNode((uint32_t)chunks.size() - 1, 0, (uint32_t)chunk->size));
+    }
+}
+
+void TextBuffer::insert(size_t offset, std::string_view text) {
+    while (text.size() > MAX_CHUNK_SIZE) {
+        insert(offset, text.substr(0, MAX_CHUNK_SIZE));
+        offset += MAX_CHUNK_SIZE;
+        text.remove_prefix(MAX_CHUNK_SIZE);
+    }
+    if (text.empty()) return;
+    offset = std::min(offset, length());
+
+    uint32_t start;
+    uint32_t chunk = appendToAddChunk(text, start);
+    uint32_t lineFeeds = countLineFeeds(chunk, start, (uint32_t)text.size());
+
+    int left, right;
+    split(root, offset, left, right);
+    if (left == NIL || !extendLastPiece(left, chunk, start, (uint32_t)text.size(), lineFeeds)) {
+        left = merge(left, newNode(chunk, start, (uint32_t)text.size()));
+    }
+    root = merge(left, right);
+}
+
+void TextBuffer::erase(size_t offset, size_t count) {
+    size_t total = length();
+    if (offset >= total || count == 0) return;
+    count = std::min(count, total - offset);
+
+    int left, middle, right;
+    split(root, offset, left, middle);
+    split(middle, count, middle, right);
+    freeTree(middle);
+    root = merge(left, right);
+}
+
+// --------- Queries ---------
+size_t TextBuffer::length() const {
+    return root == NIL ? 0 : nodes[root].totalLength;
+}
+
+size_t TextBuffer::lineCount() const {
+    return (root == NIL ? 0 : nodes[root].totalLineFeeds) + 1;
+}
+
+size_t TextBuffer::lineStart(size_t line) const {
+    if (line == 0) return 0;
+    if (line >= lineCount()) return length();
+
+    // Find the line-th newline; the line starts right after it
+    size_t remaining = line;
+    size_t base = 0;
+    int node = root;
+    while (node != NIL) {
+        const Node& n = nodes[node];
+        size_t leftLineFeeds = n.left == NIL ? 0 : nodes[n.left].totalLineFeeds;
+        if (remaining <= leftLineFeeds) {
+            node = n.left;
+            continue;
+        }
+        remaining -= leftLineFeeds;
+        size_t pieceBegin = base + (n.left == NIL ? 0 : nodes[n.left].totalLength);
+        if (remaining <= n.lineFeeds) {
+            const std::vector<uint32_t>& newlines = chunks[n.chunk]->newlines;
+            auto first = std::lower_bound(newlines.begin(), newlines.end(), n.start);
+            return pieceBegin + (first[remaining - 1] - n.start) + 1;
+        }
+        remaining -= n.lineFeeds;
+        base = pieceBegin + n.length;
+        node = n.right;
+    }
+    return length();
+}
+
+size_t TextBuffer::lineLength(size_t line) const {
+    size_t start = lineStart(line);
+    size_t end = line + 1 < lineCount() ? lineStart(line + 1) - 1 : length();
+    return end - start;
+}
+
+size_t TextBuffer::lineOf(size_t offset) const {
+    size_t lineFeeds = 0;
+    size_t base = 0;
+    int node = root;
+    while (node != NIL) {
+        const Node& n = nodes[node];
+        size_t leftLength = n.left == NIL ? 0 : nodes[n.left].totalLength;
+        if (offset < base + leftLength) {
+            node = n.left;
+            continue;
+        }
+        lineFeeds += n.left == NIL ? 0 : nodes[n.left].totalLineFeeds;
+        size_t pieceBegin = base + leftLength;
+        if (offset <= pieceBegin + n.length) {
+            return lineFeeds + countLineFeeds(n.chunk, n.start, (uint32_t)(offset - pieceBegin));
+        }
+        lineFeeds += n.lineFeeds;
+        base = pieceBegin + n.length;
+        node = n.right;
+    }
+    return lineFeeds;
+}
+
+size_t TextBuffer::offsetOf(size_t line, size_t column) const {
+    return lineStart(line) + std::min(column, lineLength(line));
+}
+
+char TextBuffer::charAt(size_t offset) const {
+    char c = '\0';
+    forEachChunk(offset, 1, [&](std::string_view run) {
+        c = run[0];
+        return false;
+    });
+    return c;
+}
+
+std::string TextBuffer::substr(size_t offset, size_t count) const {
+    std::string out;
+    if (offset < length()) out.reserve(std::min(count, length() - offset));
+    forEachChunk(offset, count, [&](std::string_view run) {
+        out.append(run);
+        return true;
+    });
+    return out;
+}
+
+std::string TextBuffer::text() const {
+    return substr(0, length());
+}
+
+std::string TextBuffer::lineText(size_t line) const {
+    return substr(lineStart(line), lineLength(line));
+}
+
+std::string_view TextBuffer::lineView(size_t line, std::string& scratch) const {
+    std::string_view single;
+    int runs = 0;
+    forEachChunk(lineStart(line), lineLength(line), [&](std::string_view run) {
+        if (runs == 0) {
+            single = run;
+        } else {
+            if (runs == 1) scratch.assign(single);
+            scratch.append(run);
+        }
+        runs++;
+        return true;
+    });
+    return runs > 1 ? std::string_view(scratch) : single;
+}
+
+TextSnapshot TextBuffer::snapshot() const {
+    TextSnapshot snap;
+    std::vector<bool> owned(chunks.size(), false);
+    std::vector<int> stack;
+    int node = root;
+
+    // In-order walk; each chunk's storage is referenced once
+    while (node != NIL || !stack.empty()) {
+        while (node != NIL) {
+            stack.push_back(node);
+            node = nodes[node].left;
+        }
+        node = stack.back();
+        stack.pop_back();
+
+        const Node& n = nodes[node];
+        if (!owned[n.chunk]) {
+            owned[n.chunk] = true;
+            snap.owners.push_back(chunks[n.chunk]->storage);
+        }
+        snap.pieces.emplace_back(chunks[n.chunk]->data + n.start, n.length);
+        snap.total += n.length;
+        node = n.right;
+    }
+    return snap;
+}
+
+std::string TextSnapshot::text() const {
+    std::string out;
+    out.reserve(total);
+    for (std::string_view run : pieces) out.append(run);
+    return out;
+}
+
+size_t TextBuffer::memoryUsage() const {
+    size_t bytes = nodes.capacity() * sizeof(Node) + freeNodes.capacity() * sizeof(int);
+    for (const auto& chunk : chunks) {
+        bytes += sizeof(Chunk) + chunk->capacity + chunk->newlines.capacity() * sizeof(uint32_t);
+    }
+    return bytes;
+}
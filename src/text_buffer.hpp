@@ -0,0 +1,157 @@
+#ifndef TEXT_BUFFER_HPP
+#define TEXT_BUFFER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// A frozen copy of a document that shares storage with the buffer it came
+// from. Taking one costs a walk over the pieces, not a copy of the text, and
+// it stays valid however the buffer is edited or replaced afterwards, so it
+// can be handed to another thread.
+class TextSnapshot {
+public:
+    const std::vector<std::string_view>& runs() const { return pieces; }
+    size_t length() const { return total; }
+    std::string text() const;
+
+private:
+    friend class TextBuffer;
+    std::vector<std::shared_ptr<const void>> owners;  // Keep the runs' bytes alive
+    std::vector<std::string_view> pieces;
+    size_t total = 0;
+};
+
+// Piece table document storage.
+//
+// Text lives in append-only chunks (the loaded file plus "add" chunks for
+// typed text) and the document is a sequence of pieces referring into them.
+// Pieces sit in an implicit treap keyed by position, and every node caches
+// the byte and newline totals of its subtree, so insert, erase, offset->line
+// and line->offset are all O(log n) in the number of pieces.
+class TextBuffer {
+public:
+    TextBuffer();
+    explicit TextBuffer(std::string text);
+
+    // Replaces the whole document, taking ownership of the string
+    void setText(std::string text);
+
+    // Replaces the whole document with bytes held elsewhere, such as a
+    // memory-mapped file, without copying them. owner keeps the bytes alive
+    // for as long as the buffer refers to them; edits never write to them.
+    void setExternal(std::shared_ptr<const void> owner, const char* data, size_t size);
+
+    void insert(size_t offset, std::string_view text);
+    void erase(size_t offset, size_t count);
+
+    size_t length() const;
+    size_t lineCount() const;
+
+    // Offset of the first byte of a line and its length without the '\n'
+    size_t lineStart(size_t line) const;
+    size_t lineLength(size_t line) const;
+
+    // Line containing an offset, and the inverse mapping
+    size_t lineOf(size_t offset) const;
+    size_t offsetOf(size_t line, size_t column) const;
+
+    char charAt(size_t offset) const;
+    std::string substr(size_t offset, size_t count) const;
+    std::string text() const;
+    std::string lineText(size_t line) const;
+
+    // View of a line. Points straight into storage when the line lies in a
+    // single piece; otherwise the line is assembled into scratch.
+    std::string_view lineView(size_t line, std::string& scratch) const;
+
+    // Calls visit(std::string_view) for each stored run overlapping
+    // [offset, offset + count), in order, without copying. Returning false
+    // from visit stops the walk.
+    template <typename Visitor>
+    void forEachChunk(size_t offset, size_t count, Visitor visit) const;
+
+    TextSnapshot snapshot() const;
+
+    // Bytes held by chunks, newline indexes and the piece tree
+    size_t memoryUsage() const;
+
+private:
+    static constexpr size_t ADD_CHUNK_SIZE = 64 * 1024;
+    static constexpr size_t MAX_CHUNK_SIZE = size_t(1) << 30;
+    static constexpr int NIL = -1;
+
+    // Storage a piece points into. Bytes below size never change, so views
+    // into a chunk stay valid for as long as the chunk is alive.
+    struct Chunk {
+        std::shared_ptr<const void> storage;  // Keeps the bytes behind data alive
+        char* data = nullptr;
+        size_t size = 0;
+        size_t capacity = 0;
+        std::vector<uint32_t> newlines;       // Offsets of every '\n' in data[0, size)
+    };
+
+    struct Node {
+        uint32_t chunk;
+        uint32_t start;
+        uint32_t length;
+        uint32_t lineFeeds;
+        size_t totalLength;     // Subtree sums
+        size_t totalLineFeeds;
+        uint32_t priority;
+        int left, right;
+    };
+
+    int newNode(uint32_t chunk, uint32_t start, uint32_t length);
+    void freeTree(int node);
+    void update(int node);
+    uint32_t countLineFeeds(uint32_t chunk, uint32_t start, uint32_t length) const;
+    void split(int node, size_t offset, int& left, int& right);
+    int merge(int left, int right);
+    bool extendLastPiece(int node, uint32_t chunk, uint32_t end, uint32_t length, uint32_t lineFeeds);
+    void indexNewlines(Chunk& chunk, size_t from) const;
+    uint32_t appendToAddChunk(std::string_view text, uint32_t& start);
+    uint32_t nextPriority();
+
+    template <typename Visitor>
+    bool visitRange(int node, size_t base, size_t from, size_t to, Visitor& visit) const;
+
+    std::vector<std::shared_ptr<Chunk>> chunks;
+    std::vector<Node> nodes;
+    std::vector<int> freeNodes;
+    int root = NIL;
+    int addChunk = -1;
+    uint32_t seed = 0x9E3779B9u;
+};
+
+template <typename Visitor>
+bool TextBuffer::visitRange(int node, size_t base, size_t from, size_t to, Visitor& visit) const {
+    if (node == NIL || from >= to) return true;
+    const Node& n = nodes[node];
+    size_t leftLength = n.left == NIL ? 0 : nodes[n.left].totalLength;
+    size_t pieceBegin = base + leftLength;
+    size_t pieceEnd = pieceBegin + n.length;
+
+    if (from < pieceBegin && !visitRange(n.left, base, from, to, visit)) return false;
+    if (from < pieceEnd && to > pieceBegin) {
+        size_t begin = from > pieceBegin ? from : pieceBegin;
+        size_t end = to < pieceEnd ? to : pieceEnd;
+        const char* data = chunks[n.chunk]->data + n.start + (begin - pieceBegin);
+        if (!visit(std::string_view(data, end - begin))) return false;
+    }
+    if (to > pieceEnd) return visitRange(n.right, pieceEnd, from, to, visit);
+    return true;
+}
+
+template <typename Visitor>
+void TextBuffer::forEachChunk(size_t offset, size_t count, Visitor visit) const {
+    size_t total = length();
+    if (offset >= total) return;
+    size_t end = count > total - offset ? total : offset + count;
+    visitRange(root, 0, offset, end, visit);
+}
+
+#endif // TEXT_BUFFER_HPP
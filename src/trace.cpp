@@ -0,0 +1,205 @@
+#include "trace.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+std::atomic<bool> traceEnabled{false};
+
+// Events each thread keeps; the oldest are overwritten first
+const uint64_t TRACE_RING_EVENTS = 1 << 16;
+// Rings of exited threads (finished builds, for instance) kept for the dump
+const size_t TRACE_RETIRED_RINGS = 8;
+
+namespace {
+
+struct TraceEvent {
+    std::atomic<const char*> name;
+    std::atomic<uint64_t> start;
+    std::atomic<uint64_t> end;
+};
+
+// Written only by its own thread, which publishes each event by advancing
+// head. A reader copies events behind head, then rereads it and throws away
+// any slot the writer may have reused in the meantime.
+struct TraceRing {
+    explicit TraceRing(int tid) : tid(tid), events(new TraceEvent[TRACE_RING_EVENTS]) {}
+
+    int tid;
+    std::string threadName;  // Guarded by the registry mutex
+    std::atomic<uint64_t> head{0};
+    std::unique_ptr<TraceEvent[]> events;
+};
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::shared_ptr<TraceRing>> live;
+    std::deque<std::shared_ptr<TraceRing>> retired;
+    int nextTid = 1;
+    std::atomic<uint64_t> startedAt{0};  // Events before the latest setTracing(true) are not dumped
+};
+
+// Never destroyed: threads may still exit during static destruction
+Registry& registry() {
+    static Registry* instance = new Registry;
+    return *instance;
+}
+
+// The calling thread's ring, created on its first event and retired when the
+// thread exits
+struct ThreadRing {
+    std::shared_ptr<TraceRing> ring;
+    std::string name;
+
+    ~ThreadRing() {
+        if (!ring) return;
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        for (size_t i = 0; i < reg.live.size(); i++) {
+            if (reg.live[i] == ring) {
+                reg.live.erase(reg.live.begin() + i);
+                break;
+            }
+        }
+        reg.retired.push_back(std::move(ring));
+        if (reg.retired.size() > TRACE_RETIRED_RINGS) reg.retired.pop_front();
+    }
+};
+
+thread_local ThreadRing threadRing;
+
+TraceRing& ringForThread() {
+    if (!threadRing.ring) {
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        threadRing.ring = std::make_shared<TraceRing>(reg.nextTid++);
+        threadRing.ring->threadName =
+            threadRing.name.empty() ? "thread " + std::to_string(threadRing.ring->tid) : threadRing.name;
+        reg.live.push_back(threadRing.ring);
+    }
+    return *threadRing.ring;
+}
+
+struct RecordedEvent {
+    const char* name;
+    uint64_t start;
+    uint64_t end;
+};
+
+// Copies the events still held in ring, oldest first
+void readRing(const TraceRing& ring, std::vector<RecordedEvent>& out) {
+    uint64_t head = ring.head.load(std::memory_order_acquire);
+    uint64_t first = head > TRACE_RING_EVENTS ? head - TRACE_RING_EVENTS : 0;
+    size_t base = out.size();
+    for (uint64_t i = first; i < head; i++) {
+        const TraceEvent& event = ring.events[i & (TRACE_RING_EVENTS - 1)];
+        out.push_back({event.name.load(std::memory_order_relaxed), event.start.load(std::memory_order_relaxed),
+                       event.end.load(std::memory_order_relaxed)});
+    }
+
+    // Slots at or below this index may have been rewritten while copying
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint64_t after = ring.head.load(std::memory_order_relaxed);
+    if (after >= TRACE_RING_EVENTS && after - TRACE_RING_EVENTS >= first) {
+        size_t stale = (size_t)std::min<uint64_t>(after - TRACE_RING_EVENTS - first + 1, head - first);
+        out.erase(out.begin() + base, out.begin() + base + stale);
+    }
+}
+
+void appendEscaped(std::string& out, std::string_view text) {
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if ((unsigned char)c < 0x20) {
+            out += ' ';
+        } else {
+            out += c;
+        }
+    }
+}
+
+} // namespace
+
+void setTracing(bool enabled) {
+    if (enabled && !traceEnabled.load()) registry().startedAt = traceNow();
+    traceEnabled = enabled;
+}
+
+uint64_t traceNow() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void traceRecord(const char* name, uint64_t start, uint64_t end) {
+    TraceRing& ring = ringForThread();
+    uint64_t index = ring.head.load(std::memory_order_relaxed);
+    TraceEvent& event = ring.events[index & (TRACE_RING_EVENTS - 1)];
+    event.name.store(name, std::memory_order_relaxed);
+    event.start.store(start, std::memory_order_relaxed);
+    event.end.store(end, std::memory_order_relaxed);
+    ring.head.store(index + 1, std::memory_order_release);
+}
+
+void traceThreadName(const std::string& name) {
+    threadRing.name = name;
+    if (threadRing.ring) {
+        std::lock_guard<std::mutex> lock(registry().mutex);
+        threadRing.ring->threadName = name;
+    }
+}
+
+long writeChromeTrace(const std::string& path, std::string& error) {
+    struct Thread {
+        std::shared_ptr<TraceRing> ring;
+        std::string name;
+    };
+    std::vector<Thread> threads;
+    Registry& reg = registry();
+    {
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        for (const auto& ring : reg.retired) threads.push_back({ring, ring->threadName});
+        for (const auto& ring : reg.live) threads.push_back({ring, ring->threadName});
+    }
+    uint64_t startedAt = reg.startedAt.load();
+
+    std::string json = "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+    std::vector<RecordedEvent> events;
+    long written = 0;
+    char line[256];
+    for (const Thread& thread : threads) {
+        json += "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " + std::to_string(thread.ring->tid) +
+                ", \"args\": {\"name\": \"";
+        appendEscaped(json, thread.name);
+        json += "\"}}";
+
+        events.clear();
+        readRing(*thread.ring, events);
+        for (const RecordedEvent& event : events) {
+            if (event.start < startedAt || !event.name) continue;
+            json += ",\n{\"name\": \"";
+            appendEscaped(json, event.name);
+            // Timestamps are in microseconds, relative to when tracing began
+            std::snprintf(line, sizeof(line), "\", \"cat\": \"ide\", \"ph\": \"X\", \"ts\": %.3f, \"dur\": %.3f, "
+                          "\"pid\": 1, \"tid\": %d}", (event.start - startedAt) / 1000.0,
+                          (event.end - event.start) / 1000.0, thread.ring->tid);
+            json += line;
+            written++;
+        }
+        json += &thread != &threads.back() ? ",\n" : "\n";
+    }
+    json += "]}\n";
+
+    std::ofstream file(path, std::ios::binary);
+    file << json;
+    if (!file) {
+        error = "Could not write " + path;
+        return -1;
+    }
+    return written;
+}
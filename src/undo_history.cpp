@@ -0,0 +1,153 @@
+#include "undo_history.hpp"
+
+UndoHistory::UndoHistory(size_t memoryBudget) : budget(memoryBudget) {}
+
+size_t UndoHistory::stepBytes(const Step& step) {
+    size_t bytes = sizeof(Step);
+    for (const EditDelta& delta : step.deltas) {
+        bytes += sizeof(EditDelta) + delta.removed.capacity() + delta.inserted.capacity();
+    }
+    return bytes;
+}
+
+// Folds a keystroke into the open step when it continues the same run:
+// typing right after the previous insertion, or deleting right next to the
+// previous deletion, without a long pause in between.
+bool UndoHistory::coalesce(size_t offset, std::string_view removed, std::string_view inserted, EditKind kind) {
+    if (kind == EditKind::Other || undoSteps.empty()) return false;
+    Step& step = undoSteps.back();
+    if (step.sealed || step.kind != kind || step.deltas.size() != 1) return false;
+
+    auto now = std::chrono::steady_clock::now();
+    if (now - step.lastEdit > std::chrono::milliseconds(COALESCE_MS)) return false;
+
+    EditDelta& last = step.deltas.back();
+    if (kind == EditKind::Typing) {
+        if (!removed.empty() || offset != last.offset + last.inserted.size()) return false;
+        last.inserted.append(inserted);
+    } else {
+        if (!inserted.empty()) return false;
+        if (offset + removed.size() == last.offset) {
+            last.removed.insert(0, removed);  // Backspace
+            last.offset = offset;
+        } else if (offset == last.offset) {
+            last.removed.append(removed);     // Forward delete
+        } else {
+            return false;
+        }
+    }
+
+    step.lastEdit = now;
+    usedBytes -= step.bytes;
+    step.bytes = stepBytes(step);
+    usedBytes += step.bytes;
+    return true;
+}
+
+void UndoHistory::record(size_t offset, std::string_view removed, std::string_view inserted,
+                         size_t cursorBefore, EditKind kind) {
+    if (removed.empty() && inserted.empty()) return;
+
+    // A new edit invalidates everything that could have been redone
+    for (const Step& step : redoSteps) usedBytes -= step.bytes;
+    redoSteps.clear();
+
+    if (groupDepth > 0 && !undoSteps.empty()) {
+        Step& step = undoSteps.back();
+        step.deltas.push_back({offset, std::string(removed), std::string(inserted)});
+        usedBytes -= step.bytes;
+        step.bytes = stepBytes(step);
+        usedBytes += step.bytes;
+    } else if (!coalesce(offset, removed, inserted, kind)) {
+        Step step;
+        step.deltas.push_back({offset, std::string(removed), std::string(inserted)});
+        step.cursorBefore = cursorBefore;
+        step.kind = kind;
+        step.lastEdit = std::chrono::steady_clock::now();
+        step.sealed = kind == EditKind::Other;
+        step.bytes = stepBytes(step);
+        usedBytes += step.bytes;
+        undoSteps.push_back(std::move(step));
+    }
+    trim();
+}
+
+void UndoHistory::beginGroup(size_t cursorBefore) {
+    if (groupDepth++ > 0) return;
+
+    for (const Step& step : redoSteps) usedBytes -= step.bytes;
+    redoSteps.clear();
+
+    Step step;
+    step.cursorBefore = cursorBefore;
+    step.sealed = true;
+    step.bytes = stepBytes(step);
+    usedBytes += step.bytes;
+    undoSteps.push_back(std::move(step));
+}
+
+void UndoHistory::endGroup() {
+    if (groupDepth == 0 || --groupDepth > 0) return;
+
+    // Drop the step again if nothing was recorded inside the group
+    if (!undoSteps.empty() && undoSteps.back().deltas.empty()) {
+        usedBytes -= undoSteps.back().bytes;
+        undoSteps.pop_back();
+    }
+    trim();
+}
+
+void UndoHistory::breakCoalescing() {
+    if (!undoSteps.empty()) undoSteps.back().sealed = true;
+}
+
+bool UndoHistory::undo(const Applier& apply, size_t& cursor) {
+    if (undoSteps.empty() || groupDepth > 0) return false;
+
+    Step step = std::move(undoSteps.back());
+    undoSteps.pop_back();
+    for (auto it = step.deltas.rbegin(); it != step.deltas.rend(); ++it) {
+        apply(it->offset, it->inserted.size(), it->removed);
+    }
+    cursor = step.cursorBefore;
+
+    step.sealed = true;
+    redoSteps.push_back(std::move(step));
+    return true;
+}
+
+bool UndoHistory::redo(const Applier& apply, size_t& cursor) {
+    if (redoSteps.empty() || groupDepth > 0) return false;
+
+    Step step = std::move(redoSteps.back());
+    redoSteps.pop_back();
+    for (const EditDelta& delta : step.deltas) {
+        apply(delta.offset, delta.removed.size(), delta.inserted);
+    }
+    const EditDelta& last = step.deltas.back();
+    cursor = last.offset + last.inserted.size();
+
+    undoSteps.push_back(std::move(step));
+    return true;
+}
+
+void UndoHistory::setMemoryBudget(size_t bytes) {
+    budget = bytes;
+    trim();
+}
+
+// Evicts the oldest undo steps until the history fits the budget again.
+// The newest step always survives, even if it alone is over budget.
+void UndoHistory::trim() {
+    while (usedBytes > budget && undoSteps.size() > 1 && groupDepth == 0) {
+        usedBytes -= undoSteps.front().bytes;
+        undoSteps.pop_front();
+    }
+}
+
+void UndoHistory::clear() {
+    undoSteps.clear();
+    redoSteps.clear();
+    usedBytes = 0;
+    groupDepth = 0;
+}
@@ -0,0 +1,83 @@
+#ifndef UNDO_HISTORY_HPP
+#define UNDO_HISTORY_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// How an edit may merge with the step before it
+enum class EditKind {
+    Typing,    // Consecutive insertions coalesce
+    Deleting,  // Consecutive backspaces/deletes coalesce
+    Other      // Always a step of its own
+};
+
+// One replacement: removed was at offset before, inserted is there after
+struct EditDelta {
+    size_t offset;
+    std::string removed;
+    std::string inserted;
+};
+
+// Operation log for undo/redo. Each step stores only the deltas it applied
+// plus the cursor offset to restore, so undo and redo cost time proportional
+// to the change rather than to the document.
+class UndoHistory {
+public:
+    // Applies a replacement to the document: erase count bytes at offset,
+    // then insert text there
+    using Applier = std::function<void(size_t offset, size_t count, std::string_view text)>;
+
+    explicit UndoHistory(size_t memoryBudget = DEFAULT_MEMORY_BUDGET);
+
+    void record(size_t offset, std::string_view removed, std::string_view inserted,
+                size_t cursorBefore, EditKind kind);
+
+    // Everything recorded between these calls becomes a single step
+    void beginGroup(size_t cursorBefore);
+    void endGroup();
+
+    // Forces the next edit to start a new step
+    void breakCoalescing();
+
+    bool undo(const Applier& apply, size_t& cursor);
+    bool redo(const Applier& apply, size_t& cursor);
+
+    bool canUndo() const { return !undoSteps.empty(); }
+    bool canRedo() const { return !redoSteps.empty(); }
+
+    // Oldest steps are evicted once the history holds more than this
+    void setMemoryBudget(size_t bytes);
+    size_t memoryUsage() const { return usedBytes; }
+    void clear();
+
+    static constexpr size_t DEFAULT_MEMORY_BUDGET = 64 * 1024 * 1024;
+
+private:
+    static constexpr int COALESCE_MS = 1000;
+
+    struct Step {
+        std::vector<EditDelta> deltas;
+        size_t cursorBefore = 0;
+        EditKind kind = EditKind::Other;
+        std::chrono::steady_clock::time_point lastEdit;
+        bool sealed = false;
+        size_t bytes = 0;
+    };
+
+    bool coalesce(size_t offset, std::string_view removed, std::string_view inserted, EditKind kind);
+    static size_t stepBytes(const Step& step);
+    void trim();
+
+    std::deque<Step> undoSteps;
+    std::vector<Step> redoSteps;
+    size_t budget;
+    size_t usedBytes = 0;
+    int groupDepth = 0;
+};
+
+#endif // UNDO_HISTORY_HPP